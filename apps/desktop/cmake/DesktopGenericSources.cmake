@@ -17,8 +17,12 @@ set(SCRITE_DESKTOP_GENERIC_SOURCES
   "src/crashpad/crashpadmodule_common.cpp"
   "src/document/documentfilesystem.cpp"
   "src/document/documentfilesystem.h"
+  "src/document/documentjournal.cpp"
+  "src/document/documentjournal.h"
   "src/document/scene_p.cpp"
   "src/document/scene_p.h"
+  "src/document/screenplaypaginationcache.cpp"
+  "src/document/screenplaypaginationcache.h"
   "src/document/screenplaypaginatorworker.cpp"
   "src/document/screenplaypaginatorworker.h"
   "src/exporters/characterrelationshipsgraphexporter.cpp"
@@ -93,6 +97,8 @@ set(SCRITE_DESKTOP_GENERIC_SOURCES
   "src/utils/callgraph.h"
   "src/utils/execlatertimer.cpp"
   "src/utils/execlatertimer.h"
+  "src/utils/filecopy.cpp"
+  "src/utils/filecopy.h"
   "src/utils/fountain.cpp"
   "src/utils/fountain.h"
   "src/utils/garbagecollector.cpp"
@@ -101,9 +107,17 @@ set(SCRITE_DESKTOP_GENERIC_SOURCES
   "src/utils/graphlayout.h"
   "src/utils/hourglass.h"
   "src/utils/modifiable.h"
+  "src/utils/parentchangenotifier.cpp"
+  "src/utils/parentchangenotifier.h"
   "src/utils/qobjectfactory.h"
   "src/utils/qobjectserializer.cpp"
   "src/utils/qobjectserializer.h"
+  "src/utils/spatialindex.cpp"
+  "src/utils/spatialindex.h"
+  "src/utils/stringpool.cpp"
+  "src/utils/stringpool.h"
+  "src/utils/thumbnailcache.cpp"
+  "src/utils/thumbnailcache.h"
   "src/utils/timeprofiler.h"
 )
 
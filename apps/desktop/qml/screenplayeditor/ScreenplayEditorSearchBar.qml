@@ -92,13 +92,15 @@ Rectangle {
 
                 SearchAgent.onCurrentSearchResultIndexChanged: () => {
                                                                    if(SearchAgent.currentSearchResultIndex >= 0) {
-                                                                       let searchResult = searchResults[SearchAgent.currentSearchResultIndex]
-                                                                       let sceneIndex = searchResult["sceneIndex"]
+                                                                       // searchResults has index of the scene for each match
+                                                                       let sceneIndex = searchResults[SearchAgent.currentSearchResultIndex]
                                                                        if(sceneIndex !== previousSceneIndex) {
                                                                            clearPreviousElementUserData()
                                                                        }
 
-                                                                       let sceneResultIndex = searchResult["sceneResultIndex"]
+                                                                       let sceneResultIndex = 0
+                                                                       for(let i=SearchAgent.currentSearchResultIndex-1; i>=0 && searchResults[i] === sceneIndex; i--)
+                                                                           ++sceneResultIndex
                                                                        let screenplayElement = _private.screenplay.elementAt(sceneIndex)
                                                                        let data = {
                                                                            "searchString": searchString,
@@ -113,6 +113,7 @@ GridBackground {
     border.color: Runtime.structureCanvasSettings.gridLineColor
 
     tickDistance: Scrite.document.structure.canvasGridSize
+    visibleArea: root.canvasScrollViewportRect
     gridIsVisible: Runtime.structureCanvasSettings.showGrid && root.canvasScrollInteractive
     majorTickColor: Runtime.structureCanvasSettings.gridLineColor
     minorTickColor: Color.translucent(Runtime.structureCanvasSettings.gridLineColor, 0.5)
@@ -110,7 +110,10 @@ Item {
         z: active ? 1000 : -1
 
         onSelect: (rectangle) => {
-            _selection.init(_elementItems, rectangle)
+            const candidates = Scrite.document.structure.elementIndexesIn(Qt.rect(rectangle.left, rectangle.top,
+                                                                                  rectangle.right-rectangle.left,
+                                                                                  rectangle.bottom-rectangle.top))
+            _selection.init(_elementItems, rectangle, false, candidates)
             root.selectionModeOffRequest()
         }
 
@@ -68,7 +68,9 @@ Item {
 
     // For intializing from a repeater and a boundary
     // Here boundary is a JSON like {left: x, top: y, right: r, bottom: b }
-    function init(repeater, boundary, includeInvisibleItems) {
+    // candidateIndexes, when supplied, restricts the search to those repeater indexes.
+    // Usually these come from a spatial index lookup of the boundary.
+    function init(repeater, boundary, includeInvisibleItems, candidateIndexes) {
         if(repeater === undefined || repeater === null)
             return
 
@@ -79,9 +81,13 @@ Item {
 
         let bounds = createBounds()
         let selectedItems = []
-        let count = repeater.count
-        for(let i=0; i<count; i++) {
+        let useCandidates = candidateIndexes !== undefined && candidateIndexes !== null
+        let count = useCandidates ? candidateIndexes.length : repeater.count
+        for(let c=0; c<count; c++) {
+            let i = useCandidates ? candidateIndexes[c] : c
             let item = repeater.itemAt(i)
+            if(item === null)
+                continue
             if(!item.visible && !includeInvisibleItems)
                 continue
             let p1 = Qt.point(item.x, item.y)
@@ -24,6 +24,7 @@
 #include "notification.h"
 #include "localstorage.h"
 #include "scritedocument.h"
+#include "parentchangenotifier.h"
 
 #ifdef ENABLE_CRASHPAD_CRASH_TEST
 #include "crashpadmodule.h"
@@ -770,24 +771,18 @@ bool Application::notify(QObject *object, QEvent *event)
     // handle an event AFTER it is handled by the target object.
 
     if (event->type() == QEvent::ChildAdded) {
-        QChildEvent *childEvent = reinterpret_cast<QChildEvent *>(event);
-        QObject *childObject = childEvent->child();
-
-        if (!childObject->isWidgetType() && !childObject->isWindowType()) {
-            /**
-             * For whatever reason, ParentChange event is only sent
-             * if the child is a widget or window or declarative-item.
-             * I was not aware of this up until now. Classes like
-             * StructureElement, SceneElement etc assume that ParentChange
-             * event will be sent when they are inserted into the document
-             * object tree, so that they can evaluate a pointer to the
-             * parent object in the tree. Since these classes are subclassed
-             * from QObject, we will need the following lines to explicitly
-             * despatch ParentChange events.
-             */
-            QEvent parentChangeEvent(QEvent::ParentChange);
-            QApplication::notify(childObject, &parentChangeEvent);
-        }
+        /**
+         * For whatever reason, ParentChange event is only sent
+         * if the child is a widget or window or declarative-item.
+         * Classes like StructureElement, SceneElement etc assume that
+         * ParentChange event will be sent when they are inserted into
+         * the document object tree, so that they can evaluate a pointer
+         * to the parent object in the tree. ParentChangeNotifier despatches
+         * those events directly to classes that ask for it, without
+         * another pass through QApplication::notify().
+         */
+        QChildEvent *childEvent = static_cast<QChildEvent *>(event);
+        ParentChangeNotifier::childAdded(childEvent->child());
     }
 
     if (event->type() == QEvent::ApplicationFontChange)
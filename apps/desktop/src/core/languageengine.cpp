@@ -22,12 +22,15 @@
 #include <PhTranslateLib>
 
 #include <QDir>
+#include <QCache>
+#include <QMutex>
 #include <QTimer>
 #include <QWindow>
 #include <QPainter>
 #include <QFileInfo>
 #include <QTextBlock>
 #include <QScopeGuard>
+#include <QMutexLocker>
 #include <QApplication>
 #include <QJSEngine>
 #include <QNetworkReply>
@@ -2628,11 +2631,44 @@ QChar::Script LanguageEngine::determineScript(const QString &text)
     return QChar::Script_Latin;
 }
 
+/**
+ * The same paragraph text gets segmented over and over again: by the scene editor's
+ * highlighter, by exporters, by the paginator worker thread and by word counts. Boundaries
+ * only depend on the text (fonts are looked up from the script when needed), so we cache them
+ * against the paragraph text itself. The cost of each entry is its length in characters.
+ */
+struct ScriptBoundaryCache
+{
+    QMutex mutex;
+    QCache<QString, QList<ScriptBoundary>> boundaries =
+            QCache<QString, QList<ScriptBoundary>>(1 << 20);
+};
+Q_GLOBAL_STATIC(ScriptBoundaryCache, GlobalScriptBoundaryCache)
+
+static QList<ScriptBoundary> evaluateBoundaries(const QString &paragraph);
+
 QList<ScriptBoundary> LanguageEngine::determineBoundaries(const QString &paragraph)
 {
     if (paragraph.isEmpty())
         return {};
 
+    ScriptBoundaryCache *cache = GlobalScriptBoundaryCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        if (const QList<ScriptBoundary> *boundaries = cache->boundaries.object(paragraph))
+            return *boundaries;
+    }
+
+    const QList<ScriptBoundary> ret = evaluateBoundaries(paragraph);
+
+    QMutexLocker locker(&cache->mutex);
+    cache->boundaries.insert(paragraph, new QList<ScriptBoundary>(ret), paragraph.length());
+
+    return ret;
+}
+
+static QList<ScriptBoundary> evaluateBoundaries(const QString &paragraph)
+{
     /**
      * This function returns a list of boundaries where different language text-snippets can be
      * found.
@@ -2666,7 +2702,7 @@ QList<ScriptBoundary> LanguageEngine::determineBoundaries(const QString &paragra
             continue;
 
         item.text = paragraph.mid(item.start, item.end - item.start);
-        item.script = determineScript(item.text);
+        item.script = LanguageEngine::determineScript(item.text);
 
         ret.append(item);
 
@@ -2680,7 +2716,7 @@ QList<ScriptBoundary> LanguageEngine::determineBoundaries(const QString &paragra
         item.start = 0;
         item.end = paragraph.length();
         item.text = paragraph;
-        item.script = determineScript(item.text);
+        item.script = LanguageEngine::determineScript(item.text);
         ret.append(item);
         return ret;
     }
@@ -2692,7 +2728,7 @@ QList<ScriptBoundary> LanguageEngine::determineBoundaries(const QString &paragra
         first.start = 0;
         first.end = ret.first().start;
         first.text = paragraph.mid(first.start, first.end - first.start);
-        first.script = determineScript(first.text);
+        first.script = LanguageEngine::determineScript(first.text);
         ret.prepend(first);
     }
 
@@ -2703,7 +2739,7 @@ QList<ScriptBoundary> LanguageEngine::determineBoundaries(const QString &paragra
         last.start = ret.last().end;
         last.end = paragraph.length();
         last.text = paragraph.mid(last.start, last.end - last.start);
-        last.script = determineScript(last.text);
+        last.script = LanguageEngine::determineScript(last.text);
         ret.append(last);
     }
 
@@ -2720,7 +2756,7 @@ QList<ScriptBoundary> LanguageEngine::determineBoundaries(const QString &paragra
             gap.start = a.end;
             gap.end = b.start;
             gap.text = paragraph.mid(gap.start, gap.end - gap.start);
-            gap.script = determineScript(gap.text);
+            gap.script = LanguageEngine::determineScript(gap.text);
             ret.insert(i + 1, gap);
         }
     }
@@ -2772,11 +2808,68 @@ QString LanguageEngine::formattedInHtml(const QString &paragraph)
     return html;
 }
 
+/**
+ * Counts words in a paragraph that has only ASCII characters, following the same
+ * rules as QTextBoundaryFinder (UAX #29) would for such text. Returns false as soon as
+ * a non-ASCII character is found, so that the caller can fall back to ICU.
+ */
+static bool evaluateAsciiWordCount(const QString &paragraph, int &wordCount)
+{
+    auto isLetter = [](ushort ch) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+    };
+    auto isDigit = [](ushort ch) { return ch >= '0' && ch <= '9'; };
+
+    const QChar *data = paragraph.constData();
+    const int length = paragraph.length();
+
+    bool inWord = false;
+    wordCount = 0;
+
+    for (int i = 0; i < length; i++) {
+        const ushort ch = data[i].unicode();
+        if (ch >= 0x80)
+            return false;
+
+        if (isLetter(ch) || isDigit(ch)) {
+            if (!inWord)
+                ++wordCount;
+            inWord = true;
+            continue;
+        }
+
+        // Apostrophes, colons and full-stops between letters (don't, U.S) and
+        // commas, full-stops etc. between digits (1,000 or 3.14) don't break a word.
+        if (inWord && i + 1 < length) {
+            const ushort prev = data[i - 1].unicode();
+            const ushort next = data[i + 1].unicode();
+            if (ch == '\'' || ch == '.' || ch == ':') {
+                if (isLetter(prev) && isLetter(next))
+                    continue;
+            }
+            if (ch == '\'' || ch == '.' || ch == ',' || ch == ';') {
+                if (isDigit(prev) && isDigit(next))
+                    continue;
+            }
+        }
+
+        inWord = false;
+    }
+
+    return true;
+}
+
 int LanguageEngine::wordCount(const QString &paragraph)
 {
     if (paragraph.isEmpty())
         return 0;
 
+    // Most paragraphs in a screenplay are plain ASCII, for which we don't need
+    // to pay for ICU's boundary finder.
+    int asciiWordCount = 0;
+    if (evaluateAsciiWordCount(paragraph, asciiWordCount))
+        return asciiWordCount;
+
     const int paragraphLength = paragraph.length();
     int wordCount = 0;
 
@@ -17,35 +17,91 @@
 #include "application.h"
 #include "simplecrypt.h"
 #include "localstorage.h"
+#include "execlatertimer.h"
 
 #include "restapikey/restapikey.h"
 
 #include <QDir>
 #include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QSaveFile>
 #include <QDataStream>
+#include <QTimerEvent>
 #include <QStandardPaths>
 #include <QSettings>
 
-class EncryptedDataStore
+/**
+ * Writes are coalesced, so that bursts of LocalStorage::store() calls (login flows,
+ * message sync and so on) result in a single rewrite of the file. Pending writes are
+ * flushed when the application quits.
+ *
+ * The file is written atomically using QSaveFile. It begins with a magic marker and a
+ * format version, followed by the encrypted payload. Files written by older versions of
+ * Scrite are just the encrypted payload, and are still read. Files written by newer
+ * versions are neither read nor overwritten, so that going back to an older version for a
+ * while doesn't destroy what the newer one stored.
+ *
+ * store() may be called from any thread. Access to data is serialized using lock. Batched
+ * saves are always started from the thread this object lives in, and saves themselves are
+ * serialized, so that an explicit flush() from another thread can't interleave with them.
+ */
+class EncryptedDataStore : public QObject
 {
 public:
     EncryptedDataStore();
     ~EncryptedDataStore();
 
-    QVariantMap data;
+    QMutex lock;
+    QVariantMap data; // guarded by lock
 
     void save();
+    void saveLater();
+    void flush();
+
+    static QString filePath();
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    void startSaveTimer();
+
+private:
+    bool m_dirty = false; // guarded by lock
+    bool m_readOnly = false;
+    QMutex m_saveLock;
+    ExecLaterTimer m_saveTimer;
 };
 
-EncryptedDataStore::EncryptedDataStore()
+static const QByteArray DataStoreMagic = QByteArrayLiteral("SCRITELS");
+static const quint32 DataStoreVersion = 1;
+
+EncryptedDataStore::EncryptedDataStore() : m_saveTimer("EncryptedDataStore.m_saveTimer")
 {
-    const QString appDataFolder = Application::appDataLocation();
+    if (qApp != nullptr) {
+        this->moveToThread(qApp->thread());
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, this, &EncryptedDataStore::flush);
+    }
 
-    QFile file(QDir(appDataFolder).absoluteFilePath("localstore.db"));
+    QFile file(filePath());
     if (!file.open(QFile::ReadOnly))
         return;
 
-    const QByteArray encryptedBytes = file.readAll();
+    QByteArray encryptedBytes = file.readAll();
+    if (encryptedBytes.startsWith(DataStoreMagic)) {
+        QDataStream ds(encryptedBytes.mid(DataStoreMagic.length()));
+        quint32 version = 0;
+        ds >> version;
+        if (version > DataStoreVersion) {
+            m_readOnly = true;
+            return;
+        }
+
+        encryptedBytes.clear();
+        ds >> encryptedBytes;
+    }
+
     if (encryptedBytes.isEmpty())
         return;
 
@@ -59,21 +115,32 @@ EncryptedDataStore::EncryptedDataStore()
     ds >> this->data;
 }
 
-EncryptedDataStore::~EncryptedDataStore() { }
+EncryptedDataStore::~EncryptedDataStore()
+{
+    this->flush();
+}
+
+QString EncryptedDataStore::filePath()
+{
+    const QString appDataFolder = Application::appDataLocation();
+    return QDir(appDataFolder).absoluteFilePath("localstore.db");
+}
 
 void EncryptedDataStore::save()
 {
-    if (this->data.isEmpty())
-        return;
+    QMutexLocker saveLocker(&m_saveLock);
 
-    const QString appDataFolder = Application::appDataLocation();
+    QVariantMap copy;
+    {
+        QMutexLocker locker(&this->lock);
+        m_dirty = false;
+        copy = this->data;
+    }
 
-    QFile file(QDir(appDataFolder).absoluteFilePath("localstore.db"));
-    if (!file.open(QFile::WriteOnly))
+    if (copy.isEmpty() || m_readOnly)
         return;
 
-    const QByteArray decryptedBytes = [=]() {
-        QVariantMap copy = this->data;
+    const QByteArray decryptedBytes = [&copy]() {
         copy.remove(LocalStorage::sessionToken);
 
         QByteArray ret;
@@ -86,7 +153,69 @@ void EncryptedDataStore::save()
 
     const QByteArray encryptedBytes = sc.encryptToByteArray(decryptedBytes);
 
-    file.write(encryptedBytes);
+    QByteArray bytes = DataStoreMagic;
+    {
+        QDataStream ds(&bytes, QIODevice::WriteOnly | QIODevice::Append);
+        ds << DataStoreVersion << encryptedBytes;
+    }
+
+    // Previous contents of the file are replaced only if the new contents were written
+    // completely. An interrupted write leaves the previous file intact.
+    QSaveFile file(filePath());
+    if (!file.open(QFile::WriteOnly))
+        return;
+
+    file.write(bytes);
+    file.commit();
+}
+
+void EncryptedDataStore::saveLater()
+{
+    {
+        QMutexLocker locker(&this->lock);
+        m_dirty = true;
+    }
+
+    // Timers can only be started from the thread this object lives in. Saving right away
+    // from another thread would race with saves made by the timer, so the timer is started
+    // on the owning thread instead.
+    if (QThread::currentThread() != this->thread())
+        QMetaObject::invokeMethod(this, &EncryptedDataStore::startSaveTimer,
+                                  Qt::QueuedConnection);
+    else
+        this->startSaveTimer();
+}
+
+void EncryptedDataStore::startSaveTimer()
+{
+    if (!m_saveTimer.isActive())
+        m_saveTimer.start(1000, this);
+}
+
+void EncryptedDataStore::flush()
+{
+    // Flushes from other threads leave the timer alone. It finds nothing dirty when it
+    // fires, if this save got to the pending writes first.
+    if (QThread::currentThread() == this->thread())
+        m_saveTimer.stop();
+
+    bool dirty = false;
+    {
+        QMutexLocker locker(&this->lock);
+        dirty = m_dirty;
+    }
+
+    if (dirty)
+        this->save();
+}
+
+void EncryptedDataStore::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_saveTimer.timerId()) {
+        m_saveTimer.stop();
+        this->flush();
+    } else
+        QObject::timerEvent(event);
 }
 
 Q_GLOBAL_STATIC(EncryptedDataStore, DataStore)
@@ -105,6 +234,8 @@ QString LocalStorage::userGuideSearchIndexTimestamp =
 
 void LocalStorage::store(const QString &key, const QVariant &value)
 {
+    QMutexLocker locker(&::DataStore->lock);
+
     QVariantMap &data = ::DataStore->data;
     if (value.isValid()) {
         data.insert(key, value);
@@ -116,11 +247,20 @@ void LocalStorage::store(const QString &key, const QVariant &value)
             data.remove(key + timestampSuffix);
     }
 
-    ::DataStore->save();
+    locker.unlock();
+
+    ::DataStore->saveLater();
+}
+
+void LocalStorage::flush()
+{
+    ::DataStore->flush();
 }
 
 QVariant LocalStorage::load(const QString &key, const QVariant &defaultValue)
 {
+    QMutexLocker locker(&::DataStore->lock);
+
     const QVariantMap &data = ::DataStore->data;
     return data.value(key, defaultValue);
 }
@@ -130,6 +270,8 @@ QDateTime LocalStorage::timestamp(const QString &key)
     if (key.endsWith(timestampSuffix))
         return QDateTime();
 
+    QMutexLocker locker(&::DataStore->lock);
+
     const QVariantMap &data = ::DataStore->data;
     const QVariant value = data.value(key + timestampSuffix);
     if (value.isValid()) {
@@ -141,6 +283,7 @@ QDateTime LocalStorage::timestamp(const QString &key)
 
 void LocalStorage::reset()
 {
+    QMutexLocker locker(&::DataStore->lock);
     ::DataStore->data.clear();
 }
 
@@ -150,6 +293,8 @@ QJsonObject LocalStorage::compile(const QJsonObject &object)
     if (object.isEmpty())
         return ret;
 
+    QMutexLocker locker(&::DataStore->lock);
+
     QVariantMap &data = ::DataStore->data;
 
     QJsonObject::const_iterator it = object.constBegin();
@@ -39,6 +39,10 @@ public:
     static QDateTime timestamp(const QString &key);
     static void reset();
 
+    // Writes made using store() are saved to disk in batches. This function saves
+    // pending writes right away. It is also called when the application quits.
+    static void flush();
+
     static QJsonObject compile(const QJsonObject &object);
 };
 
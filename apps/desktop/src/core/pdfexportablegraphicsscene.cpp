@@ -20,6 +20,7 @@
 #include "scritedocument.h"
 
 #include <QFile>
+#include <QtMath>
 #include <QPainter>
 #include <QDateTime>
 #include <QPdfWriter>
@@ -91,6 +92,9 @@ bool PdfExportableGraphicsScene::exportToPdf(QPdfWriter *pdfWriter)
     // We are going to need atleast 1" border around.
     sceneRect.adjust(-dpi, -dpi, dpi, dpi);
 
+    if (m_tilePageSize.isValid())
+        return this->exportTilesToPdf(pdfWriter, sceneRect, dpi);
+
     // Figure out the page size in which we have to create the PDF
     QPageSize pageSize(sceneRect.size() / dpi, QPageSize::Inch, QStringLiteral("Custom"),
                        QPageSize::FuzzyMatch);
@@ -122,6 +126,147 @@ bool PdfExportableGraphicsScene::exportToPdf(QPdfWriter *pdfWriter)
     return true;
 }
 
+bool PdfExportableGraphicsScene::exportTilesToPdf(QPdfWriter *pdfWriter, const QRectF &sceneRect,
+                                                  qreal dpi)
+{
+    // Pick the page orientation that suits the scene best.
+    const bool landscape = sceneRect.width() > sceneRect.height();
+    const QPageLayout pageLayout(m_tilePageSize,
+                                 landscape ? QPageLayout::Landscape : QPageLayout::Portrait,
+                                 QMarginsF(0.5, 0.5, 0.5, 0.5), QPageLayout::Inch);
+
+    const QRectF pageRect = QRectF(pageLayout.fullRectPixels(int(dpi)));
+    const QRectF printRect = QRectF(pageLayout.paintRectPixels(int(dpi)));
+
+    // If the whole scene fits on one page without shrinking it too much, then that's that.
+    const qreal fitScale = qMin(printRect.width() / sceneRect.width(),
+                                printRect.height() / sceneRect.height());
+    const qreal scale = qMin(qMax(fitScale, m_minimumTileScale), 1.0);
+
+    // Each tile shows this much of the scene, and tiles overlap by this much.
+    const QSizeF tileSize = printRect.size() / scale;
+    const qreal overlap = qMin(m_tileOverlap * dpi / scale,
+                               qMin(tileSize.width(), tileSize.height()) * 0.5);
+    const QSizeF tileStep = tileSize - QSizeF(overlap, overlap);
+
+    const int nrColumns = qMax(1, qCeil((sceneRect.width() - overlap) / tileStep.width()));
+    const int nrRows = qMax(1, qCeil((sceneRect.height() - overlap) / tileStep.height()));
+    const int nrTiles = nrRows * nrColumns;
+
+    // Center the tile grid on the scene.
+    const QSizeF gridSize(nrColumns * tileStep.width() + overlap,
+                          nrRows * tileStep.height() + overlap);
+    QRectF gridRect(QPointF(0, 0), gridSize);
+    gridRect.moveCenter(sceneRect.center());
+
+    pdfWriter->setPdfVersion(QPagedPaintDevice::PdfVersion_1_6);
+    pdfWriter->setTitle(m_title);
+    pdfWriter->setCreator(qApp->applicationName() + " " + qApp->applicationVersion());
+    pdfWriter->setResolution(int(dpi));
+    pdfWriter->setPageLayout(QPageLayout(m_tilePageSize, pageLayout.orientation(), QMarginsF()));
+
+    const qreal dpiScaleX = qreal(pdfWriter->logicalDpiX()) / dpi;
+    const qreal dpiScaleY = qreal(pdfWriter->logicalDpiY()) / dpi;
+
+    const QPen markPen(Qt::black, 0.5);
+    const qreal markLength = dpi * 0.25;
+
+    QFont labelFont = qApp->font();
+    labelFont.setPixelSize(int(dpi * 0.12));
+
+    auto drawRegistrationMarks = [&](QPainter *paint, int row, int column) {
+        paint->save();
+        paint->setPen(markPen);
+        paint->setBrush(Qt::NoBrush);
+
+        // Crop marks at the corners of the printed area.
+        const QList<QPointF> corners = { printRect.topLeft(), printRect.topRight(),
+                                         printRect.bottomRight(), printRect.bottomLeft() };
+        for (const QPointF &corner : corners) {
+            const qreal dx = corner.x() < pageRect.center().x() ? -markLength : markLength;
+            const qreal dy = corner.y() < pageRect.center().y() ? -markLength : markLength;
+            paint->drawLine(corner, corner + QPointF(dx, 0));
+            paint->drawLine(corner, corner + QPointF(0, dy));
+        }
+
+        // Cross hairs along edges shared with neighbouring tiles, placed at the start of
+        // the overlapping region, so that they line up with the neighbour's edge.
+        const qreal overlapOnPage = overlap * scale;
+        auto drawCrossHair = [&](const QPointF &center) {
+            const qreal r = markLength * 0.4;
+            paint->drawEllipse(center, r, r);
+            paint->drawLine(center - QPointF(r * 1.5, 0), center + QPointF(r * 1.5, 0));
+            paint->drawLine(center - QPointF(0, r * 1.5), center + QPointF(0, r * 1.5));
+        };
+        const qreal topMargin = (printRect.top() + pageRect.top()) / 2;
+        const qreal bottomMargin = (printRect.bottom() + pageRect.bottom()) / 2;
+        const qreal leftMargin = (printRect.left() + pageRect.left()) / 2;
+        const qreal rightMargin = (printRect.right() + pageRect.right()) / 2;
+        if (column > 0) {
+            drawCrossHair(QPointF(printRect.left() + overlapOnPage, topMargin));
+            drawCrossHair(QPointF(printRect.left() + overlapOnPage, bottomMargin));
+        }
+        if (column < nrColumns - 1) {
+            drawCrossHair(QPointF(printRect.right() - overlapOnPage, topMargin));
+            drawCrossHair(QPointF(printRect.right() - overlapOnPage, bottomMargin));
+        }
+        if (row > 0) {
+            drawCrossHair(QPointF(leftMargin, printRect.top() + overlapOnPage));
+            drawCrossHair(QPointF(rightMargin, printRect.top() + overlapOnPage));
+        }
+        if (row < nrRows - 1) {
+            drawCrossHair(QPointF(leftMargin, printRect.bottom() - overlapOnPage));
+            drawCrossHair(QPointF(rightMargin, printRect.bottom() - overlapOnPage));
+        }
+
+        // Label each tile, so that they can be assembled in order.
+        const QString label = QStringLiteral("%1 - Row %2 of %3, Column %4 of %5")
+                                      .arg(m_title)
+                                      .arg(row + 1)
+                                      .arg(nrRows)
+                                      .arg(column + 1)
+                                      .arg(nrColumns);
+        const QRectF labelRect(printRect.left() + markLength, printRect.bottom(),
+                               printRect.width() - 2 * markLength,
+                               pageRect.bottom() - printRect.bottom());
+        paint->setFont(labelFont);
+        paint->drawText(labelRect, Qt::AlignCenter, label);
+
+        paint->restore();
+    };
+
+    QPainter paint(pdfWriter);
+    paint.setRenderHint(QPainter::Antialiasing);
+    paint.setRenderHint(QPainter::SmoothPixmapTransform);
+    paint.scale(dpiScaleX, dpiScaleY);
+
+    for (int i = 0; i < nrTiles; i++) {
+        const int row = i / nrColumns;
+        const int column = i % nrColumns;
+
+        if (i > 0)
+            pdfWriter->newPage();
+
+        const QRectF tileRect(gridRect.left() + column * tileStep.width(),
+                              gridRect.top() + row * tileStep.height(), tileSize.width(),
+                              tileSize.height());
+
+        // QGraphicsScene::render() looks up items intersecting the source rect in its index,
+        // so each page only draws what falls within its tile.
+        paint.save();
+        paint.setClipRect(printRect);
+        this->render(&paint, printRect, tileRect, Qt::IgnoreAspectRatio);
+        paint.restore();
+
+        if (nrTiles > 1)
+            drawRegistrationMarks(&paint, row, column);
+    }
+
+    paint.end();
+
+    return true;
+}
+
 void PdfExportableGraphicsScene::addStandardItems(int items)
 {
     const ScriteDocument *scriteDocument = ScriteDocument::instance();
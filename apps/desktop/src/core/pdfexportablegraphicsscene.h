@@ -16,6 +16,7 @@
 #ifndef PDFEXPORTABLEGRAPHICSSCENE_H
 #define PDFEXPORTABLEGRAPHICSSCENE_H
 
+#include <QPageSize>
 #include <QGraphicsItem>
 #include <QGraphicsScene>
 
@@ -73,15 +74,35 @@ public:
     };
     void addStandardItems(int items = HeaderFooterAndWatermarkOverlay);
 
+    // By default the whole scene is exported into a single custom sized page. If a tile page
+    // size is set, and the scene cannot be fit into one such page without scaling it below
+    // the minimum tile scale, then the scene is exported poster-style across as many pages as
+    // required. Adjacent pages overlap by tileOverlap inches, and carry registration marks
+    // for aligning them with each other.
+    void setTilePageSize(const QPageSize &val) { m_tilePageSize = val; }
+    QPageSize tilePageSize() const { return m_tilePageSize; }
+
+    void setMinimumTileScale(qreal val) { m_minimumTileScale = qBound(0.05, val, 1.0); }
+    qreal minimumTileScale() const { return m_minimumTileScale; }
+
+    void setTileOverlap(qreal val) { m_tileOverlap = qMax(val, 0.0); }
+    qreal tileOverlap() const { return m_tileOverlap; }
+
     bool exportToPdf(const QString &fileName);
     bool exportToPdf(QIODevice *device);
     bool exportToPdf(QPdfWriter *pdfWriter);
 
 protected:
+private:
+    bool exportTilesToPdf(QPdfWriter *pdfWriter, const QRectF &sceneRect, qreal dpi);
+
 private:
     QString m_title;
     QString m_comment;
     QString m_watermark;
+    QPageSize m_tilePageSize;
+    qreal m_minimumTileScale = 0.5;
+    qreal m_tileOverlap = 0.5;
 };
 
 class GraphicsHeaderFooterItem : public QGraphicsItem
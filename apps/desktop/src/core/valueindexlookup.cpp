@@ -14,6 +14,9 @@
 ****************************************************************************/
 
 #include "valueindexlookup.h"
+#include "stringpool.h"
+
+#include <QSet>
 
 ValueIndexLookup::ValueIndexLookup(QObject *parent) : QObject { parent } { }
 
@@ -27,7 +30,7 @@ int ValueIndexLookup::insert(const QString &value, int defaultValue)
     int idx = m_lookup.value(value, -1);
     if (idx < 0) {
         idx = m_index++;
-        m_lookup.insert(value, idx);
+        m_lookup.insert(StringPool::interned(value), idx);
     }
 
     return idx;
@@ -56,17 +59,16 @@ int ValueIndexLookup::lookup(const QString &value, int defaultValue) const
 
 void ValueIndexLookup::prune(const QStringList &values)
 {
-    QStringList currentValues = m_lookup.keys();
-    for (const QString &value : values) {
-        int cidx = currentValues.indexOf(value);
-        if (cidx < 0)
-            this->insert(value);
-        else
-            currentValues.removeAt(cidx);
-    }
+    const QStringList currentValues = m_lookup.keys();
 
-    for (const QString &value : currentValues)
-        this->remove(value);
+    for (const QString &value : values)
+        this->insert(value);
+
+    const QSet<QString> valueSet(values.begin(), values.end());
+    for (const QString &value : currentValues) {
+        if (!valueSet.contains(value))
+            this->remove(value);
+    }
 }
 
 void ValueIndexLookup::serializeToJson(QJsonObject &json) const
@@ -88,7 +90,7 @@ void ValueIndexLookup::deserializeFromJson(const QJsonObject &json)
     const QJsonObject map = json.value("#lookup").toObject();
     auto it = map.begin();
     while (it != map.end()) {
-        m_lookup.insert(it.key(), it.value().toInt());
+        m_lookup.insert(StringPool::interned(it.key()), it.value().toInt());
         ++it;
     }
     m_index = json.value("#index").toInt();
@@ -16,6 +16,7 @@
 #include "attachments.h"
 
 #include "application.h"
+#include "filecopy.h"
 #include "timeprofiler.h"
 #include "scritedocument.h"
 #include "documentfilesystem.h"
@@ -135,7 +136,7 @@ void Attachment::openAttachmentAnonymously()
         }
 
         m_anonFilePath = anonPath;
-        if (QFile::copy(path, m_anonFilePath)
+        if (FileCopy::copy(path, m_anonFilePath)
             && QDesktopServices::openUrl(QUrl::fromLocalFile(m_anonFilePath)))
             return;
 
@@ -181,6 +182,7 @@ void Attachment::setFilePath(const QString &val)
 
     m_filePath = val;
     m_fileSource = QUrl::fromLocalFile(path);
+    dfs->setClaims(this, QStringList({ m_filePath }));
     emit filePathChanged();
 }
 
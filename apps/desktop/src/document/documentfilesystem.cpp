@@ -16,6 +16,7 @@
 #include "documentfilesystem.h"
 
 #include <QDir>
+#include <QHash>
 #include <QtDebug>
 #include <QDateTime>
 #include <QDataStream>
@@ -26,6 +27,7 @@
 
 #include "scrite.h"
 #include "quazip.h"
+#include "filecopy.h"
 #include "quazipfile.h"
 #include "simplecrypt.h"
 #include "restapikey/restapikey.h"
@@ -38,6 +40,9 @@ struct DocumentFileSystemData
     QScopedPointer<QTemporaryDir> folder;
     qint64 fileNameCounter = 0;
 
+    QHash<QString, int> claimCounts;
+    QHash<const QObject *, QStringList> claimsByOwner;
+
     static const QString normalHeaderFile;
     static const QString encryptedHeaderFile;
 
@@ -249,7 +254,7 @@ bool saveTask(const QByteArray &header, bool encrypt, const QDir &folder,
         if (QFile::exists(targetFileName))
             success &= QFile::remove(targetFileName);
         if (success)
-            success &= QFile::copy(tmpFileName, targetFileName);
+            success &= FileCopy::copy(tmpFileName, targetFileName);
         QFile::remove(tmpFileName);
     }
 
@@ -404,7 +409,7 @@ QString DocumentFileSystem::add(const QString &fileName, const QString &ns)
     const QString suffix = fi.suffix().toLower();
     const QString path = ns + "/" + QString::number(d->fileNameCounter++) + "." + suffix;
     const QString absPath = this->absolutePath(path, true);
-    if (QFile::copy(fileName, absPath)) {
+    if (FileCopy::copy(fileName, absPath)) {
         QFile copiedFile(absPath);
         copiedFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner
                                   | QFileDevice::ReadUser | QFileDevice::WriteUser
@@ -431,7 +436,7 @@ QString DocumentFileSystem::duplicate(const QString &fileName, const QString &ns
 
     const QString path = ns + "/" + QString::number(d->fileNameCounter++) + "." + fi.suffix();
     const QString absPath = this->absolutePath(path, true);
-    if (QFile::copy(fi.absoluteFilePath(), absPath)) {
+    if (FileCopy::copy(fi.absoluteFilePath(), absPath)) {
         QFile copiedFile(absPath);
         copiedFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner
                                   | QFileDevice::ReadUser | QFileDevice::WriteUser
@@ -543,7 +548,7 @@ QString DocumentFileSystem::addFile(const QString &srcFile, const QString &dstPa
     }
 
     // Copy the file into the DFS.
-    if (!QFile::copy(srcFile, dstPath))
+    if (!FileCopy::copy(srcFile, absDstPath))
         return QString();
 
     // That's it
@@ -603,13 +608,97 @@ QString DocumentFileSystem::addImage(const QImage &srcImage, const QString &dstP
     return ret ? this->relativePath(absDstPath) : QString();
 }
 
+void DocumentFileSystem::setClaims(QObject *owner, const QStringList &paths)
+{
+    if (owner == nullptr)
+        return;
+
+    QStringList newClaims;
+    newClaims.reserve(paths.size());
+    for (const QString &path : paths) {
+        const QString claim = this->claimPath(path);
+        if (!claim.isEmpty() && !newClaims.contains(claim))
+            newClaims.append(claim);
+    }
+
+    const QStringList oldClaims = d->claimsByOwner.value(owner);
+    if (oldClaims == newClaims)
+        return;
+
+    for (const QString &claim : oldClaims) {
+        if (newClaims.contains(claim))
+            continue;
+
+        auto it = d->claimCounts.find(claim);
+        if (it != d->claimCounts.end() && --it.value() <= 0)
+            d->claimCounts.erase(it);
+    }
+
+    for (const QString &claim : std::as_const(newClaims)) {
+        if (!oldClaims.contains(claim))
+            ++d->claimCounts[claim];
+    }
+
+    if (newClaims.isEmpty()) {
+        d->claimsByOwner.remove(owner);
+        disconnect(owner, &QObject::destroyed, this, &DocumentFileSystem::onClaimOwnerDestroyed);
+    } else {
+        d->claimsByOwner.insert(owner, newClaims);
+        connect(owner, &QObject::destroyed, this, &DocumentFileSystem::onClaimOwnerDestroyed,
+                Qt::UniqueConnection);
+    }
+}
+
+int DocumentFileSystem::claimCount(const QString &path) const
+{
+    return d->claimCounts.value(this->claimPath(path));
+}
+
+void DocumentFileSystem::onClaimOwnerDestroyed(QObject *owner)
+{
+    // Owner is half destroyed by now, so this must not call any of its methods.
+    const QStringList claims = d->claimsByOwner.take(owner);
+    for (const QString &claim : claims) {
+        auto it = d->claimCounts.find(claim);
+        if (it != d->claimCounts.end() && --it.value() <= 0)
+            d->claimCounts.erase(it);
+    }
+}
+
+QString DocumentFileSystem::claimPath(const QString &path) const
+{
+    if (path.isEmpty())
+        return QString();
+
+    if (QDir::isAbsolutePath(path)) {
+        // Files outside the DFS folder cannot be cleaned up anyway
+        if (!path.startsWith(d->folder->path()))
+            return QString();
+
+        return QDir::cleanPath(this->relativePath(path));
+    }
+
+    return QDir::cleanPath(path);
+}
+
 void DocumentFileSystem::cleanup()
 {
     const QStringList filePaths = d->filePaths();
+
+#ifndef QT_NO_DEBUG_OUTPUT
     for (const QString &filePath : filePaths) {
         int claims = 0;
         emit auction(filePath, &claims);
-        if (claims == 0)
+
+        const int registeredClaims = d->claimCounts.value(filePath);
+        if ((claims > 0) != (registeredClaims > 0))
+            qWarning() << "PA: DocumentFileSystem claims mismatch for" << filePath
+                       << "auction:" << claims << "registry:" << registeredClaims;
+    }
+#endif
+
+    for (const QString &filePath : filePaths) {
+        if (!d->claimCounts.contains(filePath))
             this->remove(filePath);
     }
 }
@@ -70,7 +70,14 @@ public:
     QString addImage(const QImage &srcImage, const QString &dstPath, const QSize &scaleTo = QSize(),
                      bool replaceIfExists = true);
 
-    // API to cleanup unreferenced files that may be lying around.
+    // Objects that reference files in the DFS claim them here. Claims are reference counted
+    // across owners, and released automatically when an owner is destroyed. Files without
+    // any claims are removed before saving.
+    void setClaims(QObject *owner, const QStringList &paths);
+    int claimCount(const QString &path) const;
+
+    // Debug builds also auction each file before saving, to verify that claims registered
+    // above are consistent with files actually referenced by document objects.
     Q_SIGNAL void auction(const QString &path, int *claims);
 
 signals:
@@ -83,6 +90,8 @@ private:
     bool pack(QDataStream &ds);
     bool unpack(QDataStream &ds);
     void saveTaskFinished();
+    void onClaimOwnerDestroyed(QObject *owner);
+    QString claimPath(const QString &path) const;
 
 private:
     friend class DocumentFile;
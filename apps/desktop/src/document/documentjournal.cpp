@@ -0,0 +1,663 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "documentjournal.h"
+
+#include "notes.h"
+#include "scene.h"
+#include "structure.h"
+#include "screenplay.h"
+#include "scritedocument.h"
+#include "qobjectserializer.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const int JournalFormatVersion = 1;
+
+DocumentJournal::DocumentJournal(QObject *parent)
+    : QObject(parent), m_flushTimer("DocumentJournal.m_flushTimer")
+{
+}
+
+DocumentJournal::~DocumentJournal()
+{
+    // An orderly shutdown must not leave a journal behind. Only crashes should.
+    this->end(true);
+}
+
+QString DocumentJournal::filePath(const QString &documentFilePath)
+{
+    if (documentFilePath.isEmpty())
+        return QString();
+
+    const QFileInfo fi(documentFilePath);
+    return fi.absoluteDir().absoluteFilePath(fi.fileName() + QStringLiteral(".journal"));
+}
+
+bool DocumentJournal::begin(ScriteDocument *document, const QString &documentFilePath,
+                            const QString &journalId)
+{
+    this->end(false);
+
+    if (document == nullptr || documentFilePath.isEmpty() || journalId.isEmpty())
+        return false;
+
+    m_document = document;
+    m_journalId = journalId;
+
+    // Retain records of an existing journal, only if they were made on top of the
+    // same full save. Otherwise start afresh.
+    m_file.setFileName(filePath(documentFilePath));
+    bool continueExisting = false;
+    if (m_file.open(QFile::ReadOnly)) {
+        const QJsonObject header = QJsonDocument::fromJson(m_file.readLine()).object();
+        continueExisting = header.value(QStringLiteral("journalId")).toString() == journalId;
+        m_file.close();
+    }
+
+    if (continueExisting) {
+        if (!m_file.open(QFile::WriteOnly | QFile::Append))
+            return false;
+    } else {
+        if (!m_file.open(QFile::WriteOnly | QFile::Truncate) || !this->writeHeader()) {
+            m_file.close();
+            return false;
+        }
+    }
+
+    Structure *structure = document->structure();
+    if (structure != nullptr) {
+        connect(structure->elementsModel(), &QAbstractItemModel::rowsInserted, this,
+                &DocumentJournal::onStructureElementsInserted, Qt::UniqueConnection);
+        for (StructureElement *element : structure->elementsModel()->constList())
+            this->watch(element);
+
+        connect(structure->elementsModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this,
+                &DocumentJournal::onStructureElementsAboutToBeRemoved, Qt::UniqueConnection);
+
+        this->watch(structure->notes());
+    }
+
+    this->watch(document->screenplay());
+
+    return true;
+}
+
+void DocumentJournal::end(bool discard)
+{
+    if (!m_file.isOpen() && m_file.fileName().isEmpty())
+        return;
+
+    if (m_file.isOpen()) {
+        if (!discard)
+            this->flush();
+        m_file.close();
+    }
+
+    if (discard && !m_file.fileName().isEmpty())
+        QFile::remove(m_file.fileName());
+
+    m_file.setFileName(QString());
+    m_flushTimer.stop();
+    m_dirtyKeys.clear();
+    m_dirtyObjects.clear();
+    m_snapshotInProgress = false;
+    m_recordsSinceSnapshot.clear();
+    m_journalId.clear();
+
+    // Objects of the document are watched only while the journal is active.
+    if (!m_document.isNull()) {
+        Structure *structure = m_document->structure();
+        if (structure != nullptr) {
+            disconnect(structure->elementsModel(), nullptr, this, nullptr);
+            for (StructureElement *element : structure->elementsModel()->constList()) {
+                disconnect(element, nullptr, this, nullptr);
+                if (element->scene() != nullptr) {
+                    disconnect(element->scene(), nullptr, this, nullptr);
+                    disconnect(element->scene()->notes(), nullptr, this, nullptr);
+                }
+            }
+            disconnect(structure->notes(), nullptr, this, nullptr);
+        }
+
+        if (m_document->screenplay() != nullptr)
+            disconnect(m_document->screenplay(), nullptr, this, nullptr);
+    }
+    m_document = nullptr;
+}
+
+int DocumentJournal::replay(ScriteDocument *document, const QString &documentFilePath,
+                            const QString &journalId)
+{
+    if (document == nullptr || journalId.isEmpty())
+        return 0;
+
+    QFile file(filePath(documentFilePath));
+    if (!file.open(QFile::ReadOnly))
+        return 0;
+
+    const QJsonObject header = QJsonDocument::fromJson(file.readLine()).object();
+    if (header.value(QStringLiteral("version")).toInt() > JournalFormatVersion
+        || header.value(QStringLiteral("journalId")).toString() != journalId)
+        return 0;
+
+    int ret = 0;
+    while (!file.atEnd()) {
+        // A crash could have cut the last record short. Such a record won't parse, and
+        // is simply skipped.
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        QJsonParseError error;
+        const QJsonDocument record = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !record.isObject())
+            continue;
+
+        if (applyRecord(document, record.object()))
+            ++ret;
+    }
+
+    return ret;
+}
+
+void DocumentJournal::beginSnapshot()
+{
+    if (!m_file.isOpen())
+        return;
+
+    // The save may yet fail, in which case the journal must still have all edits made on
+    // top of the previous full save. So pending edits are written out, not discarded.
+    this->flush();
+
+    m_snapshotInProgress = true;
+    m_recordsSinceSnapshot.clear();
+}
+
+void DocumentJournal::abortSnapshot()
+{
+    m_snapshotInProgress = false;
+    m_recordsSinceSnapshot.clear();
+}
+
+void DocumentJournal::commitSnapshot(const QString &documentFilePath, const QString &journalId)
+{
+    if (m_document.isNull())
+        return;
+
+    // Compact the journal: only edits made after the snapshot began need to be replayed
+    // on top of the new full save.
+    this->flush();
+
+    const QList<QJsonObject> records = m_recordsSinceSnapshot;
+    ScriteDocument *document = m_document;
+
+    // Journal of the file from which the document was saved-as is no longer needed.
+    this->end(filePath(documentFilePath) != m_file.fileName());
+    if (this->begin(document, documentFilePath, journalId))
+        this->writeRecords(records);
+}
+
+void DocumentJournal::flush()
+{
+    m_flushTimer.stop();
+
+    if (!m_file.isOpen() || m_dirtyKeys.isEmpty())
+        return;
+
+    // Screenplay records refer to scenes by their IDs. So they are written after records
+    // of scenes that may have been created in the same batch.
+    const QString screenplayKey = QStringLiteral("screenplay");
+    if (m_dirtyKeys.removeOne(screenplayKey))
+        m_dirtyKeys.append(screenplayKey);
+
+    QList<QJsonObject> records;
+    records.reserve(m_dirtyKeys.size());
+    for (const QString &key : std::as_const(m_dirtyKeys)) {
+        if (key.startsWith(QStringLiteral("remove:"))) {
+            QJsonObject record;
+            record.insert(QStringLiteral("op"), QStringLiteral("remove"));
+            record.insert(QStringLiteral("scene"), key.mid(7));
+            records.append(record);
+            continue;
+        }
+
+        QObject *object = m_dirtyObjects.value(key);
+        if (object != nullptr)
+            records.append(this->createRecord(key, object));
+    }
+
+    m_dirtyKeys.clear();
+    m_dirtyObjects.clear();
+
+    this->writeRecords(records);
+
+    if (m_snapshotInProgress)
+        m_recordsSinceSnapshot += records;
+}
+
+void DocumentJournal::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_flushTimer.timerId()) {
+        m_flushTimer.stop();
+        this->flush();
+    } else
+        QObject::timerEvent(event);
+}
+
+void DocumentJournal::watch(StructureElement *element)
+{
+    if (element == nullptr)
+        return;
+
+    connect(element, &StructureElement::elementChanged, this,
+            &DocumentJournal::onStructureElementChanged, Qt::UniqueConnection);
+    connect(element, &StructureElement::sceneChanged, this,
+            &DocumentJournal::onStructureElementSceneChanged, Qt::UniqueConnection);
+
+    Scene *scene = element->scene();
+    if (scene != nullptr) {
+        connect(scene, &Scene::sceneChanged, this, &DocumentJournal::onSceneChanged,
+                Qt::UniqueConnection);
+        this->watch(scene->notes());
+    }
+}
+
+void DocumentJournal::watch(Screenplay *screenplay)
+{
+    if (screenplay == nullptr)
+        return;
+
+    connect(screenplay, &Screenplay::elementInserted, this,
+            &DocumentJournal::onScreenplayChanged, Qt::UniqueConnection);
+    connect(screenplay, &Screenplay::elementRemoved, this, &DocumentJournal::onScreenplayChanged,
+            Qt::UniqueConnection);
+    connect(screenplay, &Screenplay::elementMoved, this, &DocumentJournal::onScreenplayChanged,
+            Qt::UniqueConnection);
+    connect(screenplay, &Screenplay::elementOmitted, this, &DocumentJournal::onScreenplayChanged,
+            Qt::UniqueConnection);
+    connect(screenplay, &Screenplay::elementIncluded, this,
+            &DocumentJournal::onScreenplayChanged, Qt::UniqueConnection);
+
+    // Break titles, scene numbers and such of individual elements
+    connect(screenplay, &QAbstractItemModel::dataChanged, this,
+            &DocumentJournal::onScreenplayChanged, Qt::UniqueConnection);
+}
+
+void DocumentJournal::watch(Notes *notes)
+{
+    if (notes == nullptr)
+        return;
+
+    connect(notes, &QAbstractItemModel::rowsInserted, this, &DocumentJournal::onNotesInserted,
+            Qt::UniqueConnection);
+    for (Note *note : notes->constList())
+        this->watch(note);
+}
+
+void DocumentJournal::watch(Note *note)
+{
+    if (note != nullptr)
+        connect(note, &Note::noteModified, this, &DocumentJournal::onNoteModified,
+                Qt::UniqueConnection);
+}
+
+void DocumentJournal::onStructureElementsInserted(const QModelIndex &parent, int first,
+                                                  int last)
+{
+    Q_UNUSED(parent)
+
+    Structure *structure = m_document.isNull() ? nullptr : m_document->structure();
+    if (structure == nullptr)
+        return;
+
+    for (int i = first; i <= last; i++) {
+        StructureElement *element = structure->elementAt(i);
+        this->watch(element);
+        if (element != nullptr && element->scene() != nullptr)
+            this->markDirty(QStringLiteral("element:") + element->scene()->id(), element);
+    }
+}
+
+void DocumentJournal::onStructureElementsAboutToBeRemoved(const QModelIndex &parent, int first,
+                                                         int last)
+{
+    Q_UNUSED(parent)
+
+    Structure *structure = m_document.isNull() ? nullptr : m_document->structure();
+    if (structure == nullptr || !m_file.isOpen() || m_document->isLoading())
+        return;
+
+    for (int i = first; i <= last; i++) {
+        StructureElement *element = structure->elementAt(i);
+        if (element == nullptr || element->scene() == nullptr)
+            continue;
+
+        // Edits to the scene are moot now. Only its removal needs to be recorded.
+        const QString sceneId = element->scene()->id();
+        const QString elementKey = QStringLiteral("element:") + sceneId;
+        m_dirtyKeys.removeOne(elementKey);
+        m_dirtyObjects.remove(elementKey);
+
+        const QString removeKey = QStringLiteral("remove:") + sceneId;
+        if (!m_dirtyKeys.contains(removeKey))
+            m_dirtyKeys.append(removeKey);
+    }
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start(1000, this);
+}
+
+void DocumentJournal::onScreenplayChanged()
+{
+    if (!m_document.isNull())
+        this->markDirty(QStringLiteral("screenplay"), m_document->screenplay());
+}
+
+void DocumentJournal::onNotesInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent)
+
+    Notes *notes = qobject_cast<Notes *>(this->sender());
+    if (notes == nullptr)
+        return;
+
+    for (int i = first; i <= last; i++) {
+        Note *note = notes->noteAt(i);
+        this->watch(note);
+        if (note != nullptr)
+            this->markDirty(QStringLiteral("note:") + note->id(), note);
+    }
+}
+
+void DocumentJournal::onStructureElementSceneChanged()
+{
+    StructureElement *element = qobject_cast<StructureElement *>(this->sender());
+    this->watch(element);
+    if (element != nullptr && element->scene() != nullptr)
+        this->markDirty(QStringLiteral("element:") + element->scene()->id(), element);
+}
+
+void DocumentJournal::onStructureElementChanged()
+{
+    StructureElement *element = qobject_cast<StructureElement *>(this->sender());
+    if (element != nullptr && element->scene() != nullptr)
+        this->markDirty(QStringLiteral("element:") + element->scene()->id(), element);
+}
+
+void DocumentJournal::onSceneChanged()
+{
+    Scene *scene = qobject_cast<Scene *>(this->sender());
+    StructureElement *element = scene ? scene->structureElement() : nullptr;
+    if (element != nullptr)
+        this->markDirty(QStringLiteral("element:") + scene->id(), element);
+}
+
+void DocumentJournal::onNoteModified()
+{
+    Note *note = qobject_cast<Note *>(this->sender());
+    if (note != nullptr)
+        this->markDirty(QStringLiteral("note:") + note->id(), note);
+}
+
+void DocumentJournal::markDirty(const QString &key, QObject *object)
+{
+    if (!m_file.isOpen() || object == nullptr)
+        return;
+
+    if (m_document && m_document->isLoading())
+        return;
+
+    // Objects are serialized only when the journal is flushed, so a burst of edits to
+    // the same scene (say while typing) results in just one record.
+    if (!m_dirtyObjects.contains(key))
+        m_dirtyKeys.append(key);
+    m_dirtyObjects[key] = object;
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start(1000, this);
+}
+
+QJsonObject DocumentJournal::createRecord(const QString &key, QObject *object) const
+{
+    QJsonObject ret;
+
+    if (key.startsWith(QStringLiteral("element:"))) {
+        ret.insert(QStringLiteral("op"), QStringLiteral("element"));
+        ret.insert(QStringLiteral("element"), QObjectSerializer::toJson(object));
+        return ret;
+    }
+
+    const Screenplay *screenplay = qobject_cast<const Screenplay *>(object);
+    if (screenplay != nullptr) {
+        QJsonArray jsElements;
+        for (int i = 0; i < screenplay->elementCount(); i++)
+            jsElements.append(QObjectSerializer::toJson(screenplay->elementAt(i)));
+
+        ret.insert(QStringLiteral("op"), QStringLiteral("screenplay"));
+        ret.insert(QStringLiteral("elements"), jsElements);
+        return ret;
+    }
+
+    const Note *note = qobject_cast<const Note *>(object);
+    if (note != nullptr) {
+        ret.insert(QStringLiteral("op"), QStringLiteral("note"));
+        ret.insert(QStringLiteral("notes"), note->notes() ? note->notes()->id() : QString());
+        ret.insert(QStringLiteral("note"), QObjectSerializer::toJson(object));
+    }
+
+    return ret;
+}
+
+bool DocumentJournal::writeHeader()
+{
+    QJsonObject header;
+    header.insert(QStringLiteral("version"), JournalFormatVersion);
+    header.insert(QStringLiteral("journalId"), m_journalId);
+    if (m_document)
+        header.insert(QStringLiteral("documentId"), m_document->documentId());
+
+    return this->writeRecords({ header });
+}
+
+bool DocumentJournal::writeRecords(const QList<QJsonObject> &records)
+{
+    if (!m_file.isOpen())
+        return false;
+
+    QByteArray bytes;
+    for (const QJsonObject &record : records) {
+        if (record.isEmpty())
+            continue;
+        bytes += QJsonDocument(record).toJson(QJsonDocument::Compact);
+        bytes += '\n';
+    }
+
+    if (bytes.isEmpty())
+        return true;
+
+    if (m_file.write(bytes) != bytes.size() || !m_file.flush())
+        return false;
+
+    // Flushing only hands bytes over to the OS. Make sure they are on disk, so that
+    // they survive a power loss as well.
+#ifdef Q_OS_WIN
+    return ::_commit(m_file.handle()) == 0;
+#else
+    return ::fsync(m_file.handle()) == 0;
+#endif
+}
+
+bool DocumentJournal::applyRecord(ScriteDocument *document, const QJsonObject &record)
+{
+    const QString op = record.value(QStringLiteral("op")).toString();
+
+    if (op == QStringLiteral("element")) {
+        Structure *structure = document->structure();
+        const QJsonObject jsElement = record.value(QStringLiteral("element")).toObject();
+        const QJsonObject jsScene = jsElement.value(QStringLiteral("scene")).toObject();
+        const QString sceneId = jsScene.value(QStringLiteral("id")).toString();
+        if (structure == nullptr || sceneId.isEmpty())
+            return false;
+
+        StructureElement *element = structure->findElementBySceneID(sceneId);
+        if (element == nullptr) {
+            // Scene was created after the last full save.
+            element = new StructureElement(structure);
+            if (!QObjectSerializer::fromJson(jsElement, element)) {
+                delete element;
+                return false;
+            }
+
+            // It is added to the screenplay by the screenplay record that follows.
+            structure->addElement(element);
+            return true;
+        }
+
+        // Everything other than the scene is replayed as is: position, size, title, stack
+        // and so on.
+        QJsonObject jsElementFields = jsElement;
+        jsElementFields.remove(QStringLiteral("scene"));
+        QObjectSerializer::fromJson(jsElementFields, element);
+
+        // Scene fields like heading, synopsis and color are replayed as is. Paragraphs are
+        // updated in place where possible, see below. Notes have records of their own.
+        Scene *scene = element->scene();
+        QJsonObject jsSceneFields = jsScene;
+        jsSceneFields.remove(QStringLiteral("elements"));
+        jsSceneFields.remove(QStringLiteral("notes"));
+        QObjectSerializer::fromJson(jsSceneFields, scene);
+
+        const QJsonArray jsParas = jsScene.value(QStringLiteral("elements")).toArray();
+
+        // Paragraph edits are far more common than paragraphs being added, removed or
+        // moved around. So update paragraphs in place, if the list is still the same.
+        bool sameParas = jsParas.size() == scene->elementCount();
+        for (int i = 0; sameParas && i < jsParas.size(); i++)
+            sameParas = jsParas.at(i).toObject().value(QStringLiteral("id")).toString()
+                    == scene->elementAt(i)->id();
+
+        if (sameParas) {
+            for (int i = 0; i < jsParas.size(); i++)
+                QObjectSerializer::fromJson(jsParas.at(i).toObject(), scene->elementAt(i));
+        } else {
+            while (scene->elementCount() > 0)
+                scene->removeElement(scene->elementAt(scene->elementCount() - 1));
+
+            for (const QJsonValue &jsPara : jsParas) {
+                SceneElement *para = new SceneElement(scene);
+                QObjectSerializer::fromJson(jsPara.toObject(), para);
+                scene->addElement(para);
+            }
+        }
+
+        return true;
+    }
+
+    if (op == QStringLiteral("remove")) {
+        Structure *structure = document->structure();
+        const QString sceneId = record.value(QStringLiteral("scene")).toString();
+        StructureElement *element =
+                structure == nullptr ? nullptr : structure->findElementBySceneID(sceneId);
+        if (element == nullptr)
+            return false;
+
+        structure->removeElement(element);
+        return true;
+    }
+
+    if (op == QStringLiteral("screenplay"))
+        return applyScreenplayRecord(document->screenplay(),
+                                     record.value(QStringLiteral("elements")).toArray());
+
+    if (op == QStringLiteral("note")) {
+        const QJsonObject jsNote = record.value(QStringLiteral("note")).toObject();
+        Note *note = Note::findById(jsNote.value(QStringLiteral("id")).toString());
+        if (note != nullptr)
+            return QObjectSerializer::fromJson(jsNote, note);
+
+        // Note was created after the last full save.
+        Notes *notes = Notes::findById(record.value(QStringLiteral("notes")).toString());
+        if (notes == nullptr)
+            return false;
+
+        note = new Note(notes);
+        if (!QObjectSerializer::fromJson(jsNote, note)) {
+            delete note;
+            return false;
+        }
+
+        notes->addNote(note);
+        return true;
+    }
+
+    return false;
+}
+
+bool DocumentJournal::applyScreenplayRecord(Screenplay *screenplay, const QJsonArray &jsElements)
+{
+    if (screenplay == nullptr)
+        return false;
+
+    // Existing elements are reused, matched by the scene (or break) they stand for. A scene
+    // can show up more than once in a screenplay, so matches are consumed in order.
+    QMultiHash<QString, ScreenplayElement *> existingElements;
+    for (int i = screenplay->elementCount() - 1; i >= 0; i--) {
+        ScreenplayElement *element = screenplay->elementAt(i);
+        existingElements.insert(element->sceneID(), element);
+    }
+
+    int index = 0;
+    for (const QJsonValue &jsElementValue : jsElements) {
+        const QJsonObject jsElement = jsElementValue.toObject();
+        const QString sceneID = jsElement.value(QStringLiteral("sceneID")).toString();
+
+        ScreenplayElement *element = existingElements.take(sceneID);
+        if (element == nullptr) {
+            element = new ScreenplayElement(screenplay);
+            QObjectSerializer::fromJson(jsElement, element);
+
+            // A scene that is neither in the document nor journaled can't be recovered.
+            if (element->elementType() == ScreenplayElement::SceneElementType
+                && element->scene() == nullptr) {
+                delete element;
+                continue;
+            }
+
+            screenplay->insertElementAt(element, index);
+        } else {
+            QObjectSerializer::fromJson(jsElement, element);
+            if (screenplay->indexOfElement(element) != index)
+                screenplay->moveElement(element, index);
+        }
+
+        ++index;
+    }
+
+    // Whatever didn't find a match was removed from the screenplay after the full save.
+    const QList<ScreenplayElement *> removedElements = existingElements.values();
+    if (!removedElements.isEmpty())
+        screenplay->removeElements(removedElements);
+
+    return true;
+}
@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef DOCUMENTJOURNAL_H
+#define DOCUMENTJOURNAL_H
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "execlatertimer.h"
+
+class Note;
+class Notes;
+class Scene;
+class Structure;
+class Screenplay;
+class ScriteDocument;
+class StructureElement;
+
+/**
+ * An append-only journal of edits made to a document since it was last saved in full.
+ *
+ * The journal is written next to the document file (<document>.journal), with one JSON
+ * record per line. The first line identifies the full save it applies to. Records capture
+ * the latest state of index cards along with their scenes, removal of scenes, the order of
+ * scenes and breaks in the screenplay, and notes. So replaying them in order is idempotent.
+ * Edits are coalesced per object and flushed to disk, with fsync, once a second.
+ *
+ * If Scrite exits without a crash, the journal is discarded. Otherwise it is replayed on
+ * top of the document the next time it is opened.
+ */
+class DocumentJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentJournal(QObject *parent = nullptr);
+    ~DocumentJournal();
+
+    static QString filePath(const QString &documentFilePath);
+
+    // Starts (or continues) journaling edits made to document, on top of a full save
+    // identified by journalId. Existing records are retained only if they were made on top
+    // of the same full save.
+    bool begin(ScriteDocument *document, const QString &documentFilePath,
+               const QString &journalId);
+
+    // Stops journaling. A discarded journal is removed from disk.
+    void end(bool discard = true);
+
+    bool isActive() const { return m_file.isOpen(); }
+    QString journalId() const { return m_journalId; }
+    qint64 size() const { return m_file.isOpen() ? m_file.size() : 0; }
+
+    // Applies records found in the journal of documentFilePath, if they were made on top of
+    // the full save identified by journalId. Returns number of records applied.
+    static int replay(ScriteDocument *document, const QString &documentFilePath,
+                      const QString &journalId);
+
+    // A full save is about to capture the document. Records made after this are the only
+    // ones that need to survive into the journal of the new full save.
+    void beginSnapshot();
+
+    // The full save begun with beginSnapshot() failed. The journal continues on top of the
+    // previous full save.
+    void abortSnapshot();
+
+    // The full save identified by journalId has been written to documentFilePath.
+    void commitSnapshot(const QString &documentFilePath, const QString &journalId);
+
+    void flush();
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    void watch(StructureElement *element);
+    void watch(Notes *notes);
+    void watch(Note *note);
+    void watch(Screenplay *screenplay);
+    void onStructureElementsInserted(const QModelIndex &parent, int first, int last);
+    void onStructureElementsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onScreenplayChanged();
+    void onNotesInserted(const QModelIndex &parent, int first, int last);
+    void onStructureElementSceneChanged();
+    void onStructureElementChanged();
+    void onSceneChanged();
+    void onNoteModified();
+    void markDirty(const QString &key, QObject *object);
+    QJsonObject createRecord(const QString &key, QObject *object) const;
+    bool writeHeader();
+    bool writeRecords(const QList<QJsonObject> &records);
+    static bool applyRecord(ScriteDocument *document, const QJsonObject &record);
+    static bool applyScreenplayRecord(Screenplay *screenplay, const QJsonArray &jsElements);
+
+private:
+    QFile m_file;
+    QString m_journalId;
+    QPointer<ScriteDocument> m_document;
+    ExecLaterTimer m_flushTimer;
+    QList<QString> m_dirtyKeys;
+    QHash<QString, QPointer<QObject>> m_dirtyObjects;
+    bool m_snapshotInProgress = false;
+    QList<QJsonObject> m_recordsSinceSnapshot;
+};
+
+#endif // DOCUMENTJOURNAL_H
@@ -370,6 +370,7 @@ private:
     friend class Scene;
     friend class Character;
     friend class Structure;
+    friend class DocumentJournal;
     void setId(const QString &val);
     void addNote(Note *ptr);
     void setNotes(const QList<Note *> &list);
@@ -17,6 +17,7 @@
 #include "utils.h"
 #include "undoredo.h"
 #include "hourglass.h"
+#include "stringpool.h"
 #include "screenplayformat.h"
 #include "application.h"
 #include "searchengine.h"
@@ -25,6 +26,7 @@
 #include "languageengine.h"
 #include "garbagecollector.h"
 #include "qobjectserializer.h"
+#include "parentchangenotifier.h"
 #include "screenplaypaginator.h"
 #include "screenplaytextdocument.h"
 
@@ -76,8 +78,6 @@ SceneHeading::SceneHeading(QObject *parent)
         this->markAsModified();
         this->evaluateWordCountLater();
     });
-    connect(this, &SceneHeading::wordCountChanged, m_scene, &Scene::evaluateWordCountLater,
-            Qt::UniqueConnection);
 }
 
 SceneHeading::~SceneHeading() { }
@@ -93,6 +93,18 @@ void SceneHeading::setEnabled(bool val)
     emit enabledChanged();
 }
 
+// Headings read from a file are committed values, and worth adding to the StringPool.
+// Headings being typed are not, they would leave every prefix of a location in the pool. Those
+// only share the pooled copy, if there is one already.
+static inline QString internedHeadingValue(const QString &val)
+{
+    const ScriteDocument *document = ScriteDocument::instance();
+    if (document != nullptr && document->isLoading())
+        return StringPool::interned(val);
+
+    return StringPool::shared(val);
+}
+
 void SceneHeading::setLocationType(const QString &val2)
 {
     const QString val = val2.toUpper().trimmed();
@@ -101,7 +113,7 @@ void SceneHeading::setLocationType(const QString &val2)
 
     PushSceneUndoCommand cmd(new SceneHeadingUndoCommand(this));
 
-    m_locationType = val;
+    m_locationType = internedHeadingValue(val);
     emit locationTypeChanged();
 }
 
@@ -113,7 +125,7 @@ void SceneHeading::setLocation(const QString &val2)
 
     PushSceneUndoCommand cmd(new SceneHeadingUndoCommand(this));
 
-    m_location = val;
+    m_location = internedHeadingValue(val);
     emit locationChanged();
 }
 
@@ -125,7 +137,7 @@ void SceneHeading::setMoment(const QString &val2)
 
     PushSceneUndoCommand cmd(new SceneHeadingUndoCommand(this));
 
-    m_moment = val;
+    m_moment = internedHeadingValue(val);
     emit momentChanged();
 }
 
@@ -233,8 +245,12 @@ void SceneHeading::setWordCount(int val)
     if (m_wordCount == val)
         return;
 
+    const int delta = val - m_wordCount;
     m_wordCount = val;
     emit wordCountChanged();
+
+    if (m_scene != nullptr)
+        m_scene->adjustWordCount(delta);
 }
 
 void SceneHeading::evaluateWordCount()
@@ -256,10 +272,6 @@ SceneElement::SceneElement(QObject *parent)
     connect(this, &SceneElement::typeChanged, this, &SceneElement::elementChanged);
     connect(this, &SceneElement::textChanged, this, &SceneElement::elementChanged);
     connect(this, &SceneElement::elementChanged, [=]() { this->markAsModified(); });
-
-    if (m_scene != nullptr)
-        connect(this, &SceneElement::wordCountChanged, m_scene, &Scene::evaluateWordCountLater,
-                Qt::UniqueConnection);
 }
 
 SceneElement::~SceneElement()
@@ -843,17 +855,132 @@ QVector<QTextLayout::FormatRange> SceneElement::textFormatsFromJson(const QJsonA
     return textFormats;
 }
 
+namespace {
+
+enum TextFormatStreamAttribute {
+    BoldAttribute = 1,
+    ItalicsAttribute = 2,
+    UnderlineAttribute = 4,
+    StrikeOutAttribute = 8,
+    HrefAttribute = 16,
+    BackgroundAttribute = 32,
+    ForegroundAttribute = 64
+};
+
+} // namespace
+
+void SceneElement::textFormatsToStream(QDataStream &ds,
+                                       const QVector<QTextLayout::FormatRange> &formats)
+{
+    QVector<QTextLayout::FormatRange> formatsToWrite;
+    QVector<quint8> attributes;
+    formatsToWrite.reserve(formats.size());
+    attributes.reserve(formats.size());
+
+    for (const QTextLayout::FormatRange &formatRange : formats) {
+        const QTextCharFormat &format = formatRange.format;
+
+        quint8 attribs = 0;
+        if (format.isAnchor() && format.hasProperty(QTextFormat::AnchorHref)
+            && !format.anchorHref().isEmpty())
+            attribs |= HrefAttribute;
+        if (format.hasProperty(QTextFormat::FontWeight) && format.fontWeight() == QFont::Bold)
+            attribs |= BoldAttribute;
+        if (format.hasProperty(QTextFormat::FontItalic) && format.fontItalic())
+            attribs |= ItalicsAttribute;
+        if (format.hasProperty(QTextFormat::TextUnderlineStyle) && format.fontUnderline())
+            attribs |= UnderlineAttribute;
+        if (format.hasProperty(QTextFormat::FontStrikeOut) && format.fontStrikeOut())
+            attribs |= StrikeOutAttribute;
+        if (format.hasProperty(QTextFormat::BackgroundBrush)
+            && !qFuzzyIsNull(format.background().color().alphaF()))
+            attribs |= BackgroundAttribute;
+        if (format.hasProperty(QTextFormat::ForegroundBrush)
+            && !qFuzzyIsNull(format.foreground().color().alphaF()))
+            attribs |= ForegroundAttribute;
+
+        if (attribs == 0)
+            continue;
+
+        formatsToWrite.append(formatRange);
+        attributes.append(attribs);
+    }
+
+    ds << qint32(formatsToWrite.size());
+    for (int i = 0; i < formatsToWrite.size(); i++) {
+        const QTextLayout::FormatRange &formatRange = formatsToWrite.at(i);
+        const quint8 attribs = attributes.at(i);
+
+        ds << qint32(formatRange.start) << qint32(formatRange.length) << attribs;
+        if (attribs & HrefAttribute)
+            ds << formatRange.format.anchorHref();
+        if (attribs & BackgroundAttribute)
+            ds << quint32(formatRange.format.background().color().rgb());
+        if (attribs & ForegroundAttribute)
+            ds << quint32(formatRange.format.foreground().color().rgb());
+    }
+}
+
+QVector<QTextLayout::FormatRange> SceneElement::textFormatsFromStream(QDataStream &ds)
+{
+    QVector<QTextLayout::FormatRange> textFormats;
+
+    qint32 nrFormats = 0;
+    ds >> nrFormats;
+    if (nrFormats <= 0 || ds.status() != QDataStream::Ok)
+        return textFormats;
+
+    // The count comes from the clipboard, which any application can write to. So memory is
+    // reserved only for as many ranges as the remaining bytes can possibly hold: each one
+    // takes at least 9 bytes (start, length and attributes).
+    const qint64 maxFormats = ds.device() ? ds.device()->bytesAvailable() / 9 : 0;
+    textFormats.reserve(int(qMin(qint64(nrFormats), maxFormats)));
+    for (int i = 0; i < nrFormats && ds.status() == QDataStream::Ok; i++) {
+        qint32 start = 0, length = 0;
+        quint8 attribs = 0;
+        ds >> start >> length >> attribs;
+
+        QTextLayout::FormatRange formatRange;
+        formatRange.start = start;
+        formatRange.length = length;
+
+        QTextCharFormat &format = formatRange.format;
+        if (attribs & HrefAttribute) {
+            QString href;
+            ds >> href;
+            format.setAnchor(true);
+            format.setAnchorHref(href);
+        }
+        if (attribs & BoldAttribute)
+            format.setFontWeight(QFont::Bold);
+        if (attribs & ItalicsAttribute)
+            format.setFontItalic(true);
+        if (attribs & UnderlineAttribute)
+            format.setFontUnderline(true);
+        if (attribs & StrikeOutAttribute)
+            format.setFontStrikeOut(true);
+        if (attribs & BackgroundAttribute) {
+            quint32 rgb = 0;
+            ds >> rgb;
+            format.setBackground(QBrush(QColor::fromRgb(rgb)));
+        }
+        if (attribs & ForegroundAttribute) {
+            quint32 rgb = 0;
+            ds >> rgb;
+            format.setForeground(QBrush(QColor::fromRgb(rgb)));
+        }
+
+        if (!format.isEmpty())
+            textFormats.append(formatRange);
+    }
+
+    return textFormats;
+}
+
 bool SceneElement::event(QEvent *event)
 {
-    if (event->type() == QEvent::ParentChange) {
-        if (m_scene != nullptr)
-            disconnect(this, &SceneElement::wordCountChanged, m_scene,
-                       &Scene::evaluateWordCountLater);
+    if (event->type() == QEvent::ParentChange)
         m_scene = qobject_cast<Scene *>(this->parent());
-        if (m_scene != nullptr)
-            connect(this, &SceneElement::wordCountChanged, m_scene, &Scene::evaluateWordCountLater,
-                    Qt::UniqueConnection);
-    }
 
     return QObject::event(event);
 }
@@ -911,8 +1038,12 @@ void SceneElement::setWordCount(int val)
     if (m_wordCount == val)
         return;
 
+    const int delta = val - m_wordCount;
     m_wordCount = val;
     emit wordCountChanged();
+
+    if (m_scene != nullptr)
+        m_scene->adjustWordCount(delta, this);
 }
 
 void SceneElement::evaluateWordCount()
@@ -929,7 +1060,36 @@ void SceneElement::evaluateWordCountLater()
 
 DistinctElementValuesMap::DistinctElementValuesMap(SceneElement::Type type) : m_type(type) { }
 
-DistinctElementValuesMap::~DistinctElementValuesMap() { }
+// Names are held in the StringPool for as long as some element in some map carries them.
+// Otherwise, typing a character name would leave every prefix of it in the pool.
+DistinctElementValuesMap::DistinctElementValuesMap(const DistinctElementValuesMap &other)
+    : m_type(other.m_type), m_forwardMap(other.m_forwardMap), m_reverseMap(other.m_reverseMap)
+{
+    for (int id : std::as_const(m_forwardMap))
+        StringPool::acquire(StringPool::string(id));
+}
+
+DistinctElementValuesMap &DistinctElementValuesMap::operator=(const DistinctElementValuesMap &other)
+{
+    if (this == &other)
+        return *this;
+
+    for (int id : std::as_const(other.m_forwardMap))
+        StringPool::acquire(StringPool::string(id));
+    for (int id : std::as_const(m_forwardMap))
+        StringPool::release(id);
+
+    m_type = other.m_type;
+    m_forwardMap = other.m_forwardMap;
+    m_reverseMap = other.m_reverseMap;
+    return *this;
+}
+
+DistinctElementValuesMap::~DistinctElementValuesMap()
+{
+    for (int id : std::as_const(m_forwardMap))
+        StringPool::release(id);
+}
 
 bool DistinctElementValuesMap::include(SceneElement *element)
 {
@@ -949,8 +1109,9 @@ bool DistinctElementValuesMap::include(SceneElement *element)
         if (newName.isEmpty())
             return ret;
 
-        m_forwardMap[element] = newName;
-        m_reverseMap[newName].append(element);
+        const int newNameId = StringPool::acquire(newName);
+        m_forwardMap[element] = newNameId;
+        m_reverseMap[newNameId].append(element);
         return true;
     }
 
@@ -964,12 +1125,14 @@ bool DistinctElementValuesMap::remove(SceneElement *element)
 {
     // This function returns true if distinctValues() would return
     // a different list after this function returns
-    const QString oldName = m_forwardMap.take(element);
-    if (!oldName.isEmpty()) {
-        QList<SceneElement *> &list = m_reverseMap[oldName];
+    const int oldNameId = m_forwardMap.take(element);
+    if (oldNameId != StringPool::EmptyStringId) {
+        StringPool::release(oldNameId);
+
+        QList<SceneElement *> &list = m_reverseMap[oldNameId];
         if (list.removeOne(element)) {
             if (list.isEmpty()) {
-                m_reverseMap.remove(oldName);
+                m_reverseMap.remove(oldNameId);
                 return true;
             }
 
@@ -990,24 +1153,26 @@ bool DistinctElementValuesMap::remove(const QString &name)
     if (name.isEmpty())
         return false;
 
-    const QList<SceneElement *> elements = m_reverseMap.take(name);
+    const QList<SceneElement *> elements = m_reverseMap.take(StringPool::findId(name));
     if (elements.isEmpty())
         return false;
 
     for (SceneElement *element : elements)
-        m_forwardMap.take(element);
+        StringPool::release(m_forwardMap.take(element));
 
     return true;
 }
 
 QStringList DistinctElementValuesMap::distinctValues() const
 {
-    return m_reverseMap.keys();
+    QStringList ret = StringPool::strings(m_reverseMap.keys());
+    std::sort(ret.begin(), ret.end());
+    return ret;
 }
 
 bool DistinctElementValuesMap::containsValue(const QString &value) const
 {
-    return m_reverseMap.contains(value.toUpper());
+    return m_reverseMap.contains(StringPool::findId(value.toUpper()));
 }
 
 QList<SceneElement *> DistinctElementValuesMap::elements() const
@@ -1017,7 +1182,7 @@ QList<SceneElement *> DistinctElementValuesMap::elements() const
 
 QList<SceneElement *> DistinctElementValuesMap::elements(const QString &value) const
 {
-    return m_reverseMap.value(value.toUpper());
+    return m_reverseMap.value(StringPool::findId(value.toUpper()));
 }
 
 void DistinctElementValuesMap::include(const DistinctElementValuesMap &other)
@@ -1058,6 +1223,13 @@ Scene::Scene(QObject *parent) : QAbstractListModel(parent)
     });
 
     connect(m_attachments, &Attachments::attachmentsModified, this, &Scene::sceneChanged);
+
+    // Word count is otherwise updated by deltas reported from elements and heading. We only
+    // need to add it all up again when the list of elements itself changes.
+    connect(this, &Scene::modelReset, this, &Scene::evaluateWordCountLater);
+    connect(this, &Scene::rowsInserted, this, &Scene::evaluateWordCountLater);
+    connect(this, &Scene::rowsRemoved, this, &Scene::evaluateWordCountLater);
+    connect(m_heading, &SceneHeading::enabledChanged, this, &Scene::evaluateWordCountLater);
     this->evaluateWordCountLater();
 
     QTimer *summaryChangeTimer = new QTimer(this);
@@ -1534,7 +1706,7 @@ void Scene::setGroups(const QStringList &val)
     if (!info->isLocked() && m_undoRedoEnabled)
         cmd.reset(new PushObjectPropertyUndoCommand(this, info->property));
 
-    m_groups = QSet<QString>(val.begin(), val.end()).values();
+    m_groups = StringPool::interned(QSet<QString>(val.begin(), val.end()).values());
     emit groupsChanged();
 }
 
@@ -1548,7 +1720,7 @@ void Scene::addToGroup(const QString &group)
     if (!info->isLocked() && m_undoRedoEnabled)
         cmd.reset(new PushObjectPropertyUndoCommand(this, info->property));
 
-    m_groups.append(group);
+    m_groups.append(StringPool::interned(group));
     m_groups.sort(Qt::CaseInsensitive);
     emit groupsChanged();
 }
@@ -1641,7 +1813,7 @@ void Scene::setTags(const QStringList &val)
     if (!info->isLocked() && m_undoRedoEnabled)
         cmd.reset(new PushObjectPropertyUndoCommand(this, info->property));
 
-    m_tags = val;
+    m_tags = StringPool::interned(val);
     std::sort(m_tags.begin(), m_tags.end(), [](const QString &a, const QString &b) {
         return QString::localeAwareCompare(a.toLower(), b.toLower()) < 0;
     });
@@ -1735,6 +1907,7 @@ void Scene::insertElementAt(SceneElement *ptr, int index)
     ptr->setParent(this);
 
     m_elements.insert(index, ptr);
+    ptr->m_inScene = true;
     connect(ptr, &SceneElement::elementChanged, this, &Scene::sceneChanged);
     connect(ptr, &SceneElement::aboutToDelete, this, &Scene::removeElement);
 
@@ -1765,6 +1938,7 @@ void Scene::removeElement(SceneElement *ptr)
 
     emit aboutToRemoveSceneElement(ptr);
     m_elements.removeAt(row);
+    ptr->m_inScene = false;
 
     disconnect(ptr, &SceneElement::elementChanged, this, &Scene::sceneChanged);
     disconnect(ptr, &SceneElement::aboutToDelete, this, &Scene::removeElement);
@@ -1800,11 +1974,15 @@ void Scene::setElements(const QList<SceneElement *> &list)
 
     this->beginResetModel();
 
-    for (SceneElement *ptr : list) {
-        ptr->setParent(this);
-        connect(ptr, &SceneElement::elementChanged, this, &Scene::sceneChanged);
-        connect(ptr, &SceneElement::aboutToDelete, this, &Scene::removeElement);
-        m_elements.append(ptr);
+    {
+        ParentChangeBatch parentChangeBatch;
+        for (SceneElement *ptr : list) {
+            ptr->setParent(this);
+            connect(ptr, &SceneElement::elementChanged, this, &Scene::sceneChanged);
+            connect(ptr, &SceneElement::aboutToDelete, this, &Scene::removeElement);
+            m_elements.append(ptr);
+            ptr->m_inScene = true;
+        }
     }
 
     this->endResetModel();
@@ -2505,6 +2683,7 @@ void Scene::timerEvent(QTimerEvent *event)
     if (event->timerId() == m_wordCountTimer.timerId()) {
         m_wordCountTimer.stop();
         this->evaluateWordCount();
+        this->evaluateDialogueCount();
     } else
         QObject::timerEvent(event);
 }
@@ -2549,6 +2728,7 @@ void Scene::setElementsList(const QList<SceneElement *> &list)
             this->addElement(item);
         else
             m_elements.append(item);
+        item->m_inScene = true;
 
         if (item->type() == SceneElement::Character)
             m_characterElementMap.include(item);
@@ -2556,6 +2736,7 @@ void Scene::setElementsList(const QList<SceneElement *> &list)
 
     while (!oldElements.isEmpty()) {
         SceneElement *ptr = oldElements.takeFirst();
+        ptr->m_inScene = false;
         emit aboutToRemoveSceneElement(ptr);
         if (ptr->type() == SceneElement::Character)
             m_characterElementMap.remove(ptr);
@@ -2571,10 +2752,13 @@ void Scene::setElementsList(const QList<SceneElement *> &list)
     emit sceneRefreshed();
 }
 
-void Scene::onSceneElementChanged(SceneElement *element, Scene::SceneElementChangeType)
+void Scene::onSceneElementChanged(SceneElement *element, Scene::SceneElementChangeType type)
 {
     if (m_characterElementMap.include(element))
         this->evaluateSortedCharacterNames();
+
+    if (type == ElementTypeChange && !m_wordCountTimer.isActive())
+        this->evaluateDialogueCount();
 }
 
 void Scene::onAboutToRemoveSceneElement(SceneElement *element)
@@ -2683,6 +2867,54 @@ void Scene::evaluateWordCountLater()
     m_wordCountTimer.start(100, this);
 }
 
+void Scene::adjustWordCount(int delta, SceneElement *element)
+{
+    // A full evaluation is already due, which will pick up this change anyway.
+    if (delta == 0 || m_wordCountTimer.isActive())
+        return;
+
+    // Deltas without an element come from the heading.
+    if (element == nullptr) {
+        if (!m_heading->isEnabled())
+            return;
+    } else if (element->m_scene != this || !element->m_inScene)
+        return;
+
+    this->setWordCount(m_wordCount + delta);
+}
+
+int Scene::dialogueCount() const
+{
+    // Counts are evaluated after a short delay, but the screenplay picks them up as soon as
+    // it learns that the scene changed.
+    if (m_wordCountTimer.isActive()) {
+        Scene *ncThis = const_cast<Scene *>(this);
+        ncThis->m_wordCountTimer.stop();
+        ncThis->evaluateWordCount();
+        ncThis->evaluateDialogueCount();
+    }
+
+    return m_dialogueCount;
+}
+
+void Scene::setDialogueCount(int val)
+{
+    if (m_dialogueCount == val)
+        return;
+
+    m_dialogueCount = val;
+    emit dialogueCountChanged();
+}
+
+void Scene::evaluateDialogueCount()
+{
+    int dialogueCount = 0;
+    for (const SceneElement *element : std::as_const(m_elements))
+        dialogueCount += element->type() == SceneElement::Character ? 1 : 0;
+
+    this->setDialogueCount(dialogueCount);
+}
+
 void Scene::trimIndexCardFieldValues()
 {
     if (m_indexCardFieldValues.isEmpty())
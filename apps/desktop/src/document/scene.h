@@ -20,6 +20,7 @@
 #include <QList>
 #include <QColor>
 #include <QPointer>
+#include <QDataStream>
 #include <QQmlEngine>
 #include <QJsonArray>
 #include <QTextLayout>
@@ -164,6 +165,7 @@ class SceneElement : public QObject, public Modifiable, public QObjectSerializer
     Q_OBJECT
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit SceneElement(QObject *parent = nullptr);
@@ -296,6 +298,12 @@ public:
     static QJsonArray textFormatsToJson(const QVector<QTextLayout::FormatRange> &formats);
     static QVector<QTextLayout::FormatRange> textFormatsFromJson(const QJsonArray &array);
 
+    // Binary counterparts of the above, used for clipboard payloads. They retain the same
+    // attributes as the JSON representation.
+    static void textFormatsToStream(QDataStream &ds,
+                                    const QVector<QTextLayout::FormatRange> &formats);
+    static QVector<QTextLayout::FormatRange> textFormatsFromStream(QDataStream &ds);
+
 protected:
     bool event(QEvent *event);
     void timerEvent(QTimerEvent *event);
@@ -315,6 +323,7 @@ private:
     Qt::Alignment m_alignment;
     QVector<QTextLayout::FormatRange> m_textFormats;
     Scene *m_scene = nullptr;
+    bool m_inScene = false; // Whether m_scene lists this element, maintained by Scene
     int m_wordCount = 0;
     mutable SpellCheckService *m_spellCheck = nullptr;
     QBasicTimer m_changeTimer;
@@ -326,6 +335,8 @@ class DistinctElementValuesMap
 {
 public:
     DistinctElementValuesMap(SceneElement::Type type = SceneElement::Character);
+    DistinctElementValuesMap(const DistinctElementValuesMap &other);
+    DistinctElementValuesMap &operator=(const DistinctElementValuesMap &other);
     ~DistinctElementValuesMap();
 
     // These functions returns true if distinctValues() would return
@@ -336,6 +347,7 @@ public:
     bool isEmpty() const { return m_forwardMap.isEmpty() && m_reverseMap.isEmpty(); }
 
     QStringList distinctValues() const;
+    QList<int> distinctValueIds() const { return m_reverseMap.keys(); } // StringPool IDs
     bool containsValue(const QString &value) const;
     QList<SceneElement *> elements() const;
     QList<SceneElement *> elements(const QString &value) const;
@@ -344,8 +356,8 @@ public:
 
 private:
     SceneElement::Type m_type = SceneElement::Character;
-    QMap<SceneElement *, QString> m_forwardMap;
-    QMap<QString, QList<SceneElement *>> m_reverseMap;
+    QMap<SceneElement *, int> m_forwardMap;
+    QHash<int, QList<SceneElement *>> m_reverseMap;
 };
 
 class CharacterElementMap : public DistinctElementValuesMap
@@ -395,6 +407,7 @@ class Scene : public QAbstractListModel, public QObjectSerializer::Interface, pu
     Q_OBJECT
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit Scene(QObject *parent = nullptr);
@@ -697,6 +710,14 @@ public:
     int wordCount() const { return m_wordCount; }
     Q_SIGNAL void wordCountChanged();
 
+    // clang-format off
+    Q_PROPERTY(int dialogueCount
+               READ dialogueCount
+               NOTIFY dialogueCountChanged)
+    // clang-format on
+    int dialogueCount() const;
+    Q_SIGNAL void dialogueCountChanged();
+
     // clang-format off
     Q_PROPERTY(QQmlListProperty<SceneElement> elements
                READ elements
@@ -833,6 +854,9 @@ private:
     void setWordCount(int val);
     void evaluateWordCount();
     void evaluateWordCountLater();
+    void adjustWordCount(int delta, SceneElement *element = nullptr);
+    void setDialogueCount(int val);
+    void evaluateDialogueCount();
     void trimIndexCardFieldValues();
 
     void evaluateSummary();
@@ -849,6 +873,7 @@ private:
     int m_cursorPosition = -1;
     int m_episodeIndex = -1;
     int m_wordCount = 0;
+    int m_dialogueCount = 0;
 
     Type m_type = Standard;
 
@@ -83,7 +83,7 @@ private:
 // SceneUndoCommand — whole-scene undo via serialization
 ///////////////////////////////////////////////////////////////////////////////
 
-class SceneUndoCommand : public AbstractSceneUndoCommand
+class SceneUndoCommand : public AbstractSceneUndoCommand, public UndoCommandMemoryInterface
 {
 public:
     explicit SceneUndoCommand(Scene *scene, bool allowMerging = true,
@@ -96,6 +96,12 @@ public:
     void redo();
     bool mergeWith(const QUndoCommand *other);
 
+    // UndoCommandMemoryInterface interface
+    qint64 memoryUsage() const
+    {
+        return qint64(sizeof(*this)) + m_before.capacity() + m_after.capacity();
+    }
+
 private:
     QByteArray toByteArray(Scene *scene) const;
     Scene *fromByteArray(const QByteArray &bytes) const;
@@ -30,6 +30,7 @@
 #include <QSettings>
 #include <QMetaEnum>
 #include <QMimeData>
+#include <QDataStream>
 #include <QClipboard>
 #include <QPdfWriter>
 #include <QScopeGuard>
@@ -671,10 +672,11 @@ SceneDocumentBinder::SceneDocumentBinder(QObject *parent)
             &SceneDocumentBinder::selectedElementsChanged);
 
     connect(LanguageEngine::instance(), &LanguageEngine::scriptFontFamilyChanged, this,
-            &SceneDocumentBinder::refresh);
+            &SceneDocumentBinder::invalidateHighlights);
 
     QStyleHints *styleHints = qApp->styleHints();
-    connect(styleHints, &QStyleHints::colorSchemeChanged, this, &SceneDocumentBinder::refresh);
+    connect(styleHints, &QStyleHints::colorSchemeChanged, this,
+            &SceneDocumentBinder::invalidateHighlights);
 }
 
 SceneDocumentBinder::~SceneDocumentBinder() { }
@@ -1268,7 +1270,7 @@ void SceneDocumentBinder::setApplyLanguageFonts(bool val)
     m_applyLanguageFonts = val;
     emit applyLanguageFontsChanged();
 
-    this->refresh();
+    this->invalidateHighlights();
 }
 
 QString SceneDocumentBinder::nextTabFormatAsString() const
@@ -1595,6 +1597,137 @@ QFont SceneDocumentBinder::currentFont() const
     return format.font();
 }
 
+namespace {
+
+// Scene paragraphs are put on the clipboard in a compact binary form, under the
+// "scrite/scene" mime-type. Payloads from older versions, which were compact JSON, are
+// still accepted while pasting.
+const quint32 SceneClipboardMagic = 0x53435343; // "SCSC"
+const quint16 SceneClipboardVersion = 1;
+
+struct SceneClipboardParagraph
+{
+    int type = SceneElement::Action;
+    int alignment = 0;
+    QString text;
+    QString sceneNumber; // only for headings
+    QString synopsis;    // only for headings
+    QVector<QTextLayout::FormatRange> formats;
+};
+
+// Format ranges come from the clipboard, which any application can write to. Ranges that
+// don't fall entirely within the paragraph's text are dropped, before paste() positions a
+// cursor with them.
+void dropInvalidFormats(SceneClipboardParagraph &paragraph)
+{
+    const int textLength = paragraph.text.length();
+    for (int i = paragraph.formats.size() - 1; i >= 0; i--) {
+        const QTextLayout::FormatRange &range = paragraph.formats.at(i);
+        if (range.start < 0 || range.length <= 0 || range.start > textLength
+            || range.length > textLength - range.start)
+            paragraph.formats.removeAt(i);
+    }
+}
+
+QVector<SceneClipboardParagraph> readSceneClipboardContent(const QByteArray &content)
+{
+    QVector<SceneClipboardParagraph> ret;
+
+    QDataStream ds(content);
+    ds.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    ds >> magic >> version;
+    if (magic == SceneClipboardMagic && version == SceneClipboardVersion) {
+        while (!ds.atEnd() && ds.status() == QDataStream::Ok) {
+            SceneClipboardParagraph paragraph;
+
+            qint8 type = 0;
+            qint32 alignment = 0;
+            ds >> type >> alignment >> paragraph.text;
+            paragraph.type = type;
+            paragraph.alignment = alignment;
+            if (type == SceneElement::Heading)
+                ds >> paragraph.sceneNumber >> paragraph.synopsis;
+            paragraph.formats = SceneElement::textFormatsFromStream(ds);
+            dropInvalidFormats(paragraph);
+
+            if (ds.status() == QDataStream::Ok)
+                ret.append(paragraph);
+        }
+
+        return ret;
+    }
+
+    const QJsonArray jcontent = QJsonDocument::fromJson(content).array();
+    ret.reserve(jcontent.size());
+    for (const QJsonValue &item : jcontent) {
+        const QJsonObject itemObject = item.toObject();
+
+        SceneClipboardParagraph paragraph;
+        paragraph.type = itemObject.value(QStringLiteral("type")).toInt();
+        paragraph.alignment = itemObject.value(QStringLiteral("alignment")).toInt();
+        paragraph.text = itemObject.value(QStringLiteral("text")).toString();
+        paragraph.sceneNumber = itemObject.value(QStringLiteral("sceneNumber")).toString();
+        paragraph.synopsis = itemObject.value(QStringLiteral("synopsis")).toString();
+        paragraph.formats = SceneElement::textFormatsFromJson(
+                itemObject.value(QStringLiteral("formats")).toArray());
+        dropInvalidFormats(paragraph);
+        ret.append(paragraph);
+    }
+
+    return ret;
+}
+
+// Renders the Fountain flavour of copied content only when some application actually asks
+// for plain text. Pasting within Scrite never needs it.
+class SceneClipboardMimeData : public QMimeData
+{
+public:
+    explicit SceneClipboardMimeData(const Fountain::Body &body) : m_body(body) { }
+
+    // QMimeData interface
+    bool hasFormat(const QString &mimeType) const
+    {
+        return mimeType == textPlainMimeType() || QMimeData::hasFormat(mimeType);
+    }
+
+    QStringList formats() const
+    {
+        QStringList ret = QMimeData::formats();
+        if (!ret.contains(textPlainMimeType()))
+            ret << textPlainMimeType();
+        return ret;
+    }
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QMetaType type) const
+    {
+        if (mimeType == textPlainMimeType()) {
+            if (!m_textGenerated) {
+                m_text = Fountain::Writer(m_body,
+                                          m_body.size() > 1 ? Screenplay::fountainCopyOptions()
+                                                            : Fountain::Writer::NoOption)
+                                 .toString();
+                m_textGenerated = true;
+            }
+            return m_text;
+        }
+
+        return QMimeData::retrieveData(mimeType, type);
+    }
+
+private:
+    static QString textPlainMimeType() { return QStringLiteral("text/plain"); }
+
+    Fountain::Body m_body;
+    mutable QString m_text;
+    mutable bool m_textGenerated = false;
+};
+
+} // namespace
+
 void SceneDocumentBinder::copy(int fromPosition, int toPosition)
 {
     if (this->document() == nullptr)
@@ -1609,33 +1742,32 @@ void SceneDocumentBinder::copy(int fromPosition, int toPosition)
         return toPosition == cursor.position();
     }();
 
-    QJsonArray content;
-
-    auto addParaToContent = [&content](int type, int alignment, const QString &text,
-                                       const QVector<QTextLayout::FormatRange> &formats =
-                                               QVector<QTextLayout::FormatRange>()) {
-        QJsonObject para;
-        para.insert(QStringLiteral("type"), type);
-        if (alignment >= 0)
-            para.insert(QStringLiteral("alignment"), alignment);
-        para.insert(QStringLiteral("text"), text);
-
-        if (!formats.isEmpty()) {
-            const QJsonArray jformats = SceneElement::textFormatsToJson(formats);
-            para.insert(QStringLiteral("formats"), jformats);
-        }
-
-        content.append(para);
+    QByteArray content;
+    QDataStream ds(&content, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_6_0);
+    ds << SceneClipboardMagic << SceneClipboardVersion;
+
+    auto addParaToContent = [&ds](int type, int alignment, const QString &text,
+                                  const QVector<QTextLayout::FormatRange> &formats =
+                                          QVector<QTextLayout::FormatRange>(),
+                                  const QString &sceneNumber = QString(),
+                                  const QString &synopsis = QString()) {
+        ds << qint8(type) << qint32(qMax(alignment, 0)) << text;
+        if (type == SceneElement::Heading)
+            ds << sceneNumber << synopsis;
+        SceneElement::textFormatsToStream(ds, formats);
     };
 
     Fountain::Body fBody;
 
     if (allTextSelected && m_scene->heading()->isEnabled()) {
-        // Copy the scene heading and synopsis to both fountain and JSON representations
+        const QString sceneNumber =
+                m_screenplayElement ? m_screenplayElement->userSceneNumber() : QString();
+
+        // Copy the scene heading and synopsis to both fountain and binary representations
         Fountain::Element fElement;
         fElement.text = m_scene->heading()->displayText();
-        fElement.sceneNumber =
-                m_screenplayElement ? m_screenplayElement->userSceneNumber() : QString();
+        fElement.sceneNumber = sceneNumber;
         fElement.type = Fountain::Element::SceneHeading;
         fBody.append(fElement);
 
@@ -1646,13 +1778,9 @@ void SceneDocumentBinder::copy(int fromPosition, int toPosition)
             fBody.append(fElement);
         }
 
-        addParaToContent(SceneElement::Heading, 0, m_scene->heading()->displayText());
-
-        // Add scene number and synopsis to scene heading itself.
-        QJsonObject headingPara = content.last().toObject();
-        headingPara.insert(QStringLiteral("sceneNumber"), m_screenplayElement->userSceneNumber());
-        headingPara.insert(QStringLiteral("synopsis"), m_scene->synopsis());
-        content[content.size() - 1] = headingPara;
+        // Scene number and synopsis go with the scene heading itself.
+        addParaToContent(SceneElement::Heading, 0, m_scene->heading()->displayText(),
+                         QVector<QTextLayout::FormatRange>(), sceneNumber, m_scene->synopsis());
     }
 
     QTextCursor cursor(this->document());
@@ -1691,11 +1819,11 @@ void SceneDocumentBinder::copy(int fromPosition, int toPosition)
             formatsToCopy.append(fmt);
         }
 
-        addParaToContent(element->type(), element->alignment(), cursor.selectedText(),
-                         formatsToCopy);
+        const QString selectedText = cursor.selectedText();
+        addParaToContent(element->type(), element->alignment(), selectedText, formatsToCopy);
 
         Fountain::Element fElement;
-        fElement.text = cursor.selectedText();
+        fElement.text = selectedText;
         fElement.formats = formatsToCopy;
         switch (element->type()) {
         default:
@@ -1724,15 +1852,9 @@ void SceneDocumentBinder::copy(int fromPosition, int toPosition)
         block = block.next();
     }
 
-    const QByteArray contentJson = QJsonDocument(content).toJson(QJsonDocument::Compact);
-
     QClipboard *clipboard = Application::instance()->clipboard();
-    QMimeData *mimeData = new QMimeData;
-    mimeData->setData(QStringLiteral("scrite/scene"), contentJson);
-    mimeData->setText(Fountain::Writer(fBody,
-                                       fBody.size() > 1 ? Screenplay::fountainCopyOptions()
-                                                        : Fountain::Writer::NoOption)
-                              .toString());
+    QMimeData *mimeData = new SceneClipboardMimeData(fBody);
+    mimeData->setData(QStringLiteral("scrite/scene"), content);
     clipboard->setMimeData(mimeData);
 }
 
@@ -1761,125 +1883,124 @@ int SceneDocumentBinder::paste(int fromPosition)
 
     const QClipboard *clipboard = Application::instance()->clipboard();
     const QMimeData *mimeData = clipboard->mimeData();
+    if (mimeData == nullptr)
+        return -1;
 
-    const QByteArray contentJson = mimeData->data(QStringLiteral("scrite/scene"));
-    if (contentJson.isEmpty()) {
-        if (mimeData->hasText()) {
-            const QString text = mimeData->text();
-            if (text.contains('\n')) {
-                Fountain::Parser parser(text, Screenplay::fountainPasteOptions());
-
-                bool applySceneHeading = fromPosition == 0 && m_scene->isEmpty();
-
-                const Fountain::Body fBody = parser.body();
-                if (fBody.size() == 1 && fBody.first().type == Fountain::Element::Action) {
-                    const QStringList lines = text.split('\n');
-                    for (const QString &line : lines) {
-                        Paragraph paragraph;
-                        paragraph.text = line;
-                        paragraphs.append(paragraph);
-                    }
-                } else {
-                    for (const Fountain::Element &element : fBody) {
-                        Paragraph paragraph;
-                        paragraph.text = element.text;
-                        paragraph.formats = element.formats;
-
-                        bool includeParagraph = true;
-                        switch (element.type) {
-                        case Fountain::Element::SceneHeading:
-                            if (applySceneHeading) {
-                                m_scene->heading()->parseFrom(element.text);
-                                if (!element.sceneNumber.isEmpty()
-                                    && m_screenplayElement != nullptr)
-                                    m_screenplayElement->setUserSceneNumber(element.sceneNumber);
-                                applySceneHeading = false;
-                                includeParagraph = false;
-                            } else {
-                                paragraph.type = SceneElement::Action;
-                                applySceneHeading = false;
-                            }
-                            break;
-                        case Fountain::Element::Action:
-                            paragraph.type = SceneElement::Action;
-                            applySceneHeading = false;
-                            break;
-                        case Fountain::Element::Character:
-                            paragraph.type = SceneElement::Character;
-                            applySceneHeading = false;
-                            break;
-                        case Fountain::Element::Parenthetical:
-                            paragraph.type = SceneElement::Parenthetical;
-                            applySceneHeading = false;
-                            break;
-                        case Fountain::Element::Dialogue:
-                            paragraph.type = SceneElement::Dialogue;
-                            applySceneHeading = false;
-                            break;
-                        case Fountain::Element::Shot:
-                            paragraph.type = SceneElement::Shot;
-                            applySceneHeading = false;
-                            break;
-                        case Fountain::Element::Transition:
-                            paragraph.type = SceneElement::Transition;
+    const QByteArray sceneContent = mimeData->data(QStringLiteral("scrite/scene"));
+    const QVector<SceneClipboardParagraph> content = readSceneClipboardContent(sceneContent);
+    if (sceneContent.isEmpty() ? !mimeData->hasText() : content.isEmpty())
+        return -1;
+
+    // Changes to the heading, synopsis and all pasted paragraphs are undone in one step.
+    auto undoCaptureGuard = qScopeGuard([=]() { m_scene->endUndoCapture(); });
+    m_scene->beginUndoCapture();
+
+    if (sceneContent.isEmpty()) {
+        const QString text = mimeData->text();
+        if (text.contains('\n')) {
+            Fountain::Parser parser(text, Screenplay::fountainPasteOptions());
+
+            bool applySceneHeading = fromPosition == 0 && m_scene->isEmpty();
+
+            const Fountain::Body fBody = parser.body();
+            if (fBody.size() == 1 && fBody.first().type == Fountain::Element::Action) {
+                const QStringList lines = text.split('\n');
+                for (const QString &line : lines) {
+                    Paragraph paragraph;
+                    paragraph.text = line;
+                    paragraphs.append(paragraph);
+                }
+            } else {
+                for (const Fountain::Element &element : fBody) {
+                    Paragraph paragraph;
+                    paragraph.text = element.text;
+                    paragraph.formats = element.formats;
+
+                    bool includeParagraph = true;
+                    switch (element.type) {
+                    case Fountain::Element::SceneHeading:
+                        if (applySceneHeading) {
+                            m_scene->heading()->parseFrom(element.text);
+                            if (!element.sceneNumber.isEmpty() && m_screenplayElement != nullptr)
+                                m_screenplayElement->setUserSceneNumber(element.sceneNumber);
                             applySceneHeading = false;
-                            break;
-                        case Fountain::Element::Synopsis:
                             includeParagraph = false;
-                            if (!element.text.isEmpty()) {
-                                QString synopsis = m_scene->synopsis();
-                                if (!synopsis.isEmpty())
-                                    synopsis += "\n\n";
-                                synopsis += element.text;
-                                m_scene->setSynopsis(element.text);
-                            }
-                            break;
-                        default:
-                            includeParagraph = false;
-                            break;
+                        } else {
+                            paragraph.type = SceneElement::Action;
+                            applySceneHeading = false;
                         }
-
-                        if (includeParagraph)
-                            paragraphs.append(paragraph);
+                        break;
+                    case Fountain::Element::Action:
+                        paragraph.type = SceneElement::Action;
+                        applySceneHeading = false;
+                        break;
+                    case Fountain::Element::Character:
+                        paragraph.type = SceneElement::Character;
+                        applySceneHeading = false;
+                        break;
+                    case Fountain::Element::Parenthetical:
+                        paragraph.type = SceneElement::Parenthetical;
+                        applySceneHeading = false;
+                        break;
+                    case Fountain::Element::Dialogue:
+                        paragraph.type = SceneElement::Dialogue;
+                        applySceneHeading = false;
+                        break;
+                    case Fountain::Element::Shot:
+                        paragraph.type = SceneElement::Shot;
+                        applySceneHeading = false;
+                        break;
+                    case Fountain::Element::Transition:
+                        paragraph.type = SceneElement::Transition;
+                        applySceneHeading = false;
+                        break;
+                    case Fountain::Element::Synopsis:
+                        includeParagraph = false;
+                        if (!element.text.isEmpty()) {
+                            QString synopsis = m_scene->synopsis();
+                            if (!synopsis.isEmpty())
+                                synopsis += "\n\n";
+                            synopsis += element.text;
+                            m_scene->setSynopsis(element.text);
+                        }
+                        break;
+                    default:
+                        includeParagraph = false;
+                        break;
                     }
+
+                    if (includeParagraph)
+                        paragraphs.append(paragraph);
                 }
-            } else {
-                Paragraph paragraph;
-                paragraph.text = text;
-                paragraphs.append(paragraph);
             }
+        } else {
+            Paragraph paragraph;
+            paragraph.text = text;
+            paragraphs.append(paragraph);
         }
     } else {
-        const QJsonArray content = QJsonDocument::fromJson(contentJson).array();
-        if (content.isEmpty())
-            return -1;
-
         bool applySceneHeading = fromPosition == 0 && m_scene->isEmpty();
 
-        for (const QJsonValue &item : content) {
-            const QJsonObject itemObject = item.toObject();
-            const int type = itemObject.value(QStringLiteral("type")).toInt();
-            const int alignment = itemObject.value(QStringLiteral("alignment")).toInt();
-            const QString text = itemObject.value(QStringLiteral("text")).toString();
-
-            if (applySceneHeading && type == SceneElement::Heading) {
-                m_scene->heading()->parseFrom(text);
-                m_screenplayElement->setUserSceneNumber(
-                        itemObject.value(QStringLiteral("sceneNumber")).toString());
-                m_scene->setSynopsis(itemObject.value(QStringLiteral("synopsis")).toString());
+        paragraphs.reserve(content.size());
+        for (const SceneClipboardParagraph &item : content) {
+            if (applySceneHeading && item.type == SceneElement::Heading) {
+                m_scene->heading()->parseFrom(item.text);
+                if (m_screenplayElement != nullptr)
+                    m_screenplayElement->setUserSceneNumber(item.sceneNumber);
+                m_scene->setSynopsis(item.synopsis);
                 applySceneHeading = false;
                 continue;
             }
 
             Paragraph paragraph;
-            paragraph.type = (type < SceneElement::Min || type > SceneElement::Max
-                              || type == SceneElement::Heading)
+            paragraph.type = (item.type < SceneElement::Min || item.type > SceneElement::Max
+                              || item.type == SceneElement::Heading)
                     ? SceneElement::Action
-                    : SceneElement::Type(type);
-            paragraph.text = text;
-            paragraph.alignment = alignment == 0 ? Qt::Alignment() : Qt::Alignment(alignment);
-            paragraph.formats = SceneElement::textFormatsFromJson(
-                    itemObject.value(QStringLiteral("formats")).toArray());
+                    : SceneElement::Type(item.type);
+            paragraph.text = item.text;
+            paragraph.alignment =
+                    item.alignment == 0 ? Qt::Alignment() : Qt::Alignment(item.alignment);
+            paragraph.formats = item.formats;
             paragraphs.append(paragraph);
 
             applySceneHeading = false;
@@ -1892,10 +2013,14 @@ int SceneDocumentBinder::paste(int fromPosition)
     cursor.setPosition(fromPosition);
 
     const bool pasteFormatting = paragraphs.size() > 1;
-    QTextBlock lastPastedBlock;
+    const int firstBlockNumber = cursor.blockNumber();
 
+    // All paragraphs are inserted in one edit block, so that the document reports one
+    // contents change and scene elements for the new blocks are created in a single sync,
+    // instead of once for every pasted paragraph.
+    cursor.beginEditBlock();
     for (int i = 0; i < paragraphs.size(); i++) {
-        const Paragraph paragraph = paragraphs.at(i);
+        const Paragraph &paragraph = paragraphs.at(i);
         if (i > 0)
             cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
 
@@ -1904,7 +2029,6 @@ int SceneDocumentBinder::paste(int fromPosition)
         const int pasteEnd = cursor.position();
 
         if (!paragraph.formats.isEmpty()) {
-            cursor.setPosition(pasteStart);
             for (const QTextLayout::FormatRange &format : paragraph.formats) {
                 cursor.setPosition(pasteStart + format.start);
                 cursor.setPosition(pasteStart + format.start + format.length,
@@ -1912,33 +2036,48 @@ int SceneDocumentBinder::paste(int fromPosition)
                 cursor.setCharFormat(format.format);
                 cursor.clearSelection();
             }
+            cursor.setPosition(pasteEnd);
         }
+    }
+    cursor.endEditBlock();
 
-        cursor.movePosition(QTextCursor::StartOfBlock);
+    const int pasteEndPosition = cursor.position();
 
-        lastPastedBlock = cursor.block();
-        SceneDocumentBlockUserData *userData = SceneDocumentBlockUserData::get(lastPastedBlock);
-        if (userData && userData->sceneElement())
-            userData->sceneElement()->setText(lastPastedBlock.text());
+    QList<QTextBlock> blocksToRehighlight;
+    if (pasteFormatting)
+        blocksToRehighlight.reserve(paragraphs.size());
 
-        if (userData && pasteFormatting) {
-            if (userData->sceneElement()) {
-                userData->sceneElement()->setType(paragraph.type);
-                userData->sceneElement()->setAlignment(paragraph.alignment);
-                userData->sceneElement()->dropAllChanges();
+    cursor.beginEditBlock();
+    for (int i = 0; i < paragraphs.size(); i++) {
+        const Paragraph &paragraph = paragraphs.at(i);
 
-                const SceneElementFormat *format =
-                        m_screenplayFormat->elementFormat(paragraph.type);
-                userData->blockFormat = format->createBlockFormat(paragraph.alignment);
-                userData->charFormat = format->createCharFormat();
-                cursor.setBlockFormat(userData->blockFormat);
+        const QTextBlock block = this->document()->findBlockByNumber(firstBlockNumber + i);
+        SceneDocumentBlockUserData *userData = SceneDocumentBlockUserData::get(block);
+        if (userData == nullptr || userData->sceneElement() == nullptr)
+            continue;
 
-                this->rehighlightBlock(lastPastedBlock);
-            }
-        }
+        userData->sceneElement()->setText(block.text());
+        if (!pasteFormatting)
+            continue;
 
-        cursor.setPosition(pasteEnd);
+        userData->sceneElement()->setType(paragraph.type);
+        userData->sceneElement()->setAlignment(paragraph.alignment);
+        userData->sceneElement()->dropAllChanges();
+
+        const SceneElementFormat *format = m_screenplayFormat->elementFormat(paragraph.type);
+        userData->blockFormat = format->createBlockFormat(paragraph.alignment);
+        userData->charFormat = format->createCharFormat();
+        cursor.setPosition(block.position());
+        cursor.setBlockFormat(userData->blockFormat);
+
+        blocksToRehighlight.append(block);
     }
+    cursor.endEditBlock();
+
+    for (const QTextBlock &block : std::as_const(blocksToRehighlight))
+        this->rehighlightBlock(block);
+
+    cursor.setPosition(pasteEndPosition);
 
     m_sceneElementTaskTimer.stop();
     this->performAllSceneElementTasks();
@@ -1996,18 +2135,58 @@ void SceneDocumentBinder::highlightBlock(const QString &text)
         return;
     }
 
-    auto colorTransformBrush = [](const QBrush &brush) -> QBrush {
-        QBrush ret = brush;
-        ret.setColor(Utils::Color::transform(brush.color()));
-        return ret;
-    };
-
     // Basic formatting
     const SceneElementFormat *format = m_screenplayFormat->elementFormat(element->type());
     if (userData->updateFromFormat(format))
         this->applyBlockFormatLater(block);
 
-    this->mergeFormat(0, block.length(), userData->charFormat);
+    // Reuse formats computed earlier for this block, unless something they depend on changed.
+    SceneDocumentBlockUserData::HighlightCache &cache = userData->highlightCache;
+    const int spellCheckMTime =
+            userData->m_spellCheck.isNull() ? -1 : userData->m_spellCheck->modificationTime();
+    const QVector<QTextLayout::FormatRange> textFormats = block.textFormats();
+    if (cache.highlightRevision != m_highlightRevision || cache.elementFormat != format
+        || cache.elementFormatMTime != userData->m_formatMTime
+        || cache.spellCheckMTime != spellCheckMTime || cache.text != text
+        || cache.textFormats != textFormats) {
+        cache.formats =
+                this->evaluateHighlightFormats(block, text, userData, &cache.hasSpellingMistakes);
+        cache.text = text;
+        cache.textFormats = textFormats;
+        cache.elementFormat = format;
+        cache.elementFormatMTime = userData->m_formatMTime;
+        cache.spellCheckMTime = spellCheckMTime;
+        cache.highlightRevision = m_highlightRevision;
+    }
+
+    for (const QTextLayout::FormatRange &range : std::as_const(cache.formats))
+        this->setFormat(range.start, range.length, range.format);
+
+    if (m_applyLanguageFonts && m_currentElement == element)
+        emit currentFontChanged();
+
+    if (cache.hasSpellingMistakes)
+        emit spellingMistakesDetected();
+}
+
+QVector<QTextLayout::FormatRange>
+SceneDocumentBinder::evaluateHighlightFormats(const QTextBlock &block, const QString &text,
+                                              SceneDocumentBlockUserData *userData,
+                                              bool *hasSpellingMistakes) const
+{
+    // Formats are merged per character first, and then collapsed into as few ranges as
+    // possible, so that the highlighter is handed one range for each run of equal formats.
+    const int length = text.length();
+    QVector<QTextCharFormat> charFormats(length);
+    auto mergeFormat = [&charFormats, length](int start, int count,
+                                              const QTextCharFormat &format) {
+        const int end = qMin(start + count, length);
+        for (int i = qMax(start, 0); i < end; i++)
+            charFormats[i].merge(format);
+    };
+
+    // Basic formatting
+    mergeFormat(0, length, userData->charFormat);
 
     // Per-language fonts.
     if (m_applyLanguageFonts) {
@@ -2019,18 +2198,21 @@ void SceneDocumentBinder::highlightBlock(const QString &text)
 
             QTextCharFormat format;
             format.setFontFamilies({ boundary.fontFamily() });
-            this->mergeFormat(boundary.start, boundary.end - boundary.start + 1, format);
+            mergeFormat(boundary.start, boundary.end - boundary.start + 1, format);
         }
-
-        if (m_currentElement == element)
-            emit currentFontChanged();
     }
 
     // Spelling mistakes.
     const QList<TextFragment> fragments = userData->misspelledFragments();
-    const QColor spellingBackgroundColor = Utils::Color::transform(QColor(255, 0, 0, 64));
-    const QColor spellingTextColor = Utils::Color::textColorFor(spellingBackgroundColor);
+    *hasSpellingMistakes = !fragments.isEmpty();
     if (!fragments.isEmpty()) {
+        const QColor spellingBackgroundColor = Utils::Color::transform(QColor(255, 0, 0, 64));
+        const QColor spellingTextColor = Utils::Color::textColorFor(spellingBackgroundColor);
+
+        QTextCharFormat spellingErrorFormat;
+        spellingErrorFormat.setForeground(spellingTextColor);
+        spellingErrorFormat.setBackground(spellingBackgroundColor);
+
         for (const TextFragment &fragment : fragments) {
             if (!fragment.isValid())
                 continue;
@@ -2040,13 +2222,8 @@ void SceneDocumentBinder::highlightBlock(const QString &text)
             if (script != QChar::Script_Latin)
                 continue;
 
-            QTextCharFormat spellingErrorFormat;
-            spellingErrorFormat.setForeground(spellingTextColor);
-            spellingErrorFormat.setBackground(spellingBackgroundColor);
-            this->mergeFormat(fragment.start(), fragment.length(), spellingErrorFormat);
+            mergeFormat(fragment.start(), fragment.length(), spellingErrorFormat);
         }
-
-        emit spellingMistakesDetected();
     }
 
     /*
@@ -2062,31 +2239,54 @@ void SceneDocumentBinder::highlightBlock(const QString &text)
 
           Until we figure out why this is happening, we reapply background and
           foreground colors whenever spelling mistakes are detected.
+
+    Links should appear in blue text and underline format. Both are taken care
+    of in a single pass over the block's own text formats.
           */
 
     const QVector<QTextLayout::FormatRange> formats = block.textFormats();
     for (const QTextLayout::FormatRange &format : formats) {
-        if (format.format.hasProperty(QTextFormat::BackgroundBrush)
-            || format.format.hasProperty(QTextFormat::ForegroundBrush)) {
-            QTextCharFormat charFormat;
-            if (format.format.hasProperty(QTextFormat::BackgroundBrush))
-                charFormat.setBackground(colorTransformBrush(format.format.background()));
-            if (format.format.hasProperty(QTextFormat::ForegroundBrush))
-                charFormat.setForeground(colorTransformBrush(format.format.foreground()));
-            this->mergeFormat(format.start, format.length, charFormat);
+        QTextCharFormat charFormat;
+        if (format.format.hasProperty(QTextFormat::BackgroundBrush))
+            charFormat.setBackground(
+                    SceneDocumentBlockUserData::colorTransformBrush(format.format.background()));
+        if (format.format.hasProperty(QTextFormat::ForegroundBrush))
+            charFormat.setForeground(
+                    SceneDocumentBlockUserData::colorTransformBrush(format.format.foreground()));
+        if (format.format.isAnchor() && !format.format.anchorHref().isEmpty()) {
+            charFormat.setForeground(Utils::Color::transform(Qt::blue));
+            charFormat.setFontUnderline(true);
         }
+        if (!charFormat.isEmpty())
+            mergeFormat(format.start, format.length, charFormat);
     }
 
-    // Links should appear in blue text and underline format.
-    // const QVector<QTextLayout::FormatRange> formats = block.textFormats();
-    for (const QTextLayout::FormatRange &format : formats) {
-        if (format.format.isAnchor() && !format.format.anchorHref().isEmpty()) {
-            QTextCharFormat linkFormat;
-            linkFormat.setForeground(Utils::Color::transform(Qt::blue));
-            linkFormat.setFontUnderline(true);
-            this->mergeFormat(format.start, format.length, linkFormat);
+    QVector<QTextLayout::FormatRange> ret;
+    for (int i = 0; i < length; i++) {
+        if (charFormats.at(i).isEmpty())
+            continue;
+
+        if (!ret.isEmpty() && ret.last().start + ret.last().length == i
+            && ret.last().format == charFormats.at(i)) {
+            ++ret.last().length;
+            continue;
         }
+
+        QTextLayout::FormatRange range;
+        range.start = i;
+        range.length = 1;
+        range.format = charFormats.at(i);
+        ret.append(range);
     }
+
+    return ret;
+}
+
+void SceneDocumentBinder::invalidateHighlights()
+{
+    // Things that affect every block's highlighting, but aren't tracked per block.
+    ++m_highlightRevision;
+    this->refresh();
 }
 
 void SceneDocumentBinder::timerEvent(QTimerEvent *te)
@@ -2141,15 +2341,6 @@ bool SceneDocumentBinder::eventFilter(QObject *watched, QEvent *event)
     return false;
 }
 
-void SceneDocumentBinder::mergeFormat(int start, int count, const QTextCharFormat &format)
-{
-    for (int i = start; i < start + count; i++) {
-        QTextCharFormat mergedFormat = this->format(i);
-        mergedFormat.merge(format);
-        this->setFormat(i, 1, mergedFormat);
-    }
-}
-
 void SceneDocumentBinder::resetScene()
 {
     m_scene = nullptr;
@@ -2674,7 +2865,9 @@ void SceneDocumentBinder::syncSceneFromDocument(int nrBlocks)
     // elementsToRemove > 0 means the document now has fewer blocks than the scene has elements:
     // paragraphs were deleted (selection-delete, cut, or paragraph-merge via Backspace/Delete).
     const int elementsToRemove = m_scene->elementCount() - nrBlocks;
-    const bool needsUndoCapture = newBlockCount > 1 || anyNewBlockHasText || elementsToRemove > 0;
+    // When a caller (e.g. paste) has already begun a capture, it also gets to end it.
+    const bool needsUndoCapture = (newBlockCount > 1 || anyNewBlockHasText || elementsToRemove > 0)
+            && !m_scene->inUndoCapture();
 
     if (needsUndoCapture)
         m_scene->beginUndoCapture();
@@ -24,6 +24,7 @@
 #include <QSyntaxHighlighter>
 #include <QQuickTextDocument>
 #include <QTextCharFormat>
+#include <QTextLayout>
 
 class ScreenplayFormat;
 class SpellCheckService;
@@ -643,7 +644,11 @@ protected:
     bool eventFilter(QObject *watched, QEvent *event);
 
     // Helpers
-    void mergeFormat(int start, int count, const QTextCharFormat &format);
+    QVector<QTextLayout::FormatRange> evaluateHighlightFormats(const QTextBlock &block,
+                                                               const QString &text,
+                                                               SceneDocumentBlockUserData *userData,
+                                                               bool *hasSpellingMistakes) const;
+    void invalidateHighlights();
 
 private:
     void resetScene();
@@ -698,6 +703,7 @@ private:
     int m_currentElementCursorPosition = -1;
     int m_cursorPosition = -1;
     int m_documentLoadCount = 0;
+    int m_highlightRevision = 0;
     int m_selectionEndPosition = -1;
     int m_selectionStartPosition = -1;
 
@@ -20,6 +20,7 @@
 #include <QBrush>
 #include <QPointer>
 #include <QTextBlock>
+#include <QTextLayout>
 #include <QTextBlockFormat>
 #include <QTextCharFormat>
 #include <QTextBlockUserData>
@@ -44,6 +45,21 @@ public:
     QTextBlockFormat blockFormat;
     QTextCharFormat charFormat;
 
+    // Formats computed by the last SceneDocumentBinder::highlightBlock() on this block, along
+    // with everything they were computed from. They are reused until any of that changes.
+    struct HighlightCache
+    {
+        QString text;
+        QVector<QTextLayout::FormatRange> textFormats;
+        const SceneElementFormat *elementFormat = nullptr;
+        int elementFormatMTime = -1;
+        int spellCheckMTime = -1;
+        int highlightRevision = -1;
+        bool hasSpellingMistakes = false;
+        QVector<QTextLayout::FormatRange> formats;
+    };
+    HighlightCache highlightCache;
+
     bool isValid() const;
 
     SceneElement *sceneElement() const { return m_sceneElement; }
@@ -20,6 +20,7 @@
 #include "hourglass.h"
 #include "screenplay.h"
 #include "application.h"
+#include "searchengine.h"
 #include "scritedocument.h"
 #include "garbagecollector.h"
 
@@ -28,6 +29,7 @@
 #include <QClipboard>
 #include <QJsonDocument>
 #include <QScopedValueRollback>
+#include <QtConcurrentMap>
 
 ScreenplayElement::ScreenplayElement(QObject *parent)
     : QObject(parent), m_scene(this, "scene"), m_screenplay(this, "screenplay")
@@ -151,25 +153,15 @@ void ScreenplayElement::setScreenplay(Screenplay *val)
     if (m_screenplay != nullptr || m_screenplay == val)
         return;
 
-    if (m_screenplay != nullptr) {
-        disconnect(this, &ScreenplayElement::wordCountChanged, m_screenplay,
-                   &Screenplay::evaluateWordCountLater);
-
-        if (m_scene != nullptr)
-            disconnect(m_scene, &Scene::aboutToRemoveScene, m_screenplay,
-                       &Screenplay::removeSceneElements);
-    }
+    if (m_screenplay != nullptr && m_scene != nullptr)
+        disconnect(m_scene, &Scene::aboutToRemoveScene, m_screenplay,
+                   &Screenplay::removeSceneElements);
 
     m_screenplay = val;
 
-    if (m_screenplay != nullptr) {
-        connect(this, &ScreenplayElement::wordCountChanged, m_screenplay,
-                &Screenplay::evaluateWordCountLater, Qt::UniqueConnection);
-
-        if (m_scene != nullptr)
-            connect(m_scene, &Scene::aboutToRemoveScene, m_screenplay,
-                    &Screenplay::removeSceneElements);
-    }
+    if (m_screenplay != nullptr && m_scene != nullptr)
+        connect(m_scene, &Scene::aboutToRemoveScene, m_screenplay,
+                &Screenplay::removeSceneElements);
 
     emit screenplayChanged();
 }
@@ -259,6 +251,8 @@ void ScreenplayElement::setScene(Scene *val)
     connect(m_scene, &Scene::tagsChanged, this, &ScreenplayElement::onSceneTagsChanged);
     connect(m_scene, &Scene::groupsChanged, this, &ScreenplayElement::onSceneGroupsChanged);
     connect(m_scene, &Scene::wordCountChanged, this, &ScreenplayElement::wordCountChanged);
+    connect(m_scene, &Scene::dialogueCountChanged, this,
+            &ScreenplayElement::sceneDialogueCountChanged);
     connect(m_scene, &Scene::elementCountChanged, this, &ScreenplayElement::sceneContentChanged);
     connect(m_scene, &Scene::sceneElementChanged, this, &ScreenplayElement::sceneElementChanged);
 
@@ -506,11 +500,6 @@ void ScreenplayElement::resetScene()
 
 void ScreenplayElement::resetScreenplay()
 {
-    if (m_screenplay != nullptr) {
-        disconnect(this, &ScreenplayElement::wordCountChanged, m_screenplay,
-                   &Screenplay::evaluateWordCountLater);
-        m_screenplay->evaluateWordCountLater();
-    }
     m_screenplay = nullptr;
     emit screenplayChanged();
 
@@ -567,18 +556,31 @@ Screenplay::Screenplay(QObject *parent)
     connect(this, &Screenplay::emptyChanged, this, &Screenplay::screenplayChanged);
     connect(this, &Screenplay::coverPagePhotoChanged, this, &Screenplay::screenplayChanged);
     connect(this, &Screenplay::elementsChanged, this, &Screenplay::evaluateSceneNumbersLater);
-    connect(this, &Screenplay::elementsChanged, this, &Screenplay::evaluateParagraphCountsLater);
     connect(this, &Screenplay::elementsChanged, this,
             &Screenplay::evaluateIfHeightHintsAreAvailableLater);
     connect(this, &Screenplay::coverPagePhotoSizeChanged, this, &Screenplay::screenplayChanged);
     connect(this, &Screenplay::titlePageIsCenteredChanged, this, &Screenplay::screenplayChanged);
     connect(this, &Screenplay::screenplayChanged, [=]() {
         this->evaluateHasTitlePageAttributes();
-        this->evaluateParagraphCountsLater();
-        this->evaluateWordCountLater();
         this->markAsModified();
     });
 
+    // Word, paragraph and dialogue counts are updated by deltas from elements whose
+    // scenes changed. We only need to count everything again if the model is reset.
+    connect(this, &Screenplay::rowsInserted, this,
+            [=](const QModelIndex &, int first, int last) {
+                for (int i = first; i <= last; i++)
+                    m_dirtyElementCounts.insert(m_elements.at(i));
+                this->evaluateCountsLater();
+            });
+    connect(this, &Screenplay::rowsAboutToBeRemoved, this,
+            [=](const QModelIndex &, int first, int last) {
+                for (int i = first; i <= last; i++)
+                    this->removeElementCounts(m_elements.at(i));
+                this->evaluateCountsLater();
+            });
+    connect(this, &Screenplay::modelReset, this, &Screenplay::resetElementCounts);
+
     m_version = QStringLiteral("Initial Draft");
 
     QSettings *settings = Application::instance()->settings();
@@ -603,6 +605,7 @@ Screenplay::Screenplay(QObject *parent)
     if (m_scriteDocument != nullptr) {
         DocumentFileSystem *dfs = m_scriteDocument->fileSystem();
         connect(dfs, &DocumentFileSystem::auction, this, &Screenplay::onDfsAuction);
+        dfs->setClaims(this, QStringList({ standardCoverPathPhotoPath() }));
     }
 
     QClipboard *clipboard = qApp->clipboard();
@@ -793,6 +796,7 @@ void Screenplay::setCoverPagePhoto(const QString &val)
 
     DocumentFileSystem *dfs = m_scriteDocument->fileSystem();
     connect(dfs, &DocumentFileSystem::auction, this, &Screenplay::onDfsAuction);
+    dfs->setClaims(this, QStringList({ standardCoverPathPhotoPath() }));
 
     const QSize fullHdSize(1920, 1080);
     const QString val2 = dfs->addImage(val, standardCoverPathPhotoPath(), fullHdSize);
@@ -2226,18 +2230,25 @@ QList<int> Screenplay::sceneElementsInBreak(ScreenplayElement *element) const
 
 int Screenplay::dialogueCount() const
 {
-    int ret = 0;
-    for (const ScreenplayElement *element : std::as_const(m_elements)) {
-        const Scene *scene = element->scene();
-        if (scene == nullptr)
-            continue;
+    this->evaluatePendingCounts();
+    return m_dialogueCount;
+}
 
-        const int nrParas = scene->elementCount();
-        for (int i = 0; i < nrParas; i++)
-            ret += scene->elementAt(i)->type() == SceneElement::Character ? 1 : 0;
-    }
+int Screenplay::characterDialogueCount(const QString &characterName) const
+{
+    this->evaluatePendingCounts();
+    return m_characterDialogueCounts.value(characterName.toUpper());
+}
 
-    return ret;
+void Screenplay::evaluatePendingCounts() const
+{
+    // Counts are evaluated after a short delay, but callers like reports need them to be
+    // current right away.
+    if (m_resetElementCounts || !m_dirtyElementCounts.isEmpty()) {
+        Screenplay *ncThis = const_cast<Screenplay *>(this);
+        ncThis->m_countsEvaluationTimer.stop();
+        ncThis->evaluateCounts();
+    }
 }
 
 QList<ScreenplayElement *>
@@ -2398,6 +2409,14 @@ void Screenplay::connectToScreenplayElementSignals(ScreenplayElement *ptr)
             Qt::UniqueConnection);
     connect(ptr, &ScreenplayElement::sceneContentChanged, this, &Screenplay::onSceneContentChanged,
             Qt::UniqueConnection);
+    connect(ptr, &ScreenplayElement::sceneContentChanged, this,
+            &Screenplay::onElementCountsChanged, Qt::UniqueConnection);
+    connect(ptr, &ScreenplayElement::sceneElementChanged, this,
+            &Screenplay::onElementCountsChanged, Qt::UniqueConnection);
+    connect(ptr, &ScreenplayElement::sceneDialogueCountChanged, this,
+            &Screenplay::onElementCountsChanged, Qt::UniqueConnection);
+    connect(ptr, &ScreenplayElement::wordCountChanged, this, &Screenplay::onElementCountsChanged,
+            Qt::UniqueConnection);
     connect(ptr, &ScreenplayElement::sceneHeadingChanged, this, &Screenplay::onSceneHeadingChanged,
             Qt::UniqueConnection);
     connect(ptr, &ScreenplayElement::sceneElementChanged, this, &Screenplay::onSceneElementChanged,
@@ -2438,6 +2457,14 @@ void Screenplay::disconnectFromScreenplayElementSignals(ScreenplayElement *ptr)
     disconnect(ptr, &ScreenplayElement::sceneReset, this, &Screenplay::onSceneReset);
     disconnect(ptr, &ScreenplayElement::sceneContentChanged, this,
                &Screenplay::onSceneContentChanged);
+    disconnect(ptr, &ScreenplayElement::sceneContentChanged, this,
+               &Screenplay::onElementCountsChanged);
+    disconnect(ptr, &ScreenplayElement::sceneElementChanged, this,
+               &Screenplay::onElementCountsChanged);
+    disconnect(ptr, &ScreenplayElement::sceneDialogueCountChanged, this,
+               &Screenplay::onElementCountsChanged);
+    disconnect(ptr, &ScreenplayElement::wordCountChanged, this,
+               &Screenplay::onElementCountsChanged);
     disconnect(ptr, &ScreenplayElement::sceneHeadingChanged, this,
                &Screenplay::onSceneHeadingChanged);
     disconnect(ptr, &ScreenplayElement::sceneElementChanged, this,
@@ -2471,24 +2498,135 @@ void Screenplay::setWordCount(int val)
     emit wordCountChanged();
 }
 
-void Screenplay::evaluateWordCount()
+void Screenplay::onElementCountsChanged()
 {
-    int wordCount = 0;
+    ScreenplayElement *element = qobject_cast<ScreenplayElement *>(this->sender());
+    if (element == nullptr)
+        return;
 
-    for (const ScreenplayElement *element : std::as_const(m_elements)) {
-        if (element->elementType() == ScreenplayElement::SceneElementType) {
-            const Scene *scene = element->scene();
-            if (scene)
-                wordCount += scene->wordCount();
-        }
+    m_dirtyElementCounts.insert(element);
+    this->evaluateCountsLater();
+}
+
+void Screenplay::updateElementCounts(const ScreenplayElement *element)
+{
+    ElementCounts counts;
+
+    const Scene *scene = element->elementType() == ScreenplayElement::SceneElementType
+            ? element->scene()
+            : nullptr;
+    if (scene != nullptr) {
+        // Reading the dialogue count first brings the word count of the scene up to date.
+        counts.hasScene = true;
+        counts.dialogueCount = scene->dialogueCount();
+        counts.wordCount = scene->wordCount();
+        counts.paragraphCount = scene->elementCount();
+
+        const QStringList characterNames = scene->characterNames();
+        for (const QString &characterName : characterNames)
+            counts.characterDialogueCounts[characterName] =
+                    scene->characterPresence(characterName);
+    }
+
+    auto it = m_elementCounts.find(element);
+    if (it != m_elementCounts.end()) {
+        this->applyElementCounts(it.value(), -1);
+        it.value() = counts;
+    } else
+        m_elementCounts.insert(element, counts);
+
+    this->applyElementCounts(counts, 1);
+}
+
+void Screenplay::removeElementCounts(const ScreenplayElement *element)
+{
+    m_dirtyElementCounts.remove(element);
+
+    auto it = m_elementCounts.find(element);
+    if (it == m_elementCounts.end())
+        return;
+
+    this->applyElementCounts(it.value(), -1);
+    m_elementCounts.erase(it);
+}
+
+void Screenplay::applyElementCounts(const ElementCounts &counts, int sign)
+{
+    if (!counts.hasScene)
+        return;
+
+    m_totalWordCount += sign * counts.wordCount;
+    m_totalParagraphCount += sign * counts.paragraphCount;
+    m_dialogueCount += sign * counts.dialogueCount;
+
+    int &nrScenes = m_paragraphCountHistogram[counts.paragraphCount];
+    nrScenes += sign;
+    if (nrScenes <= 0)
+        m_paragraphCountHistogram.remove(counts.paragraphCount);
+
+    auto it = counts.characterDialogueCounts.constBegin();
+    auto end = counts.characterDialogueCounts.constEnd();
+    while (it != end) {
+        int &count = m_characterDialogueCounts[it.key()];
+        count += sign * it.value();
+        if (count <= 0)
+            m_characterDialogueCounts.remove(it.key());
+        ++it;
+    }
+}
+
+void Screenplay::resetElementCounts()
+{
+    m_resetElementCounts = true;
+    this->evaluateCountsLater();
+}
+
+void Screenplay::evaluateCounts()
+{
+    if (m_resetElementCounts) {
+        m_resetElementCounts = false;
+        m_elementCounts.clear();
+        m_characterDialogueCounts.clear();
+        m_paragraphCountHistogram.clear();
+        m_totalWordCount = 0;
+        m_totalParagraphCount = 0;
+        m_dialogueCount = 0;
+
+        m_dirtyElementCounts.clear();
+        for (const ScreenplayElement *element : std::as_const(m_elements))
+            m_dirtyElementCounts.insert(element);
+    }
+
+    const QSet<const ScreenplayElement *> dirtyElements = m_dirtyElementCounts;
+    m_dirtyElementCounts.clear();
+    for (const ScreenplayElement *element : dirtyElements)
+        this->updateElementCounts(element);
+
+    this->setWordCount(m_totalWordCount);
+
+    int min = -1, max = -1, avg = 0;
+    if (!m_paragraphCountHistogram.isEmpty()) {
+        int nrScenes = 0;
+        for (int count : std::as_const(m_paragraphCountHistogram))
+            nrScenes += count;
+
+        min = m_paragraphCountHistogram.firstKey();
+        max = m_paragraphCountHistogram.lastKey();
+        avg = qRound(qreal(m_totalParagraphCount) / qreal(nrScenes));
     }
 
-    this->setWordCount(wordCount);
+    if (m_minimumParagraphCount != min || m_maximumParagraphCount != max
+        || m_averageParagraphCount != avg) {
+        m_minimumParagraphCount = min;
+        m_maximumParagraphCount = max;
+        m_averageParagraphCount = avg;
+        emit paragraphCountChanged();
+    }
 }
 
-void Screenplay::evaluateWordCountLater()
+void Screenplay::evaluateCountsLater()
 {
-    m_wordCountTimer.start(100, this);
+    m_countsEvaluationTimer.start(100, this);
 }
 
 bool Screenplay::getPasteDataFromClipboard(QJsonObject &clipboardJson) const
@@ -2642,11 +2780,26 @@ void Screenplay::setActiveScene(Scene *val)
     this->setCurrentElementIndex(index);
 }
 
-QJsonArray Screenplay::search(const QString &text, int flags) const
+QList<int> Screenplay::search(const QString &text, int flags) const
 {
+    QList<int> ret;
+    if (text.isEmpty())
+        return ret;
+
+    // Search agents in QML need matches right away, so the UI thread waits for them to be
+    // counted. Users must at least see that something is going on.
     HourGlass hourGlass;
 
-    QJsonArray ret;
+    // Paragraph texts are collected here, because scenes cannot be accessed from other
+    // threads. This is cheap, since QString is implicitly shared.
+    struct SceneTexts
+    {
+        int sceneIndex = -1;
+        QStringList paragraphs;
+    };
+
+    QList<SceneTexts> scenes;
+    scenes.reserve(m_elements.size());
 
     const int nrScenes = m_elements.size();
     for (int i = 0; i < nrScenes; i++) {
@@ -2659,30 +2812,31 @@ QJsonArray Screenplay::search(const QString &text, int flags) const
         if (scene == nullptr)
             continue;
 
-        int sceneResultIndex = 0;
+        SceneTexts sceneTexts;
+        sceneTexts.sceneIndex = i;
 
         const int nrElements = scene->elementCount();
-        for (int j = 0; j < nrElements; j++) {
-            SceneElement *element = scene->elementAt(j);
+        sceneTexts.paragraphs.reserve(nrElements);
+        for (int j = 0; j < nrElements; j++)
+            sceneTexts.paragraphs.append(scene->elementAt(j)->text());
 
-            const QJsonArray results = element->find(text, flags);
-            if (!results.isEmpty()) {
-                for (int r = 0; r < results.size(); r++) {
-                    const QJsonObject result = results.at(r).toObject();
-
-                    QJsonObject item;
-                    item.insert(QStringLiteral("sceneIndex"), i);
-                    item.insert(QStringLiteral("elementIndex"), j);
-                    item.insert(QStringLiteral("sceneResultIndex"), sceneResultIndex++);
-
-                    const QString _from = QStringLiteral("from");
-                    const QString _to = QStringLiteral("to");
-                    item.insert(_from, result.value(_from));
-                    item.insert(_to, result.value(_to));
-                    ret.append(item);
-                }
-            }
-        }
+        scenes.append(sceneTexts);
+    }
+
+    // Count matches across scenes in parallel. Only counts are needed here, exact
+    // locations of matches within a scene are looked up by the scene editor.
+    auto countMatches = [text, flags](const SceneTexts &sceneTexts) {
+        int count = 0;
+        for (const QString &paragraph : sceneTexts.paragraphs)
+            count += SearchEngine::matchRanges(text, paragraph, flags).size();
+        return count;
+    };
+    const QList<int> counts = QtConcurrent::blockingMapped<QList<int>>(scenes, countMatches);
+
+    for (int i = 0; i < scenes.size(); i++) {
+        const int count = counts.at(i);
+        for (int c = 0; c < count; c++)
+            ret.append(scenes.at(i).sceneIndex);
     }
 
     return ret;
@@ -2705,7 +2859,8 @@ int Screenplay::replace(const QString &text, const QString &replacementText, int
         const int nrElements = scene->elementCount();
         for (int j = 0; j < nrElements; j++) {
             SceneElement *element = scene->elementAt(j);
-            const QJsonArray results = element->find(text, flags);
+            const QList<QPair<int, int>> results =
+                    SearchEngine::matchRanges(text, element->text(), flags);
             counter += results.size();
 
             if (results.isEmpty())
@@ -2718,12 +2873,9 @@ int Screenplay::replace(const QString &text, const QString &replacementText, int
 
             QString elementText = element->text();
             for (int r = results.size() - 1; r >= 0; r--) {
-                const QString _from = QStringLiteral("from");
-                const QString _to = QStringLiteral("to");
-                const QJsonObject result = results.at(r).toObject();
-                const int from = result.value(_from).toInt();
-                const int to = result.value(_to).toInt();
-                elementText = elementText.replace(from, to - from + 1, replacementText);
+                const QPair<int, int> result = results.at(r);
+                elementText = elementText.replace(result.first, result.second - result.first + 1,
+                                                  replacementText);
             }
 
             element->setText(elementText);
@@ -3195,7 +3347,7 @@ void Screenplay::deserializeFromJson(const QJsonObject &json)
     }
 #endif
 
-    this->evaluateWordCountLater();
+    this->resetElementCounts();
     this->evaluateIfHeightHintsAreAvailableLater();
 
     const int currentIndex = json.value("#currentIndex").toInt();
@@ -3413,12 +3565,9 @@ void Screenplay::timerEvent(QTimerEvent *te)
     } else if (te->timerId() == m_updateBreakTitlesTimer.timerId()) {
         m_updateBreakTitlesTimer.stop();
         this->updateBreakTitles();
-    } else if (te->timerId() == m_paragraphCountEvaluationTimer.timerId()) {
-        m_paragraphCountEvaluationTimer.stop();
-        this->evaluateParagraphCounts();
-    } else if (te->timerId() == m_wordCountTimer.timerId()) {
-        m_wordCountTimer.stop();
-        this->evaluateWordCount();
+    } else if (te->timerId() == m_countsEvaluationTimer.timerId()) {
+        m_countsEvaluationTimer.stop();
+        this->evaluateCounts();
     } else if (te->timerId() == m_evalHeightHintsAvailableTimer.timerId()) {
         m_evalHeightHintsAvailableTimer.stop();
         this->evaluateIfHeightHintsAreAvailable();
@@ -3678,44 +3827,6 @@ void Screenplay::validateCurrentElementIndex()
     this->setCurrentElementIndex(val);
 }
 
-void Screenplay::evaluateParagraphCounts()
-{
-    int min = -1, max = -1, avg = 0, total = 0, count = 0;
-    for (ScreenplayElement *element : std::as_const(m_elements)) {
-        Scene *scene = element->scene();
-        if (scene == nullptr)
-            continue;
-
-        if (min < 0)
-            min = scene->elementCount();
-        else
-            min = qMin(min, scene->elementCount());
-
-        if (max < 0)
-            max = scene->elementCount();
-        else
-            max = qMax(max, scene->elementCount());
-
-        total += scene->elementCount();
-        ++count;
-    }
-
-    if (count > 0)
-        avg = qRound(qreal(total) / qreal(count));
-    else
-        avg = 0;
-
-    m_minimumParagraphCount = min;
-    m_maximumParagraphCount = max;
-    m_averageParagraphCount = avg;
-    emit paragraphCountChanged();
-}
-
-void Screenplay::evaluateParagraphCountsLater()
-{
-    m_paragraphCountEvaluationTimer.start(0, this);
-}
-
 void Screenplay::setHasNonStandardScenes(bool val)
 {
     if (m_hasNonStandardScenes == val)
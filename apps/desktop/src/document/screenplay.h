@@ -21,6 +21,7 @@
 #include "execlatertimer.h"
 #include "qobjectproperty.h"
 
+#include <QSet>
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QQmlListProperty>
@@ -36,6 +37,7 @@ class ScreenplayElement : public QObject, public Modifiable, public QObjectSeria
     Q_OBJECT
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit ScreenplayElement(QObject *parent = nullptr);
@@ -307,6 +309,7 @@ public:
     Q_SIGNAL void sceneAboutToReset();
     Q_SIGNAL void sceneReset(int elementIndex);
     Q_SIGNAL void sceneContentChanged();
+    Q_SIGNAL void sceneDialogueCountChanged();
     Q_SIGNAL void sceneHeadingChanged();
     Q_SIGNAL void sceneElementChanged(SceneElement *sceneElement);
     Q_SIGNAL void evaluateSceneNumberRequest();
@@ -459,6 +462,7 @@ class Screenplay : public QAbstractListModel, public Modifiable, public QObjectS
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
     QML_UNCREATABLE("Instantiation from QML not allowed.")
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     explicit Screenplay(QObject *parent = nullptr);
@@ -767,6 +771,7 @@ public:
     Q_INVOKABLE QList<int> sceneElementsInBreak(ScreenplayElement *element) const;
 
     int dialogueCount() const;
+    Q_INVOKABLE int characterDialogueCount(const QString &characterName) const;
     QList<ScreenplayElement *> getElements() const { return m_elements; }
     QList<ScreenplayElement *>
     getFilteredElements(std::function<bool(ScreenplayElement *item)> filterFunc) const;
@@ -848,7 +853,8 @@ public:
 
     Q_SIGNAL void sceneReset(int sceneIndex, int sceneElementIndex);
 
-    Q_INVOKABLE QJsonArray search(const QString &text, int flags = 0) const;
+    // Returns index of the scene in which each match is found, in order of the matches.
+    Q_INVOKABLE QList<int> search(const QString &text, int flags = 0) const;
     Q_INVOKABLE int replace(const QString &text, const QString &replacementText, int flags = 0);
 
     // clang-format off
@@ -948,8 +954,6 @@ protected:
     void evaluateSceneNumbers(bool minorAlso = false);
     void evaluateSceneNumbersLater();
     void validateCurrentElementIndex();
-    void evaluateParagraphCounts();
-    void evaluateParagraphCountsLater();
     void setHasNonStandardScenes(bool val);
     void setHasTitlePageAttributes(bool val);
     void evaluateHasTitlePageAttributes();
@@ -961,8 +965,13 @@ protected:
     void connectToScreenplayElementSignals(ScreenplayElement *ptr);
     void disconnectFromScreenplayElementSignals(ScreenplayElement *ptr);
     void setWordCount(int val);
-    void evaluateWordCount();
-    void evaluateWordCountLater();
+    void onElementCountsChanged();
+    void updateElementCounts(const ScreenplayElement *element);
+    void removeElementCounts(const ScreenplayElement *element);
+    void resetElementCounts();
+    void evaluateCounts();
+    void evaluateCountsLater();
+    void evaluatePendingCounts() const;
     bool getPasteDataFromClipboard(QJsonObject &clipboardJson) const;
     void setHeightHintsAvailable(bool val);
     void evaluateIfHeightHintsAreAvailable();
@@ -1010,11 +1019,30 @@ private:
     int m_actCount = 0;
     int m_sceneCount = 0;
     int m_wordCount = 0;
+    int m_dialogueCount = 0;
 
-    ExecLaterTimer m_wordCountTimer;
+    // Counts contributed by each element, so that word, paragraph and dialogue
+    // counts of the whole screenplay can be updated by deltas.
+    struct ElementCounts
+    {
+        bool hasScene = false;
+        int wordCount = 0;
+        int paragraphCount = 0;
+        int dialogueCount = 0;
+        QHash<QString, int> characterDialogueCounts;
+    };
+    void applyElementCounts(const ElementCounts &counts, int sign);
+    QHash<const ScreenplayElement *, ElementCounts> m_elementCounts;
+    QSet<const ScreenplayElement *> m_dirtyElementCounts;
+    QHash<QString, int> m_characterDialogueCounts;
+    QMap<int, int> m_paragraphCountHistogram; // paragraph-count -> number of scenes
+    int m_totalWordCount = 0;
+    int m_totalParagraphCount = 0;
+    bool m_resetElementCounts = true;
+
+    ExecLaterTimer m_countsEvaluationTimer;
     ExecLaterTimer m_updateBreakTitlesTimer;
     ExecLaterTimer m_sceneNumberEvaluationTimer;
-    ExecLaterTimer m_paragraphCountEvaluationTimer;
     ExecLaterTimer m_evalHeightHintsAvailableTimer;
     ExecLaterTimer m_selectedElementsOmitStatusChangedTimer;
 };
@@ -77,18 +77,15 @@ struct ParagraphMetrics
 SceneElementFormat::SceneElementFormat(SceneElement::Type type, ScreenplayFormat *parent)
     : QObject(parent), m_elementType(type), m_format(parent)
 {
-    QObject::connect(this, &SceneElementFormat::elementFormatChanged, [this]() {
-        this->markAsModified();
-        m_lastCreatedBlockFormatPageWidth = -1;
-        m_lastCreatedCharFormatPageWidth = -1;
-    });
+    QObject::connect(this, &SceneElementFormat::elementFormatChanged, this,
+                     &SceneElementFormat::markAsModified);
 
     QObject::connect(this, &SceneElementFormat::fontChanged, this,
                      &SceneElementFormat::font2Changed);
     QObject::connect(m_format, &ScreenplayFormat::fontPointSizeDeltaChanged, this,
                      &SceneElementFormat::font2Changed);
     QObject::connect(m_format, &ScreenplayFormat::fontPointSizeDeltaChanged, this,
-                     &SceneElementFormat::elementFormatChanged);
+                     [this]() { this->notifyChange(FontChange); });
 }
 
 SceneElementFormat::~SceneElementFormat() { }
@@ -127,7 +124,7 @@ void SceneElementFormat::setFontBold(SceneElementFormat::Tristate val)
     m_fontBold = val;
     emit fontBoldChanged();
     emit fontChanged();
-    emit elementFormatChanged();
+    this->notifyChange(FontChange);
 }
 
 void SceneElementFormat::setFontItalics(SceneElementFormat::Tristate val)
@@ -138,7 +135,7 @@ void SceneElementFormat::setFontItalics(SceneElementFormat::Tristate val)
     m_fontItalics = val;
     emit fontItalicsChanged();
     emit fontChanged();
-    emit elementFormatChanged();
+    this->notifyChange(FontChange);
 }
 
 void SceneElementFormat::setFontUnderline(SceneElementFormat::Tristate val)
@@ -149,7 +146,7 @@ void SceneElementFormat::setFontUnderline(SceneElementFormat::Tristate val)
     m_fontUnderline = val;
     emit fontUnderlineChanged();
     emit fontChanged();
-    emit elementFormatChanged();
+    this->notifyChange(FontChange);
 }
 
 void SceneElementFormat::setFontPointSize(int val)
@@ -160,7 +157,7 @@ void SceneElementFormat::setFontPointSize(int val)
     m_fontPointSize = val;
     emit fontPointSizeChanged();
     emit fontChanged();
-    emit elementFormatChanged();
+    this->notifyChange(FontChange);
 }
 
 void SceneElementFormat::setFontCapitalization(QFont::Capitalization val)
@@ -171,7 +168,7 @@ void SceneElementFormat::setFontCapitalization(QFont::Capitalization val)
     m_fontCapitalization = val;
     emit fontCapitalizationChanged();
     emit fontChanged();
-    emit elementFormatChanged();
+    this->notifyChange(FontChange);
 }
 
 void SceneElementFormat::setTextColor(const QColor &val)
@@ -181,7 +178,7 @@ void SceneElementFormat::setTextColor(const QColor &val)
 
     m_textColor = val;
     emit textColorChanged();
-    emit elementFormatChanged();
+    this->notifyChange(TextColorChange);
 }
 
 void SceneElementFormat::setTextAlignment(Qt::Alignment val)
@@ -191,7 +188,7 @@ void SceneElementFormat::setTextAlignment(Qt::Alignment val)
 
     m_textAlignment = val;
     emit textAlignmentChanged();
-    emit elementFormatChanged();
+    this->notifyChange(TextAlignmentChange);
 }
 
 void SceneElementFormat::setBackgroundColor(const QColor &val)
@@ -208,7 +205,7 @@ void SceneElementFormat::setBackgroundColor(const QColor &val)
 
     m_backgroundColor = val2;
     emit backgroundColorChanged();
-    emit elementFormatChanged();
+    this->notifyChange(BackgroundColorChange);
 }
 
 void SceneElementFormat::setTextIndent(qreal val)
@@ -219,8 +216,7 @@ void SceneElementFormat::setTextIndent(qreal val)
 
     m_textIndent = val2;
     emit textIndentChanged();
-
-    emit elementFormatChanged();
+    this->notifyChange(TextIndentChange);
 }
 
 void SceneElementFormat::setLineHeight(qreal val)
@@ -232,7 +228,7 @@ void SceneElementFormat::setLineHeight(qreal val)
     m_lineHeight = val2;
 
     emit lineHeightChanged();
-    emit elementFormatChanged();
+    this->notifyChange(LineSpacingChange);
 }
 
 void SceneElementFormat::setLineSpacingBefore(qreal val)
@@ -243,7 +239,7 @@ void SceneElementFormat::setLineSpacingBefore(qreal val)
 
     m_lineSpacingBefore = val;
     emit lineSpacingBeforeChanged();
-    emit elementFormatChanged();
+    this->notifyChange(LineSpacingChange);
 }
 
 void SceneElementFormat::setLeftMargin(qreal val)
@@ -254,7 +250,7 @@ void SceneElementFormat::setLeftMargin(qreal val)
 
     m_leftMargin = val;
     emit leftMarginChanged();
-    emit elementFormatChanged();
+    this->notifyChange(MarginsChange);
 }
 
 void SceneElementFormat::setRightMargin(qreal val)
@@ -265,7 +261,7 @@ void SceneElementFormat::setRightMargin(qreal val)
 
     m_rightMargin = val;
     emit rightMarginChanged();
-    emit elementFormatChanged();
+    this->notifyChange(MarginsChange);
 }
 
 void SceneElementFormat::setDefaultLanguageCode(int val)
@@ -276,6 +272,7 @@ void SceneElementFormat::setDefaultLanguageCode(int val)
     m_defaultLanguageCode = val;
     emit defaultLanguageCodeChanged();
     emit fontChanged();
+    this->notifyChange(FontChange);
 }
 
 void SceneElementFormat::activateDefaultLanguage()
@@ -376,11 +373,18 @@ QTextCharFormat SceneElementFormat::createCharFormat(const qreal *givenPageWidth
 
 void SceneElementFormat::applyToAll(SceneElementFormat::Properties properties)
 {
+    const bool ownTransaction = !m_format->isInTransaction();
+    if (ownTransaction)
+        m_format->beginTransaction();
+
     if (properties == AllProperties) {
         for (int i = FontSize; i <= TextIndent; i++)
             m_format->applyToAll(this, SceneElementFormat::Properties(i));
     } else
         m_format->applyToAll(this, properties);
+
+    if (ownTransaction)
+        m_format->commitTransaction();
 }
 
 void SceneElementFormat::beginTransaction()
@@ -392,8 +396,7 @@ void SceneElementFormat::beginTransaction()
     emit inTransactionChanged();
 
     m_nrChangesDuringTransation = 0;
-    connect(this, &SceneElementFormat::elementFormatChanged, this,
-            &SceneElementFormat::countTransactionChange);
+    m_changesDuringTransaction = NoChange;
 }
 
 void SceneElementFormat::commitTransaction()
@@ -404,16 +407,23 @@ void SceneElementFormat::commitTransaction()
     m_inTransaction = false;
     emit inTransactionChanged();
 
-    disconnect(this, &SceneElementFormat::elementFormatChanged, this,
-               &SceneElementFormat::countTransactionChange);
-    if (m_nrChangesDuringTransation > 0)
-        emit elementFormatChanged();
-
+    const int nrChanges = m_nrChangesDuringTransation;
+    const ChangedProperties changes = m_changesDuringTransaction;
     m_nrChangesDuringTransation = 0;
+    m_changesDuringTransaction = NoChange;
+
+    if (nrChanges > 0) {
+        emit elementFormatChanged();
+        m_format->noteChange(changes, m_elementType);
+    }
 }
 
 void SceneElementFormat::resetToFactoryDefaults()
 {
+    const bool ownTransaction = !m_inTransaction;
+    if (ownTransaction)
+        this->beginTransaction();
+
     this->setFontBold(Auto);
     this->setFontItalics(Auto);
     this->setFontUnderline(Auto);
@@ -428,6 +438,25 @@ void SceneElementFormat::resetToFactoryDefaults()
     this->setBackgroundColor(Qt::transparent);
     this->setTextAlignment(Qt::AlignLeft);
     this->setDefaultLanguageCode(-1);
+
+    if (ownTransaction)
+        this->commitTransaction();
+}
+
+void SceneElementFormat::notifyChange(ChangedProperties changes)
+{
+    m_lastCreatedBlockFormatPageWidth = -1;
+    m_lastCreatedCharFormatPageWidth = -1;
+
+    // While in a transaction, changes are only counted. They are announced once, on commit.
+    if (m_inTransaction) {
+        ++m_nrChangesDuringTransation;
+        m_changesDuringTransaction |= changes;
+        return;
+    }
+
+    emit elementFormatChanged();
+    m_format->noteChange(changes, m_elementType);
 }
 
 void SceneElementFormat::serializeToJson(QJsonObject &json) const
@@ -630,10 +659,9 @@ ScreenplayFormat::ScreenplayFormat(QObject *parent)
 {
     for (int i = SceneElement::Min; i <= SceneElement::Max; i++) {
         SceneElementFormat *elementFormat = new SceneElementFormat(SceneElement::Type(i), this);
-        connect(elementFormat, &SceneElementFormat::elementFormatChanged, this,
-                &ScreenplayFormat::formatChanged);
         m_elementFormats.append(elementFormat);
     }
+    m_changesDuringTransaction = QList<int>(m_elementFormats.size(), 0);
 
     connect(this, &ScreenplayFormat::formatChanged, [this]() { this->markAsModified(); });
 
@@ -753,6 +781,10 @@ void ScreenplayFormat::applyToAll(const SceneElementFormat *from,
     if (from == nullptr)
         return;
 
+    const bool ownTransaction = !m_inTransaction;
+    if (ownTransaction)
+        this->beginTransaction();
+
     for (SceneElementFormat *format : std::as_const(m_elementFormats)) {
         if (from == format)
             continue;
@@ -786,6 +818,9 @@ void ScreenplayFormat::applyToAll(const SceneElementFormat *from,
             break;
         }
     }
+
+    if (ownTransaction)
+        this->commitTransaction();
 }
 
 int ScreenplayFormat::rowCount(const QModelIndex &parent) const
@@ -817,11 +852,15 @@ void ScreenplayFormat::setSecondsPerPage(int val)
     m_secondsPerPage = val;
     emit secondsPerPageChanged();
 
-    emit formatChanged();
+    this->noteChange(SceneElementFormat::NoChange);
 }
 
 void ScreenplayFormat::resetToFactoryDefaults()
 {
+    const bool ownTransaction = !m_inTransaction;
+    if (ownTransaction)
+        this->beginTransaction();
+
     QSettings *settings = Application::instance()->settings();
     const int iPaperSize = settings->value("PageSetup/paperSize").toInt();
     if (iPaperSize == ScreenplayPageLayout::A4)
@@ -857,6 +896,9 @@ void ScreenplayFormat::resetToFactoryDefaults()
         m_elementFormats[i]->setFontCapitalization(paraMetrics.fontCappingOf(i));
         m_elementFormats[i]->setTextAlignment(paraMetrics.textAlignOf(i));
     }
+
+    if (ownTransaction)
+        this->commitTransaction();
 }
 
 bool ScreenplayFormat::saveAsUserDefaults()
@@ -879,32 +921,44 @@ void ScreenplayFormat::resetToUserDefaults()
 {
     const QString formatFile = Utils::Platform::configPath(QStringLiteral("formatting.json"));
 
-    this->resetToFactoryDefaults();
+    // Factory defaults and user defaults are applied as one change, so that documents are
+    // laid out only once for the resulting format.
+    const bool ownTransaction = !m_inTransaction;
+    if (ownTransaction)
+        this->beginTransaction();
 
-    if (!QFile::exists(formatFile))
-        return;
+    auto loadUserDefaults = [&]() {
+        this->resetToFactoryDefaults();
 
-    QFile file(formatFile);
-    if (!file.open(QFile::ReadOnly))
-        return;
+        if (!QFile::exists(formatFile))
+            return;
 
-    const QByteArray jsonStr = file.readAll();
-    if (jsonStr.isEmpty())
-        return;
+        QFile file(formatFile);
+        if (!file.open(QFile::ReadOnly))
+            return;
 
-    QJsonParseError jsonError;
-    const QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonStr, &jsonError);
-    if (jsonError.error != QJsonParseError::NoError)
-        return;
+        const QByteArray jsonStr = file.readAll();
+        if (jsonStr.isEmpty())
+            return;
 
-    if (!jsonDoc.isObject())
-        return;
+        QJsonParseError jsonError;
+        const QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonStr, &jsonError);
+        if (jsonError.error != QJsonParseError::NoError)
+            return;
 
-    const QJsonObject json = jsonDoc.object();
-    if (json.isEmpty())
-        return;
+        if (!jsonDoc.isObject())
+            return;
+
+        const QJsonObject json = jsonDoc.object();
+        if (json.isEmpty())
+            return;
 
-    QObjectSerializer::fromJson(json, this);
+        QObjectSerializer::fromJson(json, this);
+    };
+    loadUserDefaults();
+
+    if (ownTransaction)
+        this->commitTransaction();
 }
 
 void ScreenplayFormat::beginTransaction()
@@ -916,8 +970,6 @@ void ScreenplayFormat::beginTransaction()
     emit inTransactionChanged();
 
     m_nrChangesDuringTransation = 0;
-    connect(this, &ScreenplayFormat::formatChanged, this,
-            &ScreenplayFormat::countTransactionChange);
 
     for (int i = SceneElement::Min; i <= SceneElement::Max; i++)
         m_elementFormats.at(i)->beginTransaction();
@@ -934,12 +986,11 @@ void ScreenplayFormat::commitTransaction()
     m_inTransaction = false;
     emit inTransactionChanged();
 
-    disconnect(this, &ScreenplayFormat::formatChanged, this,
-               &ScreenplayFormat::countTransactionChange);
-    if (m_nrChangesDuringTransation > 0)
-        emit formatChanged();
-
+    const int nrChanges = m_nrChangesDuringTransation;
     m_nrChangesDuringTransation = 0;
+
+    if (nrChanges > 0)
+        this->publishChanges();
 }
 
 void ScreenplayFormat::serializeToJson(QJsonObject &json) const
@@ -992,8 +1043,17 @@ void ScreenplayFormat::evaluateFontPointSizeDelta()
         return;
 
     m_fontPointSizeDelta = val;
+
+    // Every element format changes with the delta, but listeners must hear about it only once.
+    const bool ownTransaction = !m_inTransaction;
+    if (ownTransaction)
+        this->beginTransaction();
+
     emit fontPointSizeDeltaChanged();
-    emit formatChanged();
+    this->noteChange(SceneElementFormat::FontChange);
+
+    if (ownTransaction)
+        this->commitTransaction();
 }
 
 void ScreenplayFormat::evaluateFontZoomLevels()
@@ -1069,6 +1129,31 @@ void ScreenplayFormat::evaluateFontZoomLevels()
     emit fontZoomLevelIndexChanged();
 }
 
+void ScreenplayFormat::noteChange(SceneElementFormat::ChangedProperties changes, int elementType)
+{
+    if (elementType < 0) {
+        for (int &elementChanges : m_changesDuringTransaction)
+            elementChanges |= int(changes);
+    } else if (elementType < m_changesDuringTransaction.size())
+        m_changesDuringTransaction[elementType] |= int(changes);
+
+    if (m_inTransaction) {
+        ++m_nrChangesDuringTransation;
+        return;
+    }
+
+    this->publishChanges();
+}
+
+void ScreenplayFormat::publishChanges()
+{
+    const QList<int> changes = m_changesDuringTransaction;
+    m_changesDuringTransaction.fill(0);
+
+    emit formatChanged();
+    emit formatRevisionChanged(++m_formatRevision, changes);
+}
+
 SceneElementFormat *
 ScreenplayFormat::staticElementFormatAt(QQmlListProperty<SceneElementFormat> *list, qsizetype index)
 {
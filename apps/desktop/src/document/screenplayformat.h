@@ -245,6 +245,23 @@ public:
     Q_ENUM(Properties)
     Q_INVOKABLE void applyToAll(SceneElementFormat::Properties properties);
 
+    // Describes what a format change touched, so that listeners of
+    // ScreenplayFormat::formatRevisionChanged() can skip work that doesn't depend on it.
+    enum ChangedProperty {
+        NoChange = 0,
+        FontChange = 1,
+        TextColorChange = 2,
+        BackgroundColorChange = 4,
+        TextAlignmentChange = 8,
+        TextIndentChange = 16,
+        LineSpacingChange = 32,
+        MarginsChange = 64,
+        AllChanges = 127,
+        LayoutChanges = AllChanges & ~(TextColorChange | BackgroundColorChange)
+    };
+    Q_DECLARE_FLAGS(ChangedProperties, ChangedProperty)
+    Q_FLAG(ChangedProperties)
+
     Q_INVOKABLE void beginTransaction();
     Q_INVOKABLE bool hasChangesToCommit() { return m_nrChangesDuringTransation > 0; }
     Q_INVOKABLE void commitTransaction();
@@ -267,7 +284,7 @@ private:
     friend class ScreenplayFormat;
     SceneElementFormat(SceneElement::Type type = SceneElement::Action,
                        ScreenplayFormat *parent = nullptr);
-    void countTransactionChange() { ++m_nrChangesDuringTransation; }
+    void notifyChange(ChangedProperties changes);
 
 private:
     int m_fontPointSize = -1;
@@ -275,6 +292,7 @@ private:
     int m_nrChangesDuringTransation = 0;
 
     bool m_inTransaction = false;
+    ChangedProperties m_changesDuringTransaction;
 
     qreal m_textIndent = 0.0;
     qreal m_lineHeight = 1.0;
@@ -302,6 +320,8 @@ private:
     mutable QTextCharFormat m_lastCreatedCharFormat;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(SceneElementFormat::ChangedProperties)
+
 class ScreenplayPageLayout : public QObject
 {
     Q_OBJECT
@@ -623,6 +643,18 @@ public:
     Q_INVOKABLE SceneElementFormat *elementFormat(int type) const;
     Q_SIGNAL void formatChanged();
 
+    // Bumped once for every coalesced batch of changes, that is once per formatChanged().
+    // The signal carries SceneElementFormat::ChangedProperties for each element type,
+    // indexed by SceneElement::Type.
+    // clang-format off
+    Q_PROPERTY(int formatRevision
+               READ formatRevision
+               NOTIFY formatRevisionChanged
+               STORED false)
+    // clang-format on
+    int formatRevision() const { return m_formatRevision; }
+    Q_SIGNAL void formatRevisionChanged(int revision, const QList<int> &changes);
+
     // clang-format off
     Q_PROPERTY(QQmlListProperty<SceneElementFormat> elementFormats
                READ elementFormats)
@@ -688,9 +720,14 @@ private:
     void resetScreen();
     void evaluateFontPointSizeDelta();
     void evaluateFontZoomLevels();
-    void countTransactionChange() { ++m_nrChangesDuringTransation; }
+
+    // Changes are collected while in a transaction and published together on commit.
+    friend class SceneElementFormat;
+    void noteChange(SceneElementFormat::ChangedProperties changes, int elementType = -1);
+    void publishChanges();
 
 private:
+    int m_formatRevision = 0;
     int m_secondsPerPage = 60;
     int m_fontPointSizeDelta = 0;
     int m_fontZoomLevelIndex = -1;
@@ -713,6 +750,7 @@ private:
                                                      qsizetype index);
     static qsizetype staticElementFormatCount(QQmlListProperty<SceneElementFormat> *list);
     QList<SceneElementFormat *> m_elementFormats;
+    QList<int> m_changesDuringTransaction;
 };
 
 #endif // SCREENPLAYFORMAT_H
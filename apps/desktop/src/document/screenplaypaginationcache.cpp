@@ -0,0 +1,221 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "screenplaypaginationcache.h"
+#include "screenplaypaginatorworker.h"
+#include "languageengine.h"
+
+#include <QDir>
+#include <QFile>
+#include <QBuffer>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+
+static const char paginationCacheMagic[] = "SCRITEPC";
+
+// Bump this whenever the file layout changes. Files from other versions are ignored.
+static const quint32 paginationCacheVersion = 1;
+
+// Bump this whenever the way pagination is computed changes. It is part of every key, along
+// with the application version, so results computed differently simply miss the cache.
+static const quint32 paginationLayoutVersion = 1;
+
+// Number of cache files to keep around, most recently used first.
+static const int paginationCacheFileLimit = 64;
+
+QByteArray ScreenplayPaginationCache::key(const QJsonObject &format,
+                                          const QList<SceneContent> &content)
+{
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    hasher.addData(QJsonDocument(format).toJson(QJsonDocument::Compact));
+
+    QByteArray bytes;
+    QDataStream ds(&bytes, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_6_0);
+
+    ds << paginationLayoutVersion << QCoreApplication::applicationVersion();
+
+    // Text in each script is laid out in the font family chosen for it, which users can change
+    // in settings without touching the document or its format.
+    const LanguageEngine *languageEngine = LanguageEngine::instance();
+    for (int script = QChar::Script_Unknown; script < QChar::ScriptCount; script++)
+        ds << languageEngine->scriptFontFamily(QChar::Script(script));
+
+    for (const SceneContent &scene : content) {
+        ds << scene.type << scene.breakType << scene.serialNumber << scene.omitted << scene.id;
+        ds << qint32(scene.paragraphs.size());
+        for (const SceneParagraph &paragraph : scene.paragraphs) {
+            ds << paragraph.id << paragraph.enabled << paragraph.type << paragraph.text
+               << int(paragraph.alignment) << qint32(paragraph.formats.size());
+            for (const QTextLayout::FormatRange &range : paragraph.formats)
+                ds << range.start << range.length << range.format;
+        }
+    }
+
+    hasher.addData(bytes);
+    return hasher.result().toHex();
+}
+
+bool ScreenplayPaginationCache::load(const QByteArray &key, Result &result)
+{
+    const QString folder = cacheFolderPath();
+    if (key.isEmpty() || folder.isEmpty())
+        return false;
+
+    QFile file(QDir(folder).absoluteFilePath(QString::fromLatin1(key)));
+    if (!file.open(QFile::ReadOnly) || file.size() == 0)
+        return false;
+
+    // Pagination records of a long screenplay are not tiny, and we want them only once.
+    // Mapping the file avoids copying the whole of it into a buffer before parsing.
+    const qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    QByteArray bytes = data ? QByteArray::fromRawData(reinterpret_cast<const char *>(data), size)
+                            : file.readAll();
+
+    QBuffer buffer(&bytes);
+    buffer.open(QBuffer::ReadOnly);
+
+    QDataStream ds(&buffer);
+    ds.setVersion(QDataStream::Qt_6_0);
+
+    auto fail = [&]() {
+        if (data)
+            file.unmap(data);
+        file.close();
+        file.remove();
+        return false;
+    };
+
+    QByteArray magic(sizeof(paginationCacheMagic) - 1, Qt::Uninitialized);
+    quint32 version = 0;
+    QByteArray storedKey;
+    if (ds.readRawData(magic.data(), magic.size()) != magic.size() || magic != paginationCacheMagic)
+        return fail();
+
+    ds >> version >> storedKey;
+    if (version != paginationCacheVersion || storedKey != key)
+        return fail();
+
+    Result ret;
+    qint32 recordCount = 0;
+    ds >> ret.pixelLength >> ret.pageCount >> ret.totalTime >> ret.totalPageLength1_8
+            >> recordCount;
+    if (ds.status() != QDataStream::Ok || recordCount < 0)
+        return fail();
+
+    ret.records.reserve(recordCount);
+    for (int i = 0; i < recordCount; i++) {
+        ScreenplayPaginatorRecord record;
+        qint32 pageBreakCount = 0;
+        ds >> record.serialNumber >> record.firstCursorPosition
+                >> record.firstParagraphCursorPosition >> record.lastCursorPosition
+                >> record.pixelLength >> record.pageLength >> record.pageLength1_8
+                >> record.timeLength >> record.pixelOffset >> record.pageOffset
+                >> record.timeOffset >> pageBreakCount;
+        if (ds.status() != QDataStream::Ok || pageBreakCount < 0)
+            return fail();
+
+        for (int j = 0; j < pageBreakCount; j++) {
+            ScenePageBreak pageBreak;
+            ds >> pageBreak.cursorPosition >> pageBreak.pageNumber;
+            record.pageBreaks.append(pageBreak);
+        }
+
+        ret.records.append(record);
+    }
+
+    if (ds.status() != QDataStream::Ok)
+        return fail();
+
+    if (data)
+        file.unmap(data);
+    file.close();
+
+    // Touch the file, so that pruning keeps recently used entries.
+    if (file.open(QFile::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFile::FileModificationTime);
+        file.close();
+    }
+
+    result = ret;
+    return true;
+}
+
+bool ScreenplayPaginationCache::save(const QByteArray &key, const Result &result)
+{
+    const QString folder = cacheFolderPath();
+    if (key.isEmpty() || folder.isEmpty())
+        return false;
+
+    QSaveFile file(QDir(folder).absoluteFilePath(QString::fromLatin1(key)));
+    if (!file.open(QFile::WriteOnly))
+        return false;
+
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_6_0);
+
+    ds.writeRawData(paginationCacheMagic, sizeof(paginationCacheMagic) - 1);
+    ds << paginationCacheVersion << key;
+    ds << result.pixelLength << result.pageCount << result.totalTime << result.totalPageLength1_8
+       << qint32(result.records.size());
+    for (const ScreenplayPaginatorRecord &record : result.records) {
+        ds << record.serialNumber << record.firstCursorPosition
+           << record.firstParagraphCursorPosition << record.lastCursorPosition
+           << record.pixelLength << record.pageLength << record.pageLength1_8 << record.timeLength
+           << record.pixelOffset << record.pageOffset << record.timeOffset
+           << qint32(record.pageBreaks.size());
+        for (const ScenePageBreak &pageBreak : record.pageBreaks)
+            ds << pageBreak.cursorPosition << pageBreak.pageNumber;
+    }
+
+    if (ds.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit())
+        return false;
+
+    prune();
+    return true;
+}
+
+QString ScreenplayPaginationCache::cacheFolderPath()
+{
+    static const QString path = []() -> QString {
+        const QString cacheLocation =
+                QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (cacheLocation.isEmpty())
+            return QString();
+
+        const QString ret = QDir(cacheLocation).absoluteFilePath(QStringLiteral("pagination"));
+        return QDir().mkpath(ret) ? ret : QString();
+    }();
+    return path;
+}
+
+void ScreenplayPaginationCache::prune()
+{
+    const QDir folder(cacheFolderPath());
+    const QFileInfoList files = folder.entryInfoList(QDir::Files, QDir::Time);
+    for (int i = paginationCacheFileLimit; i < files.size(); i++)
+        QFile::remove(files.at(i).absoluteFilePath());
+}
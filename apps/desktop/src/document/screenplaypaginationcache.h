@@ -0,0 +1,63 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef SCREENPLAYPAGINATIONCACHE_H
+#define SCREENPLAYPAGINATIONCACHE_H
+
+#include <QJsonObject>
+
+#include "screenplaypaginator.h"
+
+struct SceneContent;
+
+/**
+ * Remembers pagination results across sessions, so that opening a document whose
+ * screenplay and print format haven't changed since it was last paginated doesn't
+ * have to lay out the whole screenplay again, before page counts and scene lengths
+ * can be shown.
+ *
+ * Results are stored in the application's cache folder, one file per key. Keys are
+ * hashes of the print format, the font family used for each script, the application and
+ * pagination algorithm versions, and the content of every scene (paragraph text, types,
+ * alignment and formatting, serial numbers and omitted state), so any change in
+ * any of them simply misses the cache. Each file also carries the version of its
+ * layout and the full key, which are checked before anything in it is trusted.
+ *
+ * Cache files are memory mapped while being read, and written atomically.
+ */
+class ScreenplayPaginationCache
+{
+public:
+    struct Result
+    {
+        QList<ScreenplayPaginatorRecord> records;
+        qreal pixelLength = 0;
+        int pageCount = 0;
+        QTime totalTime;
+        QString totalPageLength1_8;
+    };
+
+    static QByteArray key(const QJsonObject &format, const QList<SceneContent> &content);
+    static bool load(const QByteArray &key, Result &result);
+    static bool save(const QByteArray &key, const Result &result);
+
+    static QString cacheFolderPath();
+
+private:
+    ScreenplayPaginationCache() { }
+    static void prune();
+};
+
+#endif // SCREENPLAYPAGINATIONCACHE_H
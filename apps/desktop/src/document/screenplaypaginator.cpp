@@ -15,6 +15,7 @@
 
 #include "screenplaypaginator.h"
 #include "screenplaypaginatorworker.h"
+#include "screenplaypaginationcache.h"
 #include "scritedocument.h"
 #include "utils.h"
 
@@ -118,6 +119,13 @@ ScreenplayPaginator::ScreenplayPaginator(QObject *parent) : QObject(parent)
     connect(this, &ScreenplayPaginator::cursorPositionChanged, this,
             &ScreenplayPaginator::onCursorPositionChanged);
 
+    // Pagination is remembered for the document as it was saved, because that's what
+    // the next session is going to open.
+    ScriteDocument *document = ScriteDocument::instance();
+    connect(document, &ScriteDocument::justSaved, this, &ScreenplayPaginator::savePaginationCache);
+    connect(document, &ScriteDocument::aboutToReset, this,
+            &ScreenplayPaginator::savePaginationCache);
+
     QTimer::singleShot(0, this, &ScreenplayPaginator::useDefaultFormatAndScreenplay);
 }
 
@@ -187,9 +195,12 @@ void ScreenplayPaginator::setFormat(ScreenplayFormat *val)
 
     m_format = val;
 
-    if (m_format != nullptr)
-        connect(m_format, &ScreenplayFormat::formatChanged, this,
+    if (m_format != nullptr) {
+        connect(m_format, &ScreenplayFormat::formatRevisionChanged, this,
+                &ScreenplayPaginator::onFormatRevisionChanged);
+        connect(m_format, &ScreenplayFormat::secondsPerPageChanged, this,
                 &ScreenplayPaginator::onFormatChanged);
+    }
 
     this->clear();
 
@@ -590,12 +601,23 @@ void ScreenplayPaginator::onFormatChanged()
     if (!m_enabled)
         return;
 
-    ScreenplayFormat *format =
-            m_format == nullptr ? ScriteDocument::instance()->printFormat() : m_format;
-
-    const QJsonObject formatJson = QObjectSerializer::toJson(format);
     this->incrementSyncCounter();
-    m_workerNode->useFormat(formatJson);
+    m_workerNode->useFormat(this->formatJson());
+    this->primeDeferredWorker();
+}
+
+void ScreenplayPaginator::onFormatRevisionChanged(int revision, const QList<int> &changes)
+{
+    Q_UNUSED(revision)
+
+    // Text and background colors don't move page breaks, so there is no need to repaginate
+    // when only they have changed.
+    for (int change : changes) {
+        if (change & SceneElementFormat::LayoutChanges) {
+            this->onFormatChanged();
+            return;
+        }
+    }
 }
 
 void ScreenplayPaginator::onScreenplayReset()
@@ -604,6 +626,10 @@ void ScreenplayPaginator::onScreenplayReset()
         return;
 
     QList<SceneContent> screenplayContent = SceneContent::fromScreenplay(m_screenplay);
+    if (this->usePaginationCache(screenplayContent))
+        return;
+
+    m_workerDeferred = false;
     this->incrementSyncCounter();
     m_workerNode->reset(screenplayContent);
 }
@@ -621,6 +647,9 @@ void ScreenplayPaginator::onScreenplayElementInserted(ScreenplayElement *element
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     SceneContent sceneContent = SceneContent::fromScreenplayElement(element);
     this->incrementSyncCounter();
     m_workerNode->insertElement(index, sceneContent);
@@ -631,6 +660,9 @@ void ScreenplayPaginator::onScreenplayElementRemoved(ScreenplayElement *element,
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     Q_UNUSED(element)
     this->incrementSyncCounter();
     m_workerNode->removeElement(index);
@@ -641,6 +673,9 @@ void ScreenplayPaginator::onScreenplayElementOmitted(ScreenplayElement *element,
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     Q_UNUSED(element)
     this->incrementSyncCounter();
     m_workerNode->omitElement(index);
@@ -651,6 +686,9 @@ void ScreenplayPaginator::onScreenplayElementIncluded(ScreenplayElement *element
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     Q_UNUSED(element)
     this->incrementSyncCounter();
     m_workerNode->includeElement(index);
@@ -661,6 +699,9 @@ void ScreenplayPaginator::onScreenplayElementSceneReset(ScreenplayElement *eleme
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     Q_UNUSED(scene)
     SceneContent sceneContent = SceneContent::fromScreenplayElement(element);
     this->incrementSyncCounter();
@@ -673,6 +714,9 @@ void ScreenplayPaginator::onScreenplayElementSceneHeadingChanged(ScreenplayEleme
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     Q_UNUSED(element)
     SceneParagraph paragraph = SceneParagraph::fromSceneHeading(sceneHeading);
     this->incrementSyncCounter();
@@ -685,6 +729,9 @@ void ScreenplayPaginator::onScreenplayElementSceneElementChanged(ScreenplayEleme
     if (!m_enabled)
         return;
 
+    if (this->primeDeferredWorker())
+        return;
+
     Q_UNUSED(element)
     SceneParagraph paragraph = SceneParagraph::fromSceneElement(sceneElement);
     this->incrementSyncCounter();
@@ -709,6 +756,8 @@ void ScreenplayPaginator::onCursorPositionChanged()
         return;
     }
 
+    this->primeDeferredWorker();
+
     const int currentSerialNumber = currentElement->serialNumber();
     m_workerNode->queryCursor(m_cursorPosition, currentSerialNumber);
 }
@@ -733,6 +782,18 @@ void ScreenplayPaginator::onPaginationComplete(const QList<ScreenplayPaginatorRe
                                                qreal pixelLength, int pageCount,
                                                const QTime &totalTime,
                                                const QString &totalPageLength1_8)
+{
+    // While deferred, the worker doesn't have the screenplay whose pagination is
+    // currently on display, so whatever it reports is stale.
+    if (!m_workerDeferred)
+        this->setPagination(records, pixelLength, pageCount, totalTime, totalPageLength1_8);
+
+    this->resetSyncCounter();
+}
+
+void ScreenplayPaginator::setPagination(const QList<ScreenplayPaginatorRecord> &records,
+                                        qreal pixelLength, int pageCount, const QTime &totalTime,
+                                        const QString &totalPageLength1_8)
 {
     m_records = records;
     m_pageCount = pageCount;
@@ -755,8 +816,67 @@ void ScreenplayPaginator::onPaginationComplete(const QList<ScreenplayPaginatorRe
     }
 
     emit paginationUpdated();
+}
 
-    this->resetSyncCounter();
+QJsonObject ScreenplayPaginator::formatJson() const
+{
+    const ScreenplayFormat *format =
+            m_format == nullptr ? ScriteDocument::instance()->printFormat() : m_format;
+    return QObjectSerializer::toJson(format);
+}
+
+bool ScreenplayPaginator::usePaginationCache(const QList<SceneContent> &screenplayContent)
+{
+    if (m_screenplay == nullptr || screenplayContent.isEmpty())
+        return false;
+
+    const QByteArray key = ScreenplayPaginationCache::key(this->formatJson(), screenplayContent);
+
+    ScreenplayPaginationCache::Result result;
+    if (!ScreenplayPaginationCache::load(key, result))
+        return false;
+
+    m_workerDeferred = true;
+    this->setPagination(result.records, result.pixelLength, result.pageCount, result.totalTime,
+                        result.totalPageLength1_8);
+    return true;
+}
+
+void ScreenplayPaginator::savePaginationCache()
+{
+    // Only results that are known to be current for the screenplay, as it is
+    // right now, can be saved. Paginators of temporary screenplays, like those
+    // of scene groups, are left out so that they don't crowd out the document's.
+    if (!m_enabled || m_workerDeferred || m_records.isEmpty() || this->isSyncing()
+        || this->isBusy())
+        return;
+
+    if (m_screenplay == nullptr || m_screenplay != ScriteDocument::instance()->screenplay())
+        return;
+
+    const QList<SceneContent> screenplayContent = SceneContent::fromScreenplay(m_screenplay);
+    const QByteArray key = ScreenplayPaginationCache::key(this->formatJson(), screenplayContent);
+
+    ScreenplayPaginationCache::Result result;
+    result.records = m_records;
+    result.pixelLength = m_totalPixelLength;
+    result.pageCount = m_pageCount;
+    result.totalTime = m_totalTime;
+    result.totalPageLength1_8 = m_totalPageLength1_8;
+    ScreenplayPaginationCache::save(key, result);
+}
+
+bool ScreenplayPaginator::primeDeferredWorker()
+{
+    if (!m_workerDeferred || !m_enabled)
+        return false;
+
+    // The worker gets the screenplay as it is now, which already includes whatever
+    // change is causing it to be primed. So callers must not forward that change again.
+    m_workerDeferred = false;
+    this->incrementSyncCounter();
+    m_workerNode->reset(SceneContent::fromScreenplay(m_screenplay));
+    return true;
 }
 
 bool ScreenplayPaginator::aggregate(ScreenplayElement *from, ScreenplayElement *until,
@@ -17,6 +17,7 @@
 #define SCREENPLAYPAGINATOR_H
 
 #include <QQmlEngine>
+#include <QJsonObject>
 #include <QTextDocument>
 
 #include "screenplay.h"
@@ -165,6 +166,7 @@ Q_DECLARE_METATYPE(ScreenplayPaginatorRecord)
 Q_DECLARE_METATYPE(QList<ScreenplayPaginatorRecord>)
 
 class QThread;
+struct SceneContent;
 class ScreenplayPaginatorWorker;
 class ScreenplayPaginatorWorkerNode;
 class ScreenplayPaginator : public QObject, public QQmlParserStatus
@@ -350,6 +352,7 @@ private:
     void resetSyncCounter();
 
     void onFormatChanged();
+    void onFormatRevisionChanged(int revision, const QList<int> &changes);
 
     void onScreenplayReset();
     void onScreenplayDestroyed();
@@ -371,6 +374,13 @@ private:
     void onPaginationComplete(const QList<ScreenplayPaginatorRecord> &items, qreal pixelLength,
                               int pageCount, const QTime &totalTime,
                               const QString &totalPageLength1_8);
+    void setPagination(const QList<ScreenplayPaginatorRecord> &items, qreal pixelLength,
+                       int pageCount, const QTime &totalTime, const QString &totalPageLength1_8);
+
+    QJsonObject formatJson() const;
+    bool usePaginationCache(const QList<SceneContent> &screenplayContent);
+    void savePaginationCache();
+    bool primeDeferredWorker();
 
     bool aggregate(ScreenplayElement *from, ScreenplayElement *until, qreal *pixelLength,
                    qreal *pageLength, QTime *timeLength) const;
@@ -396,6 +406,10 @@ private:
     Screenplay *m_screenplay = nullptr;
     ScreenplayFormat *m_format = nullptr;
 
+    // Set when pagination was restored from ScreenplayPaginationCache, in which case
+    // the worker is handed the screenplay only when it's needed for the first time.
+    bool m_workerDeferred = false;
+
     QThread *m_workerThread = nullptr;
     ScreenplayPaginatorWorker *m_worker = nullptr;
     ScreenplayPaginatorWorkerNode *m_workerNode = nullptr;
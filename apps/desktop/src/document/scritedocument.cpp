@@ -801,6 +801,10 @@ ScriteDocument::ScriteDocument(QObject *parent)
     connect(qApp, &QApplication::aboutToQuit, this, [=]() {
         if (m_autoSave && !m_fileName.isEmpty())
             this->save();
+
+        // Edits not saved by now were discarded by the user, so they must not be
+        // recovered the next time this document is opened.
+        m_journal.end(true);
     });
 
     this->initializeFileModificationTracker();
@@ -1270,10 +1274,18 @@ void ScriteDocument::reset()
     if (m_autoSave && !m_fileName.isEmpty())
         this->save();
 
+    m_journal.end(true);
+    m_journalId.clear();
+    m_autoSaveTickCount = 0;
+    m_recoveredFromJournal = false;
+
     emit aboutToReset();
 
     m_connectors.clear();
 
+    while (!m_outsideJournalConnections.isEmpty())
+        disconnect(m_outsideJournalConnections.takeFirst());
+
     if (m_structure != nullptr) {
         disconnect(m_structure, &Structure::currentElementIndexChanged, this,
                    &ScriteDocument::structureElementIndexChanged);
@@ -1391,6 +1403,48 @@ void ScriteDocument::reset()
     connect(m_formatting, &ScreenplayFormat::formatChanged, this, &ScriteDocument::markAsModified);
     connect(m_printFormat, &ScreenplayFormat::formatChanged, this, &ScriteDocument::markAsModified);
 
+    // Edits to the structure and screenplay that the journal doesn't record. Changes to
+    // zoom level and current element are left out, because they are not worth a full save.
+    const QList<void (Structure::*)()> structureSignals = {
+        &Structure::charactersModified,
+        &Structure::characterCountChanged,
+        &Structure::characterRelationshipGraphChanged,
+        &Structure::annotationsModified,
+        &Structure::annotationCountChanged,
+        &Structure::groupsDataChanged,
+        &Structure::preferredGroupCategoryChanged,
+    };
+    for (void (Structure::*structureSignal)() : structureSignals)
+        m_outsideJournalConnections << connect(m_structure, structureSignal, this,
+                                               &ScriteDocument::markAsModifiedOutsideJournal);
+    m_outsideJournalConnections << connect(m_structure->attachments(),
+                                           &Attachments::attachmentsModified, this,
+                                           &ScriteDocument::markAsModifiedOutsideJournal);
+
+    const QList<void (Screenplay::*)()> screenplaySignals = {
+        &Screenplay::titleChanged,
+        &Screenplay::subtitleChanged,
+        &Screenplay::loglineChanged,
+        &Screenplay::loglineCommentsChanged,
+        &Screenplay::basedOnChanged,
+        &Screenplay::authorChanged,
+        &Screenplay::contactChanged,
+        &Screenplay::addressChanged,
+        &Screenplay::phoneNumberChanged,
+        &Screenplay::emailChanged,
+        &Screenplay::websiteChanged,
+        &Screenplay::versionChanged,
+        &Screenplay::coverPagePhotoChanged,
+        &Screenplay::coverPagePhotoSizeChanged,
+        &Screenplay::titlePageIsCenteredChanged,
+        &Screenplay::restartEpisodeScenesAtOneChanged,
+    };
+    for (void (Screenplay::*screenplaySignal)() : screenplaySignals)
+        m_outsideJournalConnections << connect(m_screenplay, screenplaySignal, this,
+                                               &ScriteDocument::markAsModifiedOutsideJournal);
+
+    m_modifiedOutsideJournal = false;
+
     emit justReset();
 
     ExecLaterTimer::call(
@@ -1566,6 +1620,13 @@ void ScriteDocument::saveAs(const QString &givenFileName)
 
     emit aboutToSave();
 
+    // Each full save is identified by a unique journal-id, so that journal records can be
+    // matched with the full save on top of which they were made.
+    const QString previousJournalId = m_journalId;
+    m_journalId = QUuid::createUuid().toString();
+    m_journal.beginSnapshot();
+    m_modifiedOutsideJournal = false;
+
     const QJsonObject json = QObjectSerializer::toJson(this);
     const QByteArray bytes = QJsonDocument(json).toJson();
     m_docFileSystem.setHeader(bytes);
@@ -1584,16 +1645,19 @@ void ScriteDocument::saveAs(const QString &givenFileName)
     }
 
     if (m_autoSaveMode) {
+        const QString journalId = m_journalId;
         QObject *autoSaveContext = new QObject(this);
         connect(&m_docFileSystem, &DocumentFileSystem::saveFinished, autoSaveContext,
                 [=](bool success) {
                     autoSaveContext->deleteLater();
                     if (!success) {
                         m_errorReport->setErrorMessage(QStringLiteral("Auto Save Failed."));
+                        this->abortJournalSnapshot(journalId, previousJournalId);
 
                         m_modified = true;
                         emit modifiedChanged();
-                    }
+                    } else
+                        this->commitJournalSnapshot(fileName, journalId);
 
                     emit justSaved();
 
@@ -1610,6 +1674,7 @@ void ScriteDocument::saveAs(const QString &givenFileName)
         if (!success) {
             m_errorReport->setErrorMessage(QStringLiteral("Couldn't save document \"") + fileName
                                            + QStringLiteral("\""));
+            this->abortJournalSnapshot(m_journalId, previousJournalId);
             emit justSaved();
             m_progressReport->finish();
             this->clearBusyMessage();
@@ -1618,6 +1683,7 @@ void ScriteDocument::saveAs(const QString &givenFileName)
 
         this->setFileName(fileName);
         this->setCreatedOnThisComputer(true);
+        this->commitJournalSnapshot(fileName, m_journalId);
 
         emit justSaved();
 
@@ -2203,6 +2269,19 @@ void ScriteDocument::timerEvent(QTimerEvent *event)
 
     if (event->timerId() == m_autoSaveTimer.timerId()) {
         if (m_modified && !m_fileName.isEmpty() && QFileInfo(m_fileName).isWritable()) {
+            // While edits are being journaled, they are already safe on disk. So the
+            // journal is compacted into a full save only once in a while, or when it
+            // has grown large enough to slow down recovery. Edits the journal doesn't
+            // record are saved in full right away.
+            if (m_journal.isActive()) {
+                m_journal.flush();
+                if (!m_modifiedOutsideJournal && ++m_autoSaveTickCount < 10
+                    && m_journal.size() < 4 * 1024 * 1024)
+                    return;
+            }
+
+            m_autoSaveTickCount = 0;
+
             QScopedValueRollback<bool> autoSave(m_autoSaveMode, true);
             this->save();
         }
@@ -2211,13 +2290,41 @@ void ScriteDocument::timerEvent(QTimerEvent *event)
 
     if (event->timerId() == m_clearModifyTimer.timerId()) {
         m_clearModifyTimer.stop();
-        this->setModified(false);
+
+        // Edits recovered from the journal are yet to be saved in full.
+        this->setModified(m_recoveredFromJournal);
+        m_recoveredFromJournal = false;
+        m_modifiedOutsideJournal = false;
         return;
     }
 
     QObject::timerEvent(event);
 }
 
+void ScriteDocument::commitJournalSnapshot(const QString &fileName, const QString &journalId)
+{
+    // Another save may have begun by the time a non-blocking save finishes.
+    if (journalId != m_journalId)
+        return;
+
+    if (m_journal.isActive())
+        m_journal.commitSnapshot(fileName, journalId);
+    else
+        m_journal.begin(this, fileName, journalId);
+}
+
+void ScriteDocument::abortJournalSnapshot(const QString &journalId,
+                                          const QString &previousJournalId)
+{
+    if (journalId != m_journalId)
+        return;
+
+    // The journal on disk continues to apply to the last successful save.
+    m_journalId = previousJournalId;
+    m_journal.abortSnapshot();
+    m_modifiedOutsideJournal = true;
+}
+
 bool ScriteDocument::runSaveSanityChecks(const QString &givenFileName)
 {
     const QString fileName = givenFileName.trimmed();
@@ -2457,10 +2564,21 @@ void ScriteDocument::evaluateStructureElementSequenceLater()
 
 void ScriteDocument::markAsModified()
 {
+    // Only some of the edits to structure and screenplay are journaled. Those that aren't
+    // are tracked in markAsModifiedOutsideJournal().
+    QObject *source = this->sender();
+    if (source == nullptr || (source != m_structure && source != m_screenplay))
+        m_modifiedOutsideJournal = true;
+
     this->setModified(m_loading ? true : !this->isEmpty());
     emit documentChanged();
 }
 
+void ScriteDocument::markAsModifiedOutsideJournal()
+{
+    m_modifiedOutsideJournal = true;
+}
+
 void ScriteDocument::setModified(bool val)
 {
     if (m_readOnly)
@@ -2636,6 +2754,32 @@ bool ScriteDocument::load(const QString &fileName, bool anonymousLoad)
     loadCleanup.begin();
 
     const bool ret = QObjectSerializer::fromJson(json, this);
+
+    if (!ro && !anonymousLoad) {
+        // Scrite may have crashed after edits were made to this document since it was last
+        // saved in full. Such edits would have been journaled, and can be recovered now.
+        const int nrRecovered = DocumentJournal::replay(this, fileName, m_journalId);
+        if (nrRecovered > 0) {
+            m_recoveredFromJournal = true;
+
+            Notification *notification = new Notification(this);
+            connect(notification, &Notification::dismissed, &Notification::deleteLater);
+
+            notification->setTitle(QStringLiteral("Recovered unsaved changes"));
+            notification->setText(
+                    QStringLiteral("Scrite did not shut down properly the last time this "
+                                   "document was open. Changes made to it since it was last "
+                                   "saved have been recovered."));
+            notification->setAutoClose(false);
+            notification->setActive(true);
+        }
+
+        // Documents saved by older versions of Scrite don't have a journal-id. Journaling
+        // for them begins after their first full save.
+        if (!m_journalId.isEmpty())
+            m_journal.begin(this, fileName, m_journalId);
+    }
+
     if (m_screenplay->currentElementIndex() == 0)
         m_screenplay->setCurrentElementIndex(-1);
 
@@ -2846,6 +2990,7 @@ void ScriteDocument::serializeToJson(QJsonObject &json) const
 {
     json.insert(QStringLiteral("collaborators"), QJsonValue::fromVariant(m_collaborators));
     json.insert(QStringLiteral("documentId"), m_documentId);
+    json.insert(QStringLiteral("journalId"), m_journalId);
 
     QJsonObject metaInfo;
     metaInfo.insert(QStringLiteral("appName"), qApp->applicationName());
@@ -2907,6 +3052,8 @@ void ScriteDocument::deserializeFromJson(const QJsonObject &json)
         m_documentId = storedDocumentId;
     emit documentIdChanged();
 
+    m_journalId = json.value(QStringLiteral("journalId")).toString();
+
     const QJsonObject metaInfo = json.value(QStringLiteral("meta")).toObject();
     const QJsonObject systemInfo = metaInfo.value(QStringLiteral("system")).toObject();
 
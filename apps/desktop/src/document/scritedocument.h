@@ -28,6 +28,7 @@
 #include "qobjectproperty.h"
 #include "qobjectserializer.h"
 #include "documentfilesystem.h"
+#include "documentjournal.h"
 
 class Forms;
 class FileLocker;
@@ -919,6 +920,8 @@ protected:
 
 private:
     bool runSaveSanityChecks(const QString &fileName);
+    void commitJournalSnapshot(const QString &fileName, const QString &journalId);
+    void abortJournalSnapshot(const QString &journalId, const QString &previousJournalId);
     void setReadOnly(bool val);
     void setLoading(bool val);
     void prepareAutoSave();
@@ -933,6 +936,7 @@ private:
     void evaluateStructureElementSequence();
     void evaluateStructureElementSequenceLater();
     void markAsModified();
+    void markAsModifiedOutsideJournal();
     void setModified(bool val);
     void setFileName(const QString &val);
     bool load(const QString &fileName, bool anonymousLoad = false);
@@ -1006,6 +1010,13 @@ private:
 
     ErrorReport *m_errorReport = new ErrorReport(this);
     ProgressReport *m_progressReport = new ProgressReport(this);
+
+    QString m_journalId;
+    int m_autoSaveTickCount = 0;
+    bool m_modifiedOutsideJournal = false;
+    QList<QMetaObject::Connection> m_outsideJournalConnections;
+    bool m_recoveredFromJournal = false;
+    DocumentJournal m_journal;
 };
 
 #endif // SCRITEDOCUMENT_H
@@ -14,6 +14,7 @@
 ****************************************************************************/
 
 #include "documentfilesystem.h"
+#include "thumbnailcache.h"
 #include "scritefileinfo.h"
 #include "screenplay.h"
 #include "utils.h"
@@ -145,7 +146,7 @@ ScriteFileInfo ScriteFileInfo::load(const QFileInfo &fileInfo)
 
     const QString coverPagePath = dfs.absolutePath(Screenplay::standardCoverPathPhotoPath());
     ret.coverPageImage = QFile::exists(coverPagePath)
-            ? QImage(coverPagePath).scaled(512, 512, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+            ? ThumbnailCache::load(coverPagePath, QSize(512, 512))
             : QImage();
     ret.hasCoverPage = !ret.coverPageImage.isNull();
 
@@ -19,12 +19,15 @@
 #include "fountain.h"
 #include "structure.h"
 #include "hourglass.h"
+#include "stringpool.h"
+#include "thumbnailcache.h"
 #include "filemanager.h"
 #include "application.h"
 #include "deltadocument.h"
 #include "languageengine.h"
 #include "scritedocument.h"
 #include "garbagecollector.h"
+#include "parentchangenotifier.h"
 #include "structureexporter.h"
 #include "screenplaytextdocument.h"
 
@@ -1178,6 +1181,7 @@ Character::Character(QObject *parent)
     connect(this, &Character::photosChanged, this, [=]() {
         const int min = m_photos.isEmpty() ? -1 : 0;
         this->setKeyPhotoIndex(qBound(min, m_keyPhotoIndex, m_photos.size() - 1));
+        ScriteDocument::instance()->fileSystem()->setClaims(this, m_photos);
     });
 
     if (m_structure) {
@@ -1246,6 +1250,7 @@ bool Character::rename(const QString &givenName)
 
                 // Merge photos
                 mergeWith->m_photos += m_photos;
+                emit mergeWith->photosChanged();
 
                 // Create summary of this character as a note in the merged character
                 const QString newLine = QStringLiteral("\n");
@@ -1499,7 +1504,7 @@ void Character::setTags(const QStringList &val)
 
     m_tags = val;
     for (int i = m_tags.size() - 1; i >= 0; i--) {
-        m_tags[i] = m_tags[i].trimmed();
+        m_tags[i] = StringPool::interned(m_tags[i].trimmed());
         if (m_tags[i].isEmpty())
             m_tags.removeAt(i);
     }
@@ -1609,11 +1614,15 @@ void Character::setRelationships(const QList<Relationship *> &list)
     if (!m_relationships.isEmpty() || list.isEmpty())
         return;
 
-    for (Relationship *ptr : list) {
-        ptr->setParent(this);
+    {
+        ParentChangeBatch parentChangeBatch;
+        for (Relationship *ptr : list) {
+            ptr->setParent(this);
 
-        connect(ptr, &Relationship::aboutToDelete, this, &Character::removeRelationship);
-        connect(ptr, &Relationship::relationshipChanged, this, &Character::characterChanged);
+            connect(ptr, &Relationship::aboutToDelete, this, &Character::removeRelationship);
+            connect(ptr, &Relationship::relationshipChanged, this,
+                    &Character::characterChanged);
+        }
     }
 
     m_relationships.assign(list);
@@ -2358,6 +2367,8 @@ Annotation::Annotation(QObject *parent)
     connect(this, &Annotation::typeChanged, this, &Annotation::annotationChanged);
     connect(this, &Annotation::geometryChanged, this, &Annotation::annotationChanged);
     connect(this, &Annotation::attributesChanged, this, &Annotation::annotationChanged);
+    connect(this, &Annotation::metaDataChanged, this, &Annotation::updateDfsClaims);
+    connect(this, &Annotation::attributesChanged, this, &Annotation::updateDfsClaims);
 
     DocumentFileSystem *dfs = ScriteDocument::instance()->fileSystem();
     connect(dfs, &DocumentFileSystem::auction, this, &Annotation::onDfsAuction);
@@ -2612,6 +2623,16 @@ void Annotation::polishAttributes()
         emit attributesChanged();
 }
 
+void Annotation::updateDfsClaims()
+{
+    QStringList filePaths;
+    filePaths.reserve(m_fileAttributes.size());
+    for (const QString &fileAttr : std::as_const(m_fileAttributes))
+        filePaths.append(m_attributes.value(fileAttr).toString());
+
+    ScriteDocument::instance()->fileSystem()->setClaims(this, filePaths);
+}
+
 void Annotation::onDfsAuction(const QString &filePath, int *claims)
 {
     if (m_fileAttributes.isEmpty() || !filePath.startsWith(QStringLiteral("annotation/")))
@@ -2637,6 +2658,8 @@ Structure::Structure(QObject *parent)
     connect(this, &Structure::elementCountChanged, this, &Structure::structureChanged);
     connect(this, &Structure::characterCountChanged, this, &Structure::structureChanged);
     connect(this, &Structure::annotationCountChanged, this, &Structure::structureChanged);
+    connect(this, &Structure::charactersModified, this, &Structure::structureChanged);
+    connect(this, &Structure::annotationsModified, this, &Structure::structureChanged);
     connect(this, &Structure::currentElementIndexChanged, this, &Structure::structureChanged);
     connect(this, &Structure::preferredGroupCategoryChanged, this, &Structure::structureChanged);
     connect(m_attachments, &Attachments::attachmentsModified, this, &Structure::structureChanged);
@@ -2650,23 +2673,28 @@ Structure::Structure(QObject *parent)
     QTimer::singleShot(0, this, &Structure::onClipboardDataChanged);
 
     m_elementsBoundingBoxAggregator.setModel(&m_elements);
-    m_elementsBoundingBoxAggregator.setAggregateFunction(
-            [=](const QModelIndex &index, QVariant &value) {
-                QRectF rect = value.toRectF();
-                const StructureElement *element = m_elements.at(index.row());
-                rect |= element->geometry();
-                value = rect;
+    m_elementsBoundingBoxAggregator.setReducer(
+            ModelAggregator::UnitedRectReducer, [=](const QModelIndex &index) -> QVariant {
+                return m_elements.at(index.row())->geometry();
             });
     connect(&m_elementsBoundingBoxAggregator, &ModelAggregator::aggregateValueChanged, this,
             &Structure::elementsBoundingBoxChanged);
 
+    connect(&m_elements, &QAbstractItemModel::rowsInserted, this,
+            &Structure::markElementIndexesDirty);
+    connect(&m_elements, &QAbstractItemModel::rowsRemoved, this,
+            &Structure::markElementIndexesDirty);
+    connect(&m_elements, &QAbstractItemModel::rowsMoved, this,
+            &Structure::markElementIndexesDirty);
+    connect(&m_elements, &QAbstractItemModel::modelReset, this,
+            &Structure::markElementIndexesDirty);
+    connect(&m_elements, &QAbstractItemModel::layoutChanged, this,
+            &Structure::markElementIndexesDirty);
+
     m_annotationsBoundingBoxAggregator.setModel(&m_annotations);
-    m_annotationsBoundingBoxAggregator.setAggregateFunction(
-            [=](const QModelIndex &index, QVariant &value) {
-                QRectF rect = value.toRectF();
-                const Annotation *annot = m_annotations.at(index.row());
-                rect |= annot->geometry();
-                value = rect;
+    m_annotationsBoundingBoxAggregator.setReducer(
+            ModelAggregator::UnitedRectReducer, [=](const QModelIndex &index) -> QVariant {
+                return m_annotations.at(index.row())->geometry();
             });
     connect(&m_annotationsBoundingBoxAggregator, &ModelAggregator::aggregateValueChanged, this,
             &Structure::annotationsBoundingBoxChanged);
@@ -2799,7 +2827,7 @@ void Structure::addCharacter(Character *ptr)
     ptr->setParent(this);
 
     connect(ptr, &Character::aboutToDelete, this, &Structure::removeCharacter);
-    connect(ptr, &Character::characterChanged, this, &Structure::structureChanged);
+    connect(ptr, &Character::characterChanged, this, &Structure::charactersModified);
 
     m_characters.append(ptr);
     emit characterCountChanged();
@@ -2819,7 +2847,7 @@ void Structure::removeCharacter(Character *ptr)
     m_characters.removeAt(index);
 
     disconnect(ptr, &Character::aboutToDelete, this, &Structure::removeCharacter);
-    disconnect(ptr, &Character::characterChanged, this, &Structure::structureChanged);
+    disconnect(ptr, &Character::characterChanged, this, &Structure::charactersModified);
 
     emit characterCountChanged();
 
@@ -2851,16 +2879,19 @@ void Structure::setCharacters(const QList<Character *> &list)
     QList<Character *> list2;
     list2.reserve(list.size());
 
-    for (Character *ptr : list) {
-        if (!ptr->isValid() || this->findCharacter(ptr->name()) != nullptr) {
-            GarbageCollector::instance()->add(ptr);
-            continue;
-        }
+    {
+        ParentChangeBatch parentChangeBatch;
+        for (Character *ptr : list) {
+            if (!ptr->isValid() || this->findCharacter(ptr->name()) != nullptr) {
+                GarbageCollector::instance()->add(ptr);
+                continue;
+            }
 
-        ptr->setParent(this);
-        connect(ptr, &Character::aboutToDelete, this, &Structure::removeCharacter);
-        connect(ptr, &Character::characterChanged, this, &Structure::structureChanged);
-        list2.append(ptr);
+            ptr->setParent(this);
+            connect(ptr, &Character::aboutToDelete, this, &Structure::removeCharacter);
+            connect(ptr, &Character::characterChanged, this, &Structure::charactersModified);
+            list2.append(ptr);
+        }
     }
 
     m_characters.assign(list2);
@@ -3002,6 +3033,10 @@ void Structure::insertElement(StructureElement *ptr, int index)
                 ptr, this, "elements", ObjectList::InsertOperation, methods));
     }
 
+    // Index the element before it shows up in the model, so that viewport filters
+    // reacting to row insertion can find it.
+    m_elementsSpatialIndex.insert(ptr, ptr->geometry());
+
     if (index < 0 || index >= m_elements.size())
         m_elements.append(ptr);
     else
@@ -3009,6 +3044,7 @@ void Structure::insertElement(StructureElement *ptr, int index)
 
     ptr->setParent(this);
 
+    connect(ptr, &StructureElement::geometryChanged, this, &Structure::updateElementSpatialIndex);
     connect(ptr, &StructureElement::elementChanged, this, &Structure::structureChanged);
     connect(ptr, &StructureElement::aboutToDelete, this, &Structure::removeElement);
     connect(ptr, &StructureElement::sceneLocationChanged, this,
@@ -3060,7 +3096,10 @@ void Structure::setElements(const QList<StructureElement *> &list)
 
     for (StructureElement *element : list) {
         element->setParent(this);
+        m_elementsSpatialIndex.insert(element, element->geometry());
 
+        connect(element, &StructureElement::geometryChanged, this,
+                &Structure::updateElementSpatialIndex);
         connect(element, &StructureElement::elementChanged, this, &Structure::structureChanged);
         connect(element, &StructureElement::aboutToDelete, this, &Structure::removeElement);
         connect(element, &StructureElement::sceneLocationChanged, this,
@@ -3112,6 +3151,35 @@ int Structure::indexOfElement(StructureElement *element) const
     return m_elements.indexOf(element);
 }
 
+QList<int> Structure::elementIndexesIn(const QRectF &rect) const
+{
+    // Returns indexes of elements that are likely to overlap rect, in ascending
+    // order. Callers are expected to apply their own precise hit-test on these.
+    QList<int> ret;
+
+    const QList<const QObject *> candidates = m_elementsSpatialIndex.candidates(rect);
+    if (candidates.isEmpty())
+        return ret;
+
+    if (m_elementIndexesDirty) {
+        m_elementIndexes.clear();
+        m_elementIndexes.reserve(m_elements.size());
+        for (int i = 0; i < m_elements.size(); i++)
+            m_elementIndexes.insert(m_elements.at(i), i);
+        m_elementIndexesDirty = false;
+    }
+
+    ret.reserve(candidates.size());
+    for (const QObject *candidate : candidates) {
+        const int index = m_elementIndexes.value(candidate, -1);
+        if (index >= 0)
+            ret.append(index);
+    }
+
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
 StructureElement *Structure::findElementBySceneID(const QString &id) const
 {
     if (id.isEmpty())
@@ -3758,7 +3826,10 @@ bool Structure::removeElementInternal(StructureElement *ptr)
         emit ptr->scene()->aboutToRemoveScene(ptr->scene());
 
     m_elements.removeAt(index);
+    m_elementsSpatialIndex.remove(ptr);
 
+    disconnect(ptr, &StructureElement::geometryChanged, this,
+               &Structure::updateElementSpatialIndex);
     disconnect(ptr, &StructureElement::elementChanged, this, &Structure::structureChanged);
     disconnect(ptr, &StructureElement::aboutToDelete, this, &Structure::removeElement);
     disconnect(ptr, &StructureElement::sceneLocationChanged, this,
@@ -3977,11 +4048,13 @@ void Structure::addAnnotation(Annotation *ptr)
                 ptr, this, info->property, ObjectList::InsertOperation, methods));
     }
 
+    m_annotationsSpatialIndex.insert(ptr, ptr->geometry());
     m_annotations.append(ptr);
 
     ptr->setParent(this);
+    connect(ptr, &Annotation::geometryChanged, this, &Structure::updateAnnotationSpatialIndex);
     connect(ptr, &Annotation::aboutToDelete, this, &Structure::removeAnnotation);
-    connect(ptr, &Annotation::annotationChanged, this, &Structure::structureChanged);
+    connect(ptr, &Annotation::annotationChanged, this, &Structure::annotationsModified);
     connect(ptr, &Annotation::geometryChanged, &m_annotations,
             &QObjectListModel<Annotation *>::objectChanged);
     connect(ptr, &Annotation::aboutToDelete, &m_annotations,
@@ -4010,9 +4083,11 @@ void Structure::removeAnnotation(Annotation *ptr)
     }
 
     m_annotations.removeAt(index);
+    m_annotationsSpatialIndex.remove(ptr);
 
+    disconnect(ptr, &Annotation::geometryChanged, this, &Structure::updateAnnotationSpatialIndex);
     disconnect(ptr, &Annotation::aboutToDelete, this, &Structure::removeAnnotation);
-    disconnect(ptr, &Annotation::annotationChanged, this, &Structure::structureChanged);
+    disconnect(ptr, &Annotation::annotationChanged, this, &Structure::annotationsModified);
     disconnect(ptr, &Annotation::geometryChanged, &m_annotations,
                &QObjectListModel<Annotation *>::objectChanged);
     disconnect(ptr, &Annotation::aboutToDelete, &m_annotations,
@@ -4086,14 +4161,20 @@ void Structure::setAnnotations(const QList<Annotation *> &list)
     // is only called as a part of loading the Structure. What's the point in
     // undoing a Structure loaded from file.
 
-    for (Annotation *ptr : list) {
-        ptr->setParent(this);
-        connect(ptr, &Annotation::aboutToDelete, this, &Structure::removeAnnotation);
-        connect(ptr, &Annotation::annotationChanged, this, &Structure::structureChanged);
-        connect(ptr, &Annotation::geometryChanged, &m_annotations,
-                &QObjectListModel<Annotation *>::objectChanged);
-        connect(ptr, &Annotation::aboutToDelete, &m_annotations,
-                &QObjectListModel<Annotation *>::objectDestroyed);
+    {
+        ParentChangeBatch parentChangeBatch;
+        for (Annotation *ptr : list) {
+            ptr->setParent(this);
+            m_annotationsSpatialIndex.insert(ptr, ptr->geometry());
+            connect(ptr, &Annotation::geometryChanged, this,
+                    &Structure::updateAnnotationSpatialIndex);
+            connect(ptr, &Annotation::aboutToDelete, this, &Structure::removeAnnotation);
+            connect(ptr, &Annotation::annotationChanged, this, &Structure::annotationsModified);
+            connect(ptr, &Annotation::geometryChanged, &m_annotations,
+                    &QObjectListModel<Annotation *>::objectChanged);
+            connect(ptr, &Annotation::aboutToDelete, &m_annotations,
+                    &QObjectListModel<Annotation *>::objectDestroyed);
+        }
     }
 
     m_annotations.assign(list);
@@ -4753,12 +4834,31 @@ QRectF Structure::calculatePerimeterAnnotationPosition(const QRectF &newAnnotati
     const qreal newAnnotationHeight = newAnnotationGeometry.height();
 
     auto checkOverlapWithExisting = [this](const QRectF &rect) {
-        for (int i = 0; i < m_annotations.size(); ++i) {
-            Annotation *annotation = m_annotations.at(i);
-            if (annotation && annotation->geometry().intersects(rect))
-                return true;
+        return m_annotationsSpatialIndex.intersects(rect);
+    };
+
+    // Only annotations lying in the strip beyond an edge affect placement along that
+    // edge. Query the spatial index for that strip instead of walking all annotations;
+    // the exact predicate is still applied on each candidate.
+    const QRectF indexBounds = m_annotationsSpatialIndex.boundingRect();
+    auto annotationsInStrip = [&](qreal left, qreal top, qreal right,
+                                  qreal bottom) -> QList<const Annotation *> {
+        QList<const Annotation *> ret;
+        left = qMax(left, indexBounds.left());
+        top = qMax(top, indexBounds.top());
+        right = qMin(right, indexBounds.right());
+        bottom = qMin(bottom, indexBounds.bottom());
+        if (left > right || top > bottom)
+            return ret;
+
+        const QRectF strip(QPointF(left, top), QPointF(right, bottom));
+        const QList<const QObject *> candidates = m_annotationsSpatialIndex.candidates(strip);
+        for (const QObject *candidate : candidates) {
+            const Annotation *annotation = qobject_cast<const Annotation *>(candidate);
+            if (annotation)
+                ret.append(annotation);
         }
-        return false;
+        return ret;
     };
 
     auto tryPlaceOnEdge = [&](const QString &edge) -> QRectF {
@@ -4768,13 +4868,12 @@ QRectF Structure::calculatePerimeterAnnotationPosition(const QRectF &newAnnotati
             qreal x = elementsBBox.left() - offsetDistance - newAnnotationWidth;
             qreal y = elementsBBox.top();
 
-            for (int i = 0; i < m_annotations.size(); ++i) {
-                Annotation *annotation = m_annotations.at(i);
-                if (!annotation)
-                    continue;
-
+            const qreal edgeX = elementsBBox.left() - offsetDistance;
+            const QList<const Annotation *> annotations = annotationsInStrip(
+                    indexBounds.left(), indexBounds.top(), edgeX, indexBounds.bottom());
+            for (const Annotation *annotation : annotations) {
                 const QRectF annGeom = annotation->geometry();
-                if (annGeom.left() <= elementsBBox.left() - offsetDistance) {
+                if (annGeom.left() <= edgeX) {
                     qreal bottomY = annGeom.bottom() + gapBetweenAnnotations;
                     if (bottomY > y)
                         y = bottomY;
@@ -4790,13 +4889,12 @@ QRectF Structure::calculatePerimeterAnnotationPosition(const QRectF &newAnnotati
             qreal x = elementsBBox.left();
             qreal y = elementsBBox.bottom() + offsetDistance;
 
-            for (int i = 0; i < m_annotations.size(); ++i) {
-                Annotation *annotation = m_annotations.at(i);
-                if (!annotation)
-                    continue;
-
+            const qreal edgeY = elementsBBox.bottom() + offsetDistance;
+            const QList<const Annotation *> annotations = annotationsInStrip(
+                    indexBounds.left(), edgeY, indexBounds.right(), indexBounds.bottom());
+            for (const Annotation *annotation : annotations) {
                 const QRectF annGeom = annotation->geometry();
-                if (annGeom.top() >= elementsBBox.bottom() + offsetDistance) {
+                if (annGeom.top() >= edgeY) {
                     qreal rightX = annGeom.right() + gapBetweenAnnotations;
                     if (rightX > x)
                         x = rightX;
@@ -4812,13 +4910,12 @@ QRectF Structure::calculatePerimeterAnnotationPosition(const QRectF &newAnnotati
             qreal x = elementsBBox.right() + offsetDistance;
             qreal y = elementsBBox.top();
 
-            for (int i = 0; i < m_annotations.size(); ++i) {
-                Annotation *annotation = m_annotations.at(i);
-                if (!annotation)
-                    continue;
-
+            const qreal edgeX = elementsBBox.right() + offsetDistance;
+            const QList<const Annotation *> annotations = annotationsInStrip(
+                    edgeX, indexBounds.top(), indexBounds.right(), indexBounds.bottom());
+            for (const Annotation *annotation : annotations) {
                 const QRectF annGeom = annotation->geometry();
-                if (annGeom.left() >= elementsBBox.right() + offsetDistance) {
+                if (annGeom.left() >= edgeX) {
                     qreal bottomY = annGeom.bottom() + gapBetweenAnnotations;
                     if (bottomY > y)
                         y = bottomY;
@@ -4832,13 +4929,12 @@ QRectF Structure::calculatePerimeterAnnotationPosition(const QRectF &newAnnotati
             qreal x = elementsBBox.left();
             qreal y = elementsBBox.top() - offsetDistance - newAnnotationHeight;
 
-            for (int i = 0; i < m_annotations.size(); ++i) {
-                Annotation *annotation = m_annotations.at(i);
-                if (!annotation)
-                    continue;
-
+            const qreal edgeY = elementsBBox.top() - offsetDistance;
+            const QList<const Annotation *> annotations = annotationsInStrip(
+                    indexBounds.left(), indexBounds.top(), indexBounds.right(), edgeY);
+            for (const Annotation *annotation : annotations) {
                 const QRectF annGeom = annotation->geometry();
-                if (annGeom.bottom() <= elementsBBox.top() - offsetDistance) {
+                if (annGeom.bottom() <= edgeY) {
                     qreal rightX = annGeom.right() + gapBetweenAnnotations;
                     if (rightX > x)
                         x = rightX;
@@ -5279,6 +5375,20 @@ void Structure::updateLocationHeadingMap()
     m_locationHeadingsMap = map;
 }
 
+void Structure::updateElementSpatialIndex()
+{
+    StructureElement *element = qobject_cast<StructureElement *>(this->sender());
+    if (element != nullptr && m_elementsSpatialIndex.contains(element))
+        m_elementsSpatialIndex.insert(element, element->geometry());
+}
+
+void Structure::updateAnnotationSpatialIndex()
+{
+    Annotation *annotation = qobject_cast<Annotation *>(this->sender());
+    if (annotation != nullptr && m_annotationsSpatialIndex.contains(annotation))
+        m_annotationsSpatialIndex.insert(annotation, annotation->geometry());
+}
+
 void Structure::updateLocationHeadingMapLater()
 {
     m_locationHeadingsMapTimer.start(0, this);
@@ -5324,41 +5434,47 @@ void Structure::onAboutToRemoveSceneElement(SceneElement *element)
 
 void Structure::updateCharacterNamesShotsTransitionsAndTags()
 {
-    QStringList names = m_characterElementMap.characterNames();
-    QSet<QString> tags;
+    // Names and tags are collected as StringPool IDs, so that de-duplication
+    // doesn't have to compare strings.
+    auto collectIds = [](QSet<int> &ids, const QStringList &strings) {
+        for (const QString &string : strings)
+            ids.insert(StringPool::id(string));
+    };
+
+    auto sortedStrings = [](const QSet<int> &ids) {
+        QStringList ret = StringPool::strings(QList<int>(ids.begin(), ids.end()));
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+
+    const QList<int> nameIds = m_characterElementMap.distinctValueIds();
+    QSet<int> nameIdSet(nameIds.begin(), nameIds.end());
+    QSet<int> tagIdSet;
 
     const QList<Character *> characters = m_characters.list();
     for (Character *character : characters) {
-        const QString name = character->name();
-        if (!names.contains(name))
-            names.append(name);
-
-        const QStringList ctags = character->tags();
-        tags += QSet<QString>(ctags.begin(), ctags.end());
+        nameIdSet.insert(StringPool::id(character->name()));
+        collectIds(tagIdSet, character->tags());
     }
 
-    names = this->sortCharacterNames(names);
+    const QStringList names = this->sortCharacterNames(
+            StringPool::strings(QList<int>(nameIdSet.begin(), nameIdSet.end())));
     if (names != m_characterNames) {
         m_characterNames = names;
         emit characterNamesChanged();
     }
 
-    const QStringList tagValues = tags.values();
+    const QStringList tagValues = StringPool::strings(QList<int>(tagIdSet.begin(), tagIdSet.end()));
     if (tagValues != m_characterTags) {
-        m_characterTags = tags.values();
+        m_characterTags = tagValues;
         emit characterTagsChanged();
     }
 
     const QStringList shots = [=]() {
-        const QStringList _shots = m_shotElementMap.shots();
-        QSet<QString> set(_shots.begin(), _shots.end());
-
-        const QStringList _defaultShorts = Scrite::defaultShots();
-        set += QSet<QString>(_defaultShorts.begin(), _defaultShorts.end());
-
-        QStringList ret(set.begin(), set.end());
-        std::sort(ret.begin(), ret.end());
-        return ret;
+        const QList<int> _shots = m_shotElementMap.distinctValueIds();
+        QSet<int> set(_shots.begin(), _shots.end());
+        collectIds(set, Scrite::defaultShots());
+        return sortedStrings(set);
     }();
     if (shots != m_shots) {
         m_shots = shots;
@@ -5366,15 +5482,10 @@ void Structure::updateCharacterNamesShotsTransitionsAndTags()
     }
 
     const QStringList transitions = [=]() {
-        const QStringList _transitions = m_transitionElementMap.transitions();
-        QSet<QString> set(_transitions.begin(), _transitions.end());
-
-        const QStringList _defaultTransitions = Scrite::defaultTransitions();
-        set += QSet<QString>(_defaultTransitions.begin(), _defaultTransitions.end());
-
-        QStringList ret(set.begin(), set.end());
-        std::sort(ret.begin(), ret.end());
-        return ret;
+        const QList<int> _transitions = m_transitionElementMap.distinctValueIds();
+        QSet<int> set(_transitions.begin(), _transitions.end());
+        collectIds(set, Scrite::defaultTransitions());
+        return sortedStrings(set);
     }();
     if (transitions != m_transitions) {
         m_transitions = transitions;
@@ -5389,16 +5500,17 @@ void Structure::updateCharacterNamesShotsTransitionsAndTagsLater()
 
 void Structure::updateSceneTags()
 {
-    QSet<QString> allTags;
+    QSet<int> allTags;
 
     const QList<StructureElement *> elements = m_elements.list();
     for (const StructureElement *element : std::as_const(elements)) {
         const Scene *scene = element->scene();
         const QStringList tags = scene->tags();
-        allTags += QSet<QString>(tags.begin(), tags.end());
+        for (const QString &tag : tags)
+            allTags.insert(StringPool::id(tag));
     }
 
-    const QStringList allTags2 = QStringList(allTags.begin(), allTags.end());
+    const QStringList allTags2 = StringPool::strings(QList<int>(allTags.begin(), allTags.end()));
     if (m_sceneTags != allTags2) {
         m_sceneTags = allTags2;
         emit sceneTagsChanged();
@@ -5907,6 +6019,8 @@ void StructureCanvasViewportFilterModel::setComputeStrategy(
 
     m_computeStrategy = val;
     emit computeStrategyChanged();
+
+    this->invalidateSelfLater();
 }
 
 void StructureCanvasViewportFilterModel::setFilterStrategy(
@@ -5944,18 +6058,25 @@ int StructureCanvasViewportFilterModel::mapToSourceRow(int filter_row) const
 void StructureCanvasViewportFilterModel::setSourceModel(QAbstractItemModel *model)
 {
     QAbstractItemModel *oldModel = this->sourceModel();
+    if (oldModel == model)
+        return;
+
     if (oldModel != nullptr) {
-        connect(oldModel, &QAbstractItemModel::rowsInserted, this,
-                &StructureCanvasViewportFilterModel::invalidateSelfLater);
-        connect(oldModel, &QAbstractItemModel::rowsRemoved, this,
-                &StructureCanvasViewportFilterModel::invalidateSelfLater);
-        connect(oldModel, &QAbstractItemModel::rowsMoved, this,
-                &StructureCanvasViewportFilterModel::invalidateSelfLater);
-        connect(oldModel, &QAbstractItemModel::dataChanged, this,
-                &StructureCanvasViewportFilterModel::invalidateSelfLater);
-        connect(oldModel, &QAbstractItemModel::modelReset, this,
-                &StructureCanvasViewportFilterModel::invalidateSelfLater);
-    }
+        disconnect(oldModel, &QAbstractItemModel::rowsInserted, this,
+                   &StructureCanvasViewportFilterModel::invalidateSelfLater);
+        disconnect(oldModel, &QAbstractItemModel::rowsRemoved, this,
+                   &StructureCanvasViewportFilterModel::invalidateSelfLater);
+        disconnect(oldModel, &QAbstractItemModel::rowsMoved, this,
+                   &StructureCanvasViewportFilterModel::invalidateSelfLater);
+        disconnect(oldModel, &QAbstractItemModel::dataChanged, this,
+                   &StructureCanvasViewportFilterModel::invalidateSelfLater);
+        disconnect(oldModel, &QAbstractItemModel::modelReset, this,
+                   &StructureCanvasViewportFilterModel::invalidateSelfLater);
+    }
+
+    // Until the visible set is computed for the new model, accept nothing.
+    m_visibleObjects.clear();
+    m_acceptsAll = false;
 
     if (m_structure.isNull())
         this->QSortFilterProxyModel::setSourceModel(nullptr);
@@ -5980,6 +6101,8 @@ void StructureCanvasViewportFilterModel::setSourceModel(QAbstractItemModel *mode
         connect(model, &QAbstractItemModel::modelReset, this,
                 &StructureCanvasViewportFilterModel::invalidateSelfLater);
     }
+
+    this->invalidateSelfLater();
 }
 
 bool StructureCanvasViewportFilterModel::filterAcceptsRow(int source_row,
@@ -5995,15 +6118,8 @@ bool StructureCanvasViewportFilterModel::filterAcceptsRow(int source_row,
         return true;
 
     const QObject *object = model->objectAt(source_row);
-    if (m_computeStrategy == PreComputeStrategy) {
-        if (source_row < 0 || source_row >= m_visibleSourceRows.size()
-            || object != m_visibleSourceRows.at(source_row).first) {
-            (const_cast<StructureCanvasViewportFilterModel *>(this))->invalidateSelfLater();
-            return false;
-        }
-
-        return m_visibleSourceRows.at(source_row).second;
-    }
+    if (m_computeStrategy == PreComputeStrategy)
+        return m_acceptsAll || m_visibleObjects.contains(object);
 
     const QRectF objectRect = (m_type == AnnotationType)
             ? (qobject_cast<const Annotation *>(object))->geometry()
@@ -6043,34 +6159,38 @@ void StructureCanvasViewportFilterModel::updateSourceModel()
 
 void StructureCanvasViewportFilterModel::invalidateSelf()
 {
-    m_visibleSourceRows.clear();
-    const AbstractQObjectListModel *model = m_computeStrategy == OnDemandComputeStrategy
-            ? nullptr
-            : qobject_cast<AbstractQObjectListModel *>(this->sourceModel());
-    if (model == nullptr || m_computeStrategy == OnDemandComputeStrategy) {
+    if (m_computeStrategy == OnDemandComputeStrategy || m_structure.isNull()
+        || this->sourceModel() == nullptr) {
+        m_visibleObjects.clear();
+        m_acceptsAll = true;
         this->beginFilterChange();
         this->endFilterChange();
         return;
     }
 
-    m_visibleSourceRows.reserve(model->objectCount());
-    for (int i = 0; i < model->objectCount(); i++) {
-        const QObject *object = model->objectAt(i);
-
-        if (m_viewportRect.size().isEmpty())
-            m_visibleSourceRows << qMakePair(object, true);
-        else {
-            const QRectF objectRect = (m_type == AnnotationType)
-                    ? (qobject_cast<const Annotation *>(object))->geometry()
-                    : (qobject_cast<const StructureElement *>(object))->geometry();
-            if (m_filterStrategy == ContainsStrategy)
-                m_visibleSourceRows << qMakePair(object, m_viewportRect.contains(objectRect));
-            else
-                m_visibleSourceRows << qMakePair(object, m_viewportRect.intersects(objectRect));
-        }
+    // Ask the structure's spatial index for objects in the viewport, instead of
+    // testing the geometry of every object on the canvas.
+    const bool acceptsAll = m_viewportRect.size().isEmpty();
+    QSet<const QObject *> visibleObjects;
+    if (!acceptsAll) {
+        const SpatialIndex &index = m_type == AnnotationType
+                ? m_structure->annotationsSpatialIndex()
+                : m_structure->elementsSpatialIndex();
+        const QList<const QObject *> objects = m_filterStrategy == ContainsStrategy
+                ? index.contained(m_viewportRect)
+                : index.intersecting(m_viewportRect);
+        visibleObjects = QSet<const QObject *>(objects.begin(), objects.end());
     }
 
+    // Panning within the same set of visible objects needn't disturb views.
+    if (acceptsAll == m_acceptsAll && visibleObjects == m_visibleObjects)
+        return;
+
+    // QSortFilterProxyModel only emits row insertions and removals for rows whose
+    // acceptance actually changed.
     this->beginFilterChange();
+    m_acceptsAll = acceptsAll;
+    m_visibleObjects = visibleObjects;
     this->endFilterChange();
 }
 
@@ -6114,21 +6234,9 @@ QImage AnnotationImageProvider::requestImage(const QString &id, QSize *size,
     DocumentFileSystem *dfs = ScriteDocument::instance()->fileSystem();
     const QString path = dfs->absolutePath(imageName);
 
-    QImageReader reader(path);
-    if (!reader.canRead())
-        return QImage();
-
-    const QSize naturalSize = reader.size();
-    if (naturalSize.isEmpty())
-        return QImage();
-
-    if (targetWidth < naturalSize.width()) {
-        const QSizeF targetSize =
-                QSizeF(naturalSize) * qreal(targetWidth) / qreal(naturalSize.width());
-        reader.setScaledSize(targetSize.toSize());
-    }
-
-    const QImage image = reader.read();
+    // Only width is constrained here, height follows from the aspect ratio.
+    const QImage image =
+            ThumbnailCache::load(path, QSize(targetWidth, std::numeric_limits<int>::max()));
     if (size)
         *size = image.size();
     return image;
@@ -19,6 +19,7 @@
 #include "notes.h"
 #include "scene.h"
 #include "attachments.h"
+#include "spatialindex.h"
 #include "execlatertimer.h"
 #include "modelaggregator.h"
 #include "qobjectproperty.h"
@@ -26,6 +27,7 @@
 #include "qobjectlistmodel.h"
 
 #include <QColor>
+#include <QSet>
 #include <QPointer>
 #include <QJsonArray>
 #include <QQuickImageProvider>
@@ -51,6 +53,7 @@ class StructureElement : public QObject, public QObjectSerializer::Interface
     Q_OBJECT
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit StructureElement(QObject *parent = nullptr);
@@ -441,6 +444,7 @@ class Relationship : public QObject, public QObjectSerializer::Interface
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
     QML_UNCREATABLE("Instantiation from QML not allowed.")
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit Relationship(QObject *parent = nullptr);
@@ -539,6 +543,7 @@ class Character : public QObject, public QObjectSerializer::Interface
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
     QML_UNCREATABLE("Instantiation from QML not allowed.")
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit Character(QObject *parent = nullptr);
@@ -994,6 +999,7 @@ class Annotation : public QObject
 {
     Q_OBJECT
     QML_ELEMENT
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     Q_INVOKABLE explicit Annotation(QObject *parent = nullptr);
@@ -1101,6 +1107,7 @@ public:
 protected:
     bool event(QEvent *event);
     void polishAttributes();
+    void updateDfsClaims();
     void onDfsAuction(const QString &filePath, int *claims);
 
 private:
@@ -1121,6 +1128,7 @@ class Structure : public QObject, public QObjectSerializer::Interface
     Q_INTERFACES(QObjectSerializer::Interface)
     QML_ELEMENT
     QML_UNCREATABLE("Instantiation from QML not allowed.")
+    Q_CLASSINFO("ParentChangeEvent", "Required")
 
 public:
     explicit Structure(QObject *parent = nullptr);
@@ -1237,6 +1245,9 @@ public:
     Q_INVOKABLE void clearCharacters();
     Q_SIGNAL void characterCountChanged();
 
+    // Emitted when any of the characters is edited
+    Q_SIGNAL void charactersModified();
+
     Q_INVOKABLE QStringList allCharacterNames() const { return m_characterNames; }
     Q_INVOKABLE QJsonArray detectCharacters() const;
     Q_INVOKABLE Character *addCharacter(const QString &name);
@@ -1275,6 +1286,10 @@ public:
     }
     Q_SIGNAL void elementsBoundingBoxChanged();
 
+    // Spatial index of element geometries, for viewport filtering and hit-testing.
+    const SpatialIndex &elementsSpatialIndex() const { return m_elementsSpatialIndex; }
+    Q_INVOKABLE QList<int> elementIndexesIn(const QRectF &rect) const;
+
     // clang-format off
     Q_PROPERTY(StructureElementStacks *elementStacks
                READ elementStacks
@@ -1438,6 +1453,8 @@ public:
     }
     Q_SIGNAL void annotationsBoundingBoxChanged();
 
+    const SpatialIndex &annotationsSpatialIndex() const { return m_annotationsSpatialIndex; }
+
     // clang-format off
     Q_PROPERTY(QQmlListProperty<Annotation> annotations
                READ annotations
@@ -1461,6 +1478,9 @@ public:
     Q_INVOKABLE void clearAnnotations();
     Q_SIGNAL void annotationCountChanged();
 
+    // Emitted when any of the annotations is edited
+    Q_SIGNAL void annotationsModified();
+
     // clang-format off
     Q_PROPERTY(QString defaultGroupsDataFile
                READ defaultGroupsDataFile
@@ -1641,6 +1661,14 @@ private:
     static qsizetype staticElementCount(QQmlListProperty<StructureElement> *list);
     QObjectListModel<StructureElement *> m_elements;
     ModelAggregator m_elementsBoundingBoxAggregator;
+    SpatialIndex m_elementsSpatialIndex;
+    void updateElementSpatialIndex();
+
+    // Row of each element in m_elements, rebuilt lazily after rows are inserted, removed or
+    // moved. Used to map spatial index hits back to element indexes.
+    mutable QHash<const QObject *, int> m_elementIndexes;
+    mutable bool m_elementIndexesDirty = true;
+    void markElementIndexesDirty() { m_elementIndexesDirty = true; }
     StructureElementStacks m_elementStacks;
     int m_currentElementIndex = -1;
     qreal m_zoomLevel = 1.0;
@@ -1675,6 +1703,8 @@ private:
     static qsizetype staticAnnotationCount(QQmlListProperty<Annotation> *list);
     QObjectListModel<Annotation *> m_annotations;
     ModelAggregator m_annotationsBoundingBoxAggregator;
+    SpatialIndex m_annotationsSpatialIndex;
+    void updateAnnotationSpatialIndex();
     bool m_canPaste = false;
 
     bool m_forceBeatBoardLayout = false;
@@ -1912,7 +1942,8 @@ private:
     QObjectProperty<Structure> m_structure;
     FilterStrategy m_filterStrategy = IntersectsStrategy;
     ComputeStrategy m_computeStrategy = OnDemandComputeStrategy;
-    QList<QPair<const QObject *, bool>> m_visibleSourceRows;
+    QSet<const QObject *> m_visibleObjects;
+    bool m_acceptsAll = true;
 };
 
 class AnnotationImageProvider : public QQuickImageProvider
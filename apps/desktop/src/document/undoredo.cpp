@@ -16,7 +16,9 @@
 #include "undoredo.h"
 #include "utils.h"
 
+#include <QTimerEvent>
 #include <QApplication>
+#include <QJsonDocument>
 #include <QQmlListReference>
 
 void UndoHub::init(const char *uri, QQmlEngine *qmlEngine)
@@ -86,12 +88,67 @@ void UndoHub::setMergeTimeGap(int val)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-UndoStack::UndoStack(QObject *parent) : QUndoStack(parent)
+qint64 UndoCommandMemoryInterface::memoryUsageOf(const QVariant &value)
+{
+    qint64 ret = qint64(sizeof(QVariant));
+
+    switch (value.userType()) {
+    case QMetaType::QString:
+        ret += value.toString().capacity() * qint64(sizeof(QChar));
+        break;
+    case QMetaType::QByteArray:
+        ret += value.toByteArray().capacity();
+        break;
+    case QMetaType::QStringList: {
+        const QStringList list = value.toStringList();
+        for (const QString &item : list)
+            ret += qint64(sizeof(QString)) + item.capacity() * qint64(sizeof(QChar));
+    } break;
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        for (const QVariant &item : list)
+            ret += memoryUsageOf(item);
+    } break;
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+            ret += it.key().capacity() * qint64(sizeof(QChar)) + memoryUsageOf(it.value());
+    } break;
+    case QMetaType::QJsonObject:
+        ret += memoryUsageOf(value.toJsonObject());
+        break;
+    case QMetaType::QJsonArray:
+        ret += QJsonDocument(value.toJsonArray()).toJson(QJsonDocument::Compact).size();
+        break;
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+qint64 UndoCommandMemoryInterface::memoryUsageOf(const QJsonObject &value)
+{
+    // Compact JSON is a reasonable, if slightly low, estimate of what QJsonObject holds.
+    return value.isEmpty() ? 0 : QJsonDocument(value).toJson(QJsonDocument::Compact).size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+UndoStack::UndoStack(QObject *parent)
+    : QUndoStack(parent), m_memoryUsageTimer("UndoStack.m_memoryUsageTimer")
 {
     UndoHub::instance()->addStack(this);
 #if 0
     connect(this, &QUndoStack::indexChanged, this, &UndoStack::onIndexChanged);
 #endif
+
+    // Memory usage is updated once bulk pushes, undos or redos (macro replays for
+    // instance) are done.
+    connect(this, &QUndoStack::indexChanged, this, [=]() {
+        if (!m_memoryUsageTimer.isActive())
+            m_memoryUsageTimer.start(0, this);
+    });
 }
 
 UndoStack::~UndoStack()
@@ -100,6 +157,83 @@ UndoStack::~UndoStack()
         UndoHub::instance()->removeStack(this);
 }
 
+void UndoStack::setMemoryLimit(qint64 val)
+{
+    if (m_memoryLimit == val)
+        return;
+
+    m_memoryLimit = val;
+    emit memoryLimitChanged();
+
+    if (m_memoryLimit > 0 && m_memoryUsage > m_memoryLimit)
+        emit memoryLimitExceeded();
+}
+
+qint64 UndoStack::memoryUsageOf(const QUndoCommand *command)
+{
+    if (command == nullptr)
+        return 0;
+
+    qint64 ret = 0;
+
+    const UndoCommandMemoryInterface *interface =
+            dynamic_cast<const UndoCommandMemoryInterface *>(command);
+    if (interface)
+        ret = interface->memoryUsage();
+    else
+        ret = qint64(sizeof(QUndoCommand));
+
+    ret += command->text().capacity() * qint64(sizeof(QChar));
+
+    const int nrChildren = command->childCount();
+    for (int i = 0; i < nrChildren; i++)
+        ret += UndoStack::memoryUsageOf(command->child(i));
+
+    return ret;
+}
+
+void UndoStack::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_memoryUsageTimer.timerId()) {
+        m_memoryUsageTimer.stop();
+        this->updateMemoryUsage();
+    } else
+        QUndoStack::timerEvent(event);
+}
+
+void UndoStack::updateMemoryUsage()
+{
+    // Commands below the top of the stack don't change once pushed, so their usage is
+    // computed only once. The top command may have merged with others since.
+    const int nrCommands = this->count();
+
+    QHash<const QUndoCommand *, qint64> commandMemoryUsage;
+    commandMemoryUsage.reserve(nrCommands);
+
+    qint64 total = 0;
+    for (int i = 0; i < nrCommands; i++) {
+        const QUndoCommand *command = this->command(i);
+        qint64 usage = i < nrCommands - 1 ? m_commandMemoryUsage.value(command, -1) : -1;
+        if (usage < 0)
+            usage = UndoStack::memoryUsageOf(command);
+
+        commandMemoryUsage.insert(command, usage);
+        total += usage;
+    }
+
+    m_commandMemoryUsage = commandMemoryUsage;
+
+    if (m_memoryUsage == total)
+        return;
+
+    const bool wasWithinLimit = m_memoryLimit <= 0 || m_memoryUsage <= m_memoryLimit;
+    m_memoryUsage = total;
+    emit memoryUsageChanged();
+
+    if (wasWithinLimit && m_memoryLimit > 0 && m_memoryUsage > m_memoryLimit)
+        emit memoryLimitExceeded();
+}
+
 void UndoStack::onActiveInGroupChanged(QUndoStack *stack)
 {
     const bool a = stack == this;
@@ -151,14 +285,46 @@ static QByteArray objectUndoRedoLockProperty()
     return ret;
 }
 
-class ObjectPropertyInfoList : public QObject, public QList<ObjectPropertyInfo *>
+// Indexes all ObjectPropertyInfo instances by id and by object, so that command names and
+// property infos can be looked up without scanning through all of them.
+class ObjectPropertyInfoList : public QObject
 {
 public:
     explicit ObjectPropertyInfoList() : QObject() { qApp->installEventFilter(this); }
     ~ObjectPropertyInfoList()
     {
-        qDeleteAll(*this);
-        this->clear();
+        const QList<ObjectPropertyInfo *> infos = m_infoById.values();
+        m_infoById.clear();
+        m_infoByObject.clear();
+        qDeleteAll(infos);
+    }
+
+    void add(ObjectPropertyInfo *info)
+    {
+        m_infoById.insert(info->id, info);
+        m_infoByObject.insert(info->object, info);
+    }
+
+    void remove(ObjectPropertyInfo *info)
+    {
+        m_infoById.remove(info->id);
+        m_infoByObject.remove(info->object, info);
+    }
+
+    ObjectPropertyInfo *findById(int id) const { return m_infoById.value(id); }
+
+    ObjectPropertyInfo *find(const QObject *object, const QMetaObject *metaObject,
+                             const QByteArray &property) const
+    {
+        auto it = m_infoByObject.constFind(object);
+        while (it != m_infoByObject.constEnd() && it.key() == object) {
+            ObjectPropertyInfo *info = it.value();
+            if (info->metaObject == metaObject && info->property == property)
+                return info;
+            ++it;
+        }
+
+        return nullptr;
     }
 
     bool eventFilter(QObject *object, QEvent *event)
@@ -172,14 +338,18 @@ public:
 
         const bool locked = object->property(objectUndoRedoLockProperty()).toBool();
 
-        for (int i = 0; i < this->size(); i++) {
-            ObjectPropertyInfo *pinfo = this->at(i);
-            if (pinfo->object == object)
-                pinfo->m_objectIsLocked = locked;
+        auto it = m_infoByObject.constFind(object);
+        while (it != m_infoByObject.constEnd() && it.key() == object) {
+            it.value()->m_objectIsLocked = locked;
+            ++it;
         }
 
         return false;
     }
+
+private:
+    QHash<int, ObjectPropertyInfo *> m_infoById;
+    QMultiHash<const QObject *, ObjectPropertyInfo *> m_infoByObject;
 };
 Q_GLOBAL_STATIC(ObjectPropertyInfoList, GlobalObjectPropertyInfoList);
 
@@ -218,21 +388,29 @@ QString UndoStack::commandName(int id)
         return QStringLiteral("Remove Scene Element");
     default:
         if (id > 1000) {
-            const ObjectPropertyInfoList &list = *::GlobalObjectPropertyInfoList();
-            for (const ObjectPropertyInfo *info : list) {
-                if (info->id == id)
-                    return info->description();
-            }
+            const ObjectPropertyInfo *info = ::GlobalObjectPropertyInfoList->findById(id);
+            if (info != nullptr)
+                return info->description();
         }
         return QStringLiteral("Unknown");
     }
 }
 
+typedef QHash<QPair<const QMetaObject *, QByteArray>, QList<QByteArray>> PropertyBundleCache;
+Q_GLOBAL_STATIC(PropertyBundleCache, GlobalPropertyBundleCache)
+
 static inline QList<QByteArray> queryPropertyBundle(QObject *object, const QByteArray &property)
 {
+    // Class infos are static, so they need to be parsed only once per meta-object.
+    const QMetaObject *metaObject = object->metaObject();
+    const QPair<const QMetaObject *, QByteArray> key(metaObject, property);
+
+    auto it = ::GlobalPropertyBundleCache->constFind(key);
+    if (it != ::GlobalPropertyBundleCache->constEnd())
+        return it.value();
+
     QList<QByteArray> propertyBundle;
 
-    const QMetaObject *metaObject = object->metaObject();
     const QByteArray bundle = "UndoBundleFor_" + property;
     const int ciIndex = metaObject->indexOfClassInfo(bundle);
     if (ciIndex >= 0) {
@@ -245,6 +423,7 @@ static inline QList<QByteArray> queryPropertyBundle(QObject *object, const QByte
         }
     }
 
+    ::GlobalPropertyBundleCache->insert(key, propertyBundle);
     return propertyBundle;
 }
 
@@ -258,12 +437,13 @@ ObjectPropertyInfo::ObjectPropertyInfo(QObject *o, const QMetaObject *mo, const
     m_objectIsLocked = o->property(objectUndoRedoLockProperty()).toBool();
     m_connection = QObject::connect(o, &QObject::destroyed, o, [this]() { this->deleteSelf(); });
 
-    ::GlobalObjectPropertyInfoList->append(this);
+    ::GlobalObjectPropertyInfoList->add(this);
 }
 
 ObjectPropertyInfo::~ObjectPropertyInfo()
 {
-    ::GlobalObjectPropertyInfoList->removeOne(this);
+    if (!::GlobalObjectPropertyInfoList.isDestroyed())
+        ::GlobalObjectPropertyInfoList->remove(this);
     QObject::disconnect(m_connection);
 }
 
@@ -318,12 +498,9 @@ ObjectPropertyInfo *ObjectPropertyInfo::get(QObject *object, const QByteArray &p
     if (metaObject == nullptr)
         return nullptr; // dont know why this would happen. Just being paranoid
 
-    ObjectPropertyInfoList &list = *::GlobalObjectPropertyInfoList();
-    for (int i = 0; i < list.size(); i++) {
-        ObjectPropertyInfo *info = list.at(i);
-        if (info->object == object && info->metaObject == metaObject && info->property == property)
-            return info;
-    }
+    ObjectPropertyInfo *info = ::GlobalObjectPropertyInfoList->find(object, metaObject, property);
+    if (info != nullptr)
+        return info;
 
     return new ObjectPropertyInfo(object, metaObject, property);
 }
@@ -371,6 +548,12 @@ ObjectPropertyUndoCommand::~ObjectPropertyUndoCommand()
     QObject::disconnect(m_connection);
 }
 
+qint64 ObjectPropertyUndoCommand::memoryUsage() const
+{
+    return qint64(sizeof(*this)) + UndoCommandMemoryInterface::memoryUsageOf(m_oldValue)
+            + UndoCommandMemoryInterface::memoryUsageOf(m_newValue);
+}
+
 void ObjectPropertyUndoCommand::pushToActiveStack()
 {
     if (m_propertyInfo != nullptr && UndoHub::active()) {
@@ -26,6 +26,7 @@
 #include <QUndoGroup>
 
 #include "utils.h"
+#include "execlatertimer.h"
 #include "qobjectfactory.h"
 #include "garbagecollector.h"
 #include "qobjectserializer.h"
@@ -86,6 +87,18 @@ private:
     int m_mergeTimeGap = 1000;
 };
 
+// Undo commands that hold on to sizeable data implement this interface, so that
+// UndoStack can account for memory held by them.
+class UndoCommandMemoryInterface
+{
+public:
+    virtual ~UndoCommandMemoryInterface() { }
+    virtual qint64 memoryUsage() const = 0;
+
+    static qint64 memoryUsageOf(const QVariant &value);
+    static qint64 memoryUsageOf(const QJsonObject &value);
+};
+
 class UndoStack : public QUndoStack
 {
     Q_OBJECT
@@ -101,6 +114,31 @@ public:
     explicit UndoStack(QObject *parent = nullptr);
     ~UndoStack();
 
+    // Approximate number of bytes held by commands in this stack.
+    // clang-format off
+    Q_PROPERTY(qint64 memoryUsage
+               READ memoryUsage
+               NOTIFY memoryUsageChanged)
+    // clang-format on
+    qint64 memoryUsage() const { return m_memoryUsage; }
+    Q_SIGNAL void memoryUsageChanged();
+
+    // QUndoStack cannot drop its oldest commands on demand, so exceeding this limit is
+    // only notified using memoryLimitExceeded(). A value <= 0 means no limit.
+    // clang-format off
+    Q_PROPERTY(qint64 memoryLimit
+               READ memoryLimit
+               WRITE setMemoryLimit
+               NOTIFY memoryLimitChanged)
+    // clang-format on
+    void setMemoryLimit(qint64 val);
+    qint64 memoryLimit() const { return m_memoryLimit; }
+    Q_SIGNAL void memoryLimitChanged();
+
+    Q_SIGNAL void memoryLimitExceeded();
+
+    static qint64 memoryUsageOf(const QUndoCommand *command);
+
     enum CommandID {
         SceneCommandID = 100,
         SceneElementTextCommandID,
@@ -123,14 +161,22 @@ public:
 signals:
     void activeChanged();
 
+protected:
+    void timerEvent(QTimerEvent *event);
+
 private:
     void onActiveInGroupChanged(QUndoStack *stack);
 
     void onIndexChanged(int index);
+    void updateMemoryUsage();
 
 private:
     int m_lastIndex = 0;
     bool m_active = false;
+    qint64 m_memoryUsage = 0;
+    qint64 m_memoryLimit = 0;
+    ExecLaterTimer m_memoryUsageTimer;
+    QHash<const QUndoCommand *, qint64> m_commandMemoryUsage;
 };
 
 class ObjectPropertyInfoList;
@@ -169,11 +215,14 @@ private:
 };
 
 class PushObjectPropertyUndoCommand;
-class ObjectPropertyUndoCommand : public QUndoCommand
+class ObjectPropertyUndoCommand : public QUndoCommand, public UndoCommandMemoryInterface
 {
 public:
     ~ObjectPropertyUndoCommand();
 
+    // UndoCommandMemoryInterface interface
+    qint64 memoryUsage() const;
+
     void pushToActiveStack();
 
     // QUndoCommand interface
@@ -271,7 +320,7 @@ enum Operation { InsertOperation, RemoveOperation };
 }
 
 template<class ParentClass, class ChildClass>
-class ObjectListCommand : public QUndoCommand
+class ObjectListCommand : public QUndoCommand, public UndoCommandMemoryInterface
 {
     friend class PushObjectListCommand<ParentClass, ChildClass>;
 
@@ -347,6 +396,12 @@ public:
     int id() const { return m_parentPropertyInfo->id; }
     bool mergeWith(const QUndoCommand *) { return false; }
 
+    // UndoCommandMemoryInterface interface
+    qint64 memoryUsage() const
+    {
+        return qint64(sizeof(*this)) + UndoCommandMemoryInterface::memoryUsageOf(m_childInfo);
+    }
+
 private:
     void remove()
     {
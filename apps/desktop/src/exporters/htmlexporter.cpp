@@ -57,6 +57,15 @@ void HtmlExporter::setBundleFonts(bool val)
     emit bundleFontsChanged();
 }
 
+void HtmlExporter::setSplitIntoSceneFiles(bool val)
+{
+    if (m_splitIntoSceneFiles == val)
+        return;
+
+    m_splitIntoSceneFiles = val;
+    emit splitIntoSceneFilesChanged();
+}
+
 static void alignmentToCssValue(QTextStream &ts, Qt::Alignment alignment)
 {
     switch (alignment) {
@@ -76,6 +85,35 @@ static void alignmentToCssValue(QTextStream &ts, Qt::Alignment alignment)
     }
 };
 
+namespace {
+
+// Paragraphs are segmented into script runs, and merged with their text formats, exactly once
+// while collecting them. The same runs are used for picking fonts and for writing the HTML.
+struct HtmlParagraph
+{
+    SceneElement::Type type = SceneElement::Action;
+    QString text;
+    Qt::Alignment alignment;
+    QVector<QTextLayout::FormatRange> formats;
+};
+
+struct HtmlScene
+{
+    QColor color;
+    bool omitted = false;
+    QList<HtmlParagraph> paragraphs;
+};
+
+struct HtmlFontFace
+{
+    QString family;
+    QString fileName;
+    int weight = -1;
+    QFont::Style style = QFont::StyleNormal;
+};
+
+} // namespace
+
 bool HtmlExporter::doExport(QIODevice *device)
 {
     const Screenplay *screenplay = this->document()->screenplay();
@@ -92,49 +130,82 @@ bool HtmlExporter::doExport(QIODevice *device)
     const int bottomMargin = int(formatting->pageLayout()->bottomMargin() * layoutScale);
     const qreal contentWidth = formatting->pageLayout()->contentWidth() * layoutScale;
 
-    QTextStream ts(device);
-    ts.setEncoding(QStringConverter::Utf8);
-    ts.setAutoDetectUnicode(true);
+    const QMetaEnum scriptEnum = QMetaEnum::fromType<QtChar::Script>();
+    const QMetaEnum elementTypeEnum = QMetaEnum::fromType<SceneElement::Type>();
 
-    ts << "<!DOCTYPE html>\n";
-    ts << "<html>\n";
-    ts << "  <head>\n";
-    ts << "    <title>" << screenplay->title() << "</title>\n";
-    ts << "    <meta charset=\"UTF-8\">\n";
-    ts << "  </head>\n";
-    ts << "  <body>\n";
-    ts << "    <style>\n";
-
-    const QMap<QChar::Script, QString> scriptFonts = [screenplay]() {
-        QMap<QChar::Script, QString> ret;
-        for (int i = 0; i < screenplay->elementCount(); i++) {
-            const ScreenplayElement *element = screenplay->elementAt(i);
-            const Scene *scene = element->scene();
-            if (!scene)
-                continue;
-
-            const SceneHeading *heading = scene->heading();
-            if (heading->isEnabled()) {
-                const QList<ScriptBoundary> breakup =
-                        LanguageEngine::determineBoundaries(heading->displayText());
-                for (const ScriptBoundary &boundary : breakup)
-                    ret[boundary.script] = boundary.fontFamily();
-            }
+    // Collect all scenes and their paragraphs, along with fonts required for scripts used.
+    QMap<QChar::Script, QString> scriptFonts;
+    auto collectParagraph = [&scriptFonts](SceneElement::Type type, const QString &text,
+                                           Qt::Alignment alignment = Qt::Alignment(),
+                                           const QVector<QTextLayout::FormatRange> &textFormats =
+                                                   QVector<QTextLayout::FormatRange>()) {
+        const QList<ScriptBoundary> breakup = LanguageEngine::determineBoundaries(text);
+        for (const ScriptBoundary &boundary : breakup)
+            scriptFonts[boundary.script] = boundary.fontFamily();
+
+        HtmlParagraph paragraph;
+        paragraph.type = type;
+        paragraph.text = text;
+        paragraph.alignment = alignment;
+        paragraph.formats = LanguageEngine::mergeTextFormats(breakup, textFormats);
+        return paragraph;
+    };
+
+    QList<HtmlScene> scenes;
+    for (int i = 0; i < screenplay->elementCount(); i++) {
+        const ScreenplayElement *screenplayElement = screenplay->elementAt(i);
+        if (screenplayElement->elementType() != ScreenplayElement::SceneElementType)
+            continue;
+
+        const Scene *scene = screenplayElement->scene();
+
+        HtmlScene htmlScene;
+        htmlScene.color = scene->color();
+        htmlScene.omitted = screenplayElement->isOmitted();
 
-            for (int j = 0; j < scene->elementCount(); j++) {
-                const SceneElement *para = scene->elementAt(j);
-                const QList<ScriptBoundary> breakup =
-                        LanguageEngine::determineBoundaries(para->text());
-                for (const ScriptBoundary &boundary : breakup)
-                    ret[boundary.script] = boundary.fontFamily();
+        const SceneHeading *heading = scene->heading();
+        const QString headingText = screenplayElement->isOmitted()
+                ? QStringLiteral("OMITTED")
+                : (heading->isEnabled() ? heading->text() : QStringLiteral("NO SCENE HEADING"));
+        if (heading->isEnabled()) {
+            if (m_includeSceneNumbers)
+                htmlScene.paragraphs.append(collectParagraph(
+                        SceneElement::Heading,
+                        "[" + screenplayElement->resolvedSceneNumber() + "] " + headingText));
+            else
+                htmlScene.paragraphs.append(collectParagraph(SceneElement::Heading, headingText));
+        } else {
+            if (screenplayElement->isOmitted())
+                htmlScene.paragraphs.append(collectParagraph(SceneElement::Heading, headingText));
+        }
+
+        if (!screenplayElement->isOmitted()) {
+            const int nrElements = scene->elementCount();
+            for (int j = 0; j < nrElements; j++) {
+                const SceneElement *element = scene->elementAt(j);
+                htmlScene.paragraphs.append(collectParagraph(element->type(),
+                                                             element->formattedText(),
+                                                             element->alignment(),
+                                                             element->textFormats()));
             }
         }
 
-        return ret;
-    }();
-    const QMetaEnum scriptEnum = QMetaEnum::fromType<QtChar::Script>();
-    const QMetaEnum elementTypeEnum = QMetaEnum::fromType<SceneElement::Type>();
+        scenes.append(htmlScene);
+    }
+
+    // Class names are looked up for every paragraph and span, so they are computed just once.
+    QHash<int, QString> paragraphClassNames;
+    for (int i = SceneElement::Min; i <= SceneElement::Max; i++)
+        paragraphClassNames[i] = QStringLiteral("scrite-")
+                + QString::fromLatin1(elementTypeEnum.valueToKey(i))
+                + QStringLiteral("-paragraph");
 
+    QHash<int, QString> scriptClassNames;
+    for (auto it = scriptFonts.constBegin(); it != scriptFonts.constEnd(); ++it)
+        scriptClassNames[it.key()] = QString::fromLatin1(scriptEnum.valueToKey(it.key())).toLower();
+
+    // Bundle fonts, if required.
+    QList<HtmlFontFace> fontFaces;
     if (m_bundleFonts) {
         const QString fontsDir = QFileInfo(this->fileName()).absolutePath() + "/fonts";
 
@@ -162,51 +233,17 @@ bool HtmlExporter::doExport(QIODevice *device)
                     }
                     srcFile.close();
 
-                    ts << "    @font-face {\n";
-                    ts << "      font-family: \"" << it.value() << "\";\n";
-                    ts << "      src: url(fonts/" << fileName << ");\n";
+                    HtmlFontFace fontFace;
+                    fontFace.family = it.value();
+                    fontFace.fileName = fileName;
 
                     QRawFont rawFont(fontDest, 12);
                     if (rawFont.isValid()) {
-                        const int weight = rawFont.weight();
-                        const QFont::Style style = rawFont.style();
-
-                        ts << "      font-weight: ";
-                        switch (weight) {
-                        case int(QFont::Light):
-                            ts << "lighter";
-                            break;
-                        case int(QFont::Normal):
-                            ts << "normal";
-                            break;
-                        case int(QFont::Bold):
-                            ts << "bold";
-                            break;
-                        case int(QFont::ExtraBold):
-                            ts << "bolder";
-                            break;
-                        default:
-                            ts << weight;
-                            break;
-                        }
-                        ts << ";\n";
-
-                        ts << "      font-style: ";
-                        switch (style) {
-                        case QFont::StyleNormal:
-                            ts << "normal";
-                            break;
-                        case QFont::StyleItalic:
-                            ts << "italic";
-                            break;
-                        case QFont::StyleOblique:
-                            ts << "oblique";
-                            break;
-                        }
-                        ts << ";\n";
+                        fontFace.weight = rawFont.weight();
+                        fontFace.style = rawFont.style();
                     }
 
-                    ts << "    }\n";
+                    fontFaces.append(fontFace);
                 }
             }
 
@@ -214,107 +251,162 @@ bool HtmlExporter::doExport(QIODevice *device)
         }
     }
 
-    auto it = scriptFonts.constBegin();
-    auto end = scriptFonts.constEnd();
+    auto writeHead = [&](QTextStream &ts, const QString &title) {
+        ts << "<!DOCTYPE html>\n";
+        ts << "<html>\n";
+        ts << "  <head>\n";
+        ts << "    <title>" << title << "</title>\n";
+        ts << "    <meta charset=\"UTF-8\">\n";
+        ts << "  </head>\n";
+        ts << "  <body>\n";
+        ts << "    <style>\n";
+
+        for (const HtmlFontFace &fontFace : std::as_const(fontFaces)) {
+            ts << "    @font-face {\n";
+            ts << "      font-family: \"" << fontFace.family << "\";\n";
+            ts << "      src: url(fonts/" << fontFace.fileName << ");\n";
+
+            if (fontFace.weight >= 0) {
+                ts << "      font-weight: ";
+                switch (fontFace.weight) {
+                case int(QFont::Light):
+                    ts << "lighter";
+                    break;
+                case int(QFont::Normal):
+                    ts << "normal";
+                    break;
+                case int(QFont::Bold):
+                    ts << "bold";
+                    break;
+                case int(QFont::ExtraBold):
+                    ts << "bolder";
+                    break;
+                default:
+                    ts << fontFace.weight;
+                    break;
+                }
+                ts << ";\n";
+
+                ts << "      font-style: ";
+                switch (fontFace.style) {
+                case QFont::StyleNormal:
+                    ts << "normal";
+                    break;
+                case QFont::StyleItalic:
+                    ts << "italic";
+                    break;
+                case QFont::StyleOblique:
+                    ts << "oblique";
+                    break;
+                }
+                ts << ";\n";
+            }
 
-    while (it != end) {
-        ts << "    span." << QString::fromLatin1(scriptEnum.valueToKey(it.key())).toLower()
-           << " {\n";
-        ts << "      font-family: \"" << it.value() << "\";\n";
-        ts << "    }\n";
-        ++it;
-    }
+            ts << "    }\n";
+        }
+
+        auto it = scriptFonts.constBegin();
+        auto end = scriptFonts.constEnd();
+
+        while (it != end) {
+            ts << "    span." << scriptClassNames.value(it.key()) << " {\n";
+            ts << "      font-family: \"" << it.value() << "\";\n";
+            ts << "    }\n";
+            ++it;
+        }
+
+        for (int i = SceneElement::Min; i <= SceneElement::Max; i++) {
+            if (i > SceneElement::Min)
+                ts << "\n";
+
+            SceneElement::Type elementType = SceneElement::Type(i);
+            SceneElementFormat *format = formatting->elementFormat(elementType);
+            ts << "    p." << paragraphClassNames.value(i) << " {\n";
+            ts << "      font-family: \"" << format->font().family() << "\";\n";
+            ts << "      font-size: " << format->font().pointSize() << "pt;\n";
+            if (format->font().bold())
+                ts << "      font-weight: bold;\n";
+            if (format->font().italic())
+                ts << "      font-style: italic;\n";
+            ts << "      color: " << format->textColor().name() << ";\n";
+            if (format->backgroundColor() != Qt::transparent)
+                ts << "      background-color: " << format->backgroundColor().name() << ";\n";
+            ts << "      text-align: ";
+            alignmentToCssValue(ts, format->textAlignment());
+            ts << ";\n";
+
+            const int pLeftMargin = int(format->leftMargin() * contentWidth + leftMargin);
+            const int pRightMargin = int(format->rightMargin() * contentWidth + rightMargin);
+
+            ts << "      padding-left: " << pLeftMargin << "px;\n";
+            ts << "      padding-right: " << pRightMargin << "px;\n";
+            if (qFuzzyIsNull(format->lineSpacingBefore())
+                || format->elementType() == SceneElement::Heading)
+                ts << "      padding-top: 0px;\n";
+            else
+                ts << "      padding-top: " << format->lineSpacingBefore() << "em;\n";
+            ts << "      padding-bottom: 0px;\n";
+            ts << "      margin: 0px;\n";
+            ts << "      line-height: " << format->lineHeight() * 1.1 << "em;\n";
+            ts << "    }\n";
+        }
+
+        const SceneElementFormat *headingFormat = formatting->elementFormat(SceneElement::Heading);
 
-    for (int i = SceneElement::Min; i <= SceneElement::Max; i++) {
-        if (i > SceneElement::Min)
-            ts << "\n";
-
-        SceneElement::Type elementType = SceneElement::Type(i);
-        SceneElementFormat *format = formatting->elementFormat(elementType);
-        ts << "    p.scrite-" << elementTypeEnum.valueToKey(elementType) << "-paragraph {\n";
-        ts << "      font-family: \"" << format->font().family() << "\";\n";
-        ts << "      font-size: " << format->font().pointSize() << "pt;\n";
-        if (format->font().bold())
-            ts << "      font-weight: bold;\n";
-        if (format->font().italic())
-            ts << "      font-style: italic;\n";
-        ts << "      color: " << format->textColor().name() << ";\n";
-        if (format->backgroundColor() != Qt::transparent)
-            ts << "      background-color: " << format->backgroundColor().name() << ";\n";
-        ts << "      text-align: ";
-        alignmentToCssValue(ts, format->textAlignment());
-        ts << ";\n";
-
-        const int pLeftMargin = int(format->leftMargin() * contentWidth + leftMargin);
-        const int pRightMargin = int(format->rightMargin() * contentWidth + rightMargin);
-
-        ts << "      padding-left: " << pLeftMargin << "px;\n";
-        ts << "      padding-right: " << pRightMargin << "px;\n";
-        if (qFuzzyIsNull(format->lineSpacingBefore())
-            || format->elementType() == SceneElement::Heading)
+        ts << "\n";
+        ts << "    div.scrite-scene {\n";
+        if (qFuzzyIsNull(headingFormat->lineSpacingBefore()))
             ts << "      padding-top: 0px;\n";
         else
-            ts << "      padding-top: " << format->lineSpacingBefore() << "em;\n";
+            ts << "      padding-top: " << headingFormat->lineSpacingBefore() << "em;\n";
         ts << "      padding-bottom: 0px;\n";
-        ts << "      margin: 0px;\n";
-        ts << "      line-height: " << format->lineHeight() * 1.1 << "em;\n";
+        ts << "      padding-left: 0px;\n";
+        ts << "      padding-right: 0px;\n";
         ts << "    }\n";
-    }
 
-    const SceneElementFormat *headingFormat = formatting->elementFormat(SceneElement::Heading);
-
-    ts << "\n";
-    ts << "    div.scrite-scene {\n";
-    if (qFuzzyIsNull(headingFormat->lineSpacingBefore()))
-        ts << "      padding-top: 0px;\n";
-    else
-        ts << "      padding-top: " << headingFormat->lineSpacingBefore() << "em;\n";
-    ts << "      padding-bottom: 0px;\n";
-    ts << "      padding-left: 0px;\n";
-    ts << "      padding-right: 0px;\n";
-    ts << "    }\n";
-
-    ts << "\n";
-    ts << "    div.scrite-screenplay {\n";
-    ts << "        width: " << int(paperWidth) << "px;\n";
-    ts << "        border: 1px solid gray;\n";
-    ts << "        margin-left: auto;\n";
-    ts << "        margin-right: auto;\n";
-    ts << "        margin-top: " << topMargin << "px;\n";
-    ts << "        margin-bottom: " << bottomMargin << "px;\n";
-    ts << "    }\n";
-
-    ts << "    </style>\n\n";
-
-    ts << "    <div class=\"scrite-screenplay\">\n";
-
-    auto writeParagraph = [&ts, elementTypeEnum, scriptEnum,
-                           scriptFonts](SceneElement::Type type, const QString &text,
-                                        Qt::Alignment overrideAlignment = Qt::Alignment(),
-                                        const QVector<QTextLayout::FormatRange> &textFormats =
-                                                QVector<QTextLayout::FormatRange>()) {
-        const QString styleName =
-                "scrite-" + QString::fromLatin1(elementTypeEnum.valueToKey(type)) + "-paragraph";
+        ts << "\n";
+        ts << "    div.scrite-screenplay {\n";
+        ts << "        width: " << int(paperWidth) << "px;\n";
+        ts << "        border: 1px solid gray;\n";
+        ts << "        margin-left: auto;\n";
+        ts << "        margin-right: auto;\n";
+        ts << "        margin-top: " << topMargin << "px;\n";
+        ts << "        margin-bottom: " << bottomMargin << "px;\n";
+        ts << "    }\n";
+
+        ts << "    </style>\n\n";
+
+        ts << "    <div class=\"scrite-screenplay\">\n";
+    };
+
+    auto writeTail = [](QTextStream &ts) {
+        ts << "    </div>\n\n";
+
+        ts << "  </body>\n";
+        ts << "</html>\n";
+    };
+
+    auto writeParagraph = [&paragraphClassNames, &scriptClassNames](
+                                  QTextStream &ts, const HtmlParagraph &paragraph) {
+        const QString &styleName = paragraphClassNames[paragraph.type];
         ts << "        <p class=\"" << styleName << "\" custom-style=\"" << styleName << "\"";
 
-        if (overrideAlignment != 0) {
+        if (paragraph.alignment != 0) {
             ts << " style=\"text-align: ";
-            alignmentToCssValue(ts, overrideAlignment);
+            alignmentToCssValue(ts, paragraph.alignment);
             ts << ";\"";
         }
 
         ts << ">";
 
-        const QList<ScriptBoundary> breakup = LanguageEngine::determineBoundaries(text);
-        const QVector<QTextLayout::FormatRange> mergedTextFormats =
-                LanguageEngine::mergeTextFormats(breakup, textFormats);
-        for (const QTextLayout::FormatRange &format : mergedTextFormats) {
+        const QStringView text(paragraph.text);
+        for (const QTextLayout::FormatRange &format : paragraph.formats) {
             QChar::Script script =
                     (QChar::Script)format.format.property(QTextFormat::UserProperty).toInt();
             ts << "<span ";
-            if (scriptFonts.contains(script))
-                ts << "class=\"" << QString::fromLatin1(scriptEnum.valueToKey(script)).toLower()
-                   << "\" ";
+            const auto scriptClassName = scriptClassNames.constFind(script);
+            if (scriptClassName != scriptClassNames.constEnd())
+                ts << "class=\"" << scriptClassName.value() << "\" ";
 
             bool customStyle = false;
             auto startCustomStyle = [&customStyle, &ts]() {
@@ -338,19 +430,18 @@ bool HtmlExporter::doExport(QIODevice *device)
                 }
             }
 
-            QStringList textDecorationCss;
-
-            if (format.format.hasProperty(QTextFormat::TextUnderlineStyle)
-                && format.format.fontUnderline())
-                textDecorationCss << "underline";
-
-            if (format.format.hasProperty(QTextFormat::FontStrikeOut)
-                && format.format.fontStrikeOut())
-                textDecorationCss << "line-through";
-
-            if (!textDecorationCss.isEmpty()) {
+            const bool underline = format.format.hasProperty(QTextFormat::TextUnderlineStyle)
+                    && format.format.fontUnderline();
+            const bool strikeOut = format.format.hasProperty(QTextFormat::FontStrikeOut)
+                    && format.format.fontStrikeOut();
+            if (underline || strikeOut) {
                 startCustomStyle();
-                ts << "text-decoration: " << textDecorationCss.join(" ") << "; ";
+                ts << "text-decoration:";
+                if (underline)
+                    ts << " underline";
+                if (strikeOut)
+                    ts << " line-through";
+                ts << "; ";
             }
 
             if (format.format.hasProperty(QTextFormat::BackgroundBrush)) {
@@ -374,12 +465,13 @@ bool HtmlExporter::doExport(QIODevice *device)
 
             ts << ">";
 
-            if (format.format.isAnchor() && !format.format.anchorHref().isEmpty())
+            const bool isLink = format.format.isAnchor() && !format.format.anchorHref().isEmpty();
+            if (isLink)
                 ts << "<a href=\"" << format.format.anchorHref() << "\">";
 
             ts << text.mid(format.start, format.length);
 
-            if (format.format.isAnchor() && !format.format.anchorHref().isEmpty())
+            if (isLink)
                 ts << "</a>";
 
             ts << "</span>";
@@ -387,61 +479,87 @@ bool HtmlExporter::doExport(QIODevice *device)
         ts << "</p>\n";
     };
 
-    const int nrScenes = screenplay->elementCount();
-    for (int i = 0; i < nrScenes; i++) {
-        const ScreenplayElement *screenplayElement = screenplay->elementAt(i);
-        if (screenplayElement->elementType() != ScreenplayElement::SceneElementType)
-            continue;
-
-        const Scene *scene = screenplayElement->scene();
-
+    auto writeScene = [&](QTextStream &ts, const HtmlScene &scene, bool lastScene) {
         if (m_exportWithSceneColors) {
-            const QColor sceneColor = scene->color();
-            const QString sceneColorText = "rgba(" + QString::number(sceneColor.red()) + ","
-                    + QString::number(sceneColor.green()) + "," + QString::number(sceneColor.blue())
-                    + ",0.1)";
             ts << "      <div class=\"scrite-scene\" custom-style=\"scrite-scene\" "
-                  "style=\"background-color: "
-               << sceneColorText << ";\">\n";
+                  "style=\"background-color: rgba("
+               << scene.color.red() << "," << scene.color.green() << "," << scene.color.blue()
+               << ",0.1);\">\n";
         } else
             ts << "      <div class=\"scrite-scene\" custom-style=\"scrite-scene\">\n";
 
-        const SceneHeading *heading = scene->heading();
-        const QString headingText = screenplayElement->isOmitted()
-                ? QStringLiteral("OMITTED")
-                : (heading->isEnabled() ? heading->text() : QStringLiteral("NO SCENE HEADING"));
-        if (heading->isEnabled()) {
-            if (m_includeSceneNumbers)
-                writeParagraph(SceneElement::Heading,
-                               "[" + screenplayElement->resolvedSceneNumber() + "] " + headingText);
-            else
-                writeParagraph(SceneElement::Heading, headingText);
-        } else {
-            if (screenplayElement->isOmitted())
-                writeParagraph(SceneElement::Heading, headingText);
-        }
-
-        if (screenplayElement->isOmitted())
-            continue;
+        for (const HtmlParagraph &paragraph : scene.paragraphs)
+            writeParagraph(ts, paragraph);
 
-        const int nrElements = scene->elementCount();
-        for (int j = 0; j < nrElements; j++) {
-            SceneElement *element = scene->elementAt(j);
-            writeParagraph(element->type(), element->formattedText(), element->alignment(),
-                           element->textFormats());
-        }
-
-        if (i == nrScenes - 1)
+        if (lastScene && !scene.omitted)
             ts << "        <p class=\"scrite-action\" custom-style=\"scrite-action\">&nbsp;</p>";
 
         ts << "      </div>\n";
+    };
+
+    QTextStream ts(device);
+    ts.setEncoding(QStringConverter::Utf8);
+    ts.setAutoDetectUnicode(true);
+
+    writeHead(ts, screenplay->title());
+
+    if (!m_splitIntoSceneFiles) {
+        for (int i = 0; i < scenes.size(); i++)
+            writeScene(ts, scenes.at(i), i == scenes.size() - 1);
+
+        writeTail(ts);
+        ts.flush();
+
+        return true;
     }
 
-    ts << "    </div>\n\n";
+    // Each scene goes into a file of its own, next to the main file, which links to all of them.
+    const QFileInfo fileInfo(this->fileName());
+    auto sceneFileName = [&fileInfo](int index) {
+        return fileInfo.completeBaseName() + QStringLiteral("-scene-")
+                + QString::number(index + 1).rightJustified(4, '0') + QStringLiteral(".html");
+    };
+
+    auto writeNavigation = [&](QTextStream &ts, int index) {
+        ts << "        <p class=\"" << paragraphClassNames[SceneElement::Transition] << "\">";
+        if (index > 0)
+            ts << "<a href=\"" << sceneFileName(index - 1) << "\">Previous</a> | ";
+        ts << "<a href=\"" << fileInfo.fileName() << "\">Contents</a>";
+        if (index < scenes.size() - 1)
+            ts << " | <a href=\"" << sceneFileName(index + 1) << "\">Next</a>";
+        ts << "</p>\n";
+    };
+
+    for (int i = 0; i < scenes.size(); i++) {
+        const HtmlScene &scene = scenes.at(i);
 
-    ts << "  </body>\n";
-    ts << "</html>\n";
+        ts << "        <p class=\"" << paragraphClassNames[SceneElement::Heading] << "\">";
+        ts << "<a href=\"" << sceneFileName(i) << "\">";
+        if (!scene.paragraphs.isEmpty() && scene.paragraphs.first().type == SceneElement::Heading)
+            ts << scene.paragraphs.first().text;
+        else
+            ts << "Scene " << (i + 1);
+        ts << "</a></p>\n";
+
+        QFile sceneFile(fileInfo.absoluteDir().absoluteFilePath(sceneFileName(i)));
+        if (!sceneFile.open(QFile::WriteOnly)) {
+            this->error()->setErrorMessage(QStringLiteral("Could not write to %1")
+                                                   .arg(sceneFile.fileName()));
+            return false;
+        }
+
+        QTextStream sceneTs(&sceneFile);
+        sceneTs.setEncoding(QStringConverter::Utf8);
+
+        writeHead(sceneTs, screenplay->title());
+        writeNavigation(sceneTs, i);
+        writeScene(sceneTs, scene, i == scenes.size() - 1);
+        writeNavigation(sceneTs, i);
+        writeTail(sceneTs);
+        sceneTs.flush();
+    }
 
+    writeTail(ts);
     ts.flush();
 
     return true;
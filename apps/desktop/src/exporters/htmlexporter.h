@@ -69,6 +69,19 @@ public:
     bool isBundleFonts() const { return m_bundleFonts; }
     Q_SIGNAL void bundleFontsChanged();
 
+    // clang-format off
+    Q_CLASSINFO("splitIntoSceneFiles_FieldLabel", "Write each scene into a separate file.")
+    Q_CLASSINFO("splitIntoSceneFiles_FieldNote", "Recommended for very long screenplays. The exported file will link to all scene files.")
+    Q_CLASSINFO("splitIntoSceneFiles_FieldEditor", "CheckBox")
+    Q_PROPERTY(bool splitIntoSceneFiles
+               READ isSplitIntoSceneFiles
+               WRITE setSplitIntoSceneFiles
+               NOTIFY splitIntoSceneFilesChanged)
+    // clang-format on
+    void setSplitIntoSceneFiles(bool val);
+    bool isSplitIntoSceneFiles() const { return m_splitIntoSceneFiles; }
+    Q_SIGNAL void splitIntoSceneFilesChanged();
+
     bool canBundleFonts() const { return true; }
     bool requiresConfiguration() const { return true; }
 
@@ -80,6 +93,7 @@ private:
     bool m_includeSceneNumbers = false;
     bool m_exportWithSceneColors = false;
     bool m_bundleFonts = true;
+    bool m_splitIntoSceneFiles = false;
 };
 
 #endif // HTMLEXPORTER_H
@@ -17,11 +17,21 @@
 #include "screenplayformat.h"
 #include "screenplay.h"
 #include "scritedocument.h"
+#include "languageengine.h"
+#include "quazip.h"
+#include "quazipfile.h"
 
+#include <QScreen>
+#include <QPageSize>
 #include <QFileInfo>
 #include <QPdfWriter>
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QXmlStreamWriter>
 #include <QTextDocumentWriter>
 
+#include <functional>
+
 OdtExporter::OdtExporter(QObject *parent) : AbstractTextDocumentExporter(parent) { }
 
 OdtExporter::~OdtExporter() { }
@@ -36,6 +46,18 @@ void OdtExporter::setIncludeSceneNumbers(bool val)
 }
 
 bool OdtExporter::doExport(QIODevice *device)
+{
+    // Scene characters, synopsis, featured images, comments and scene colors are rendered by
+    // ScreenplayTextDocument, so we fall back to it when any of them are asked for.
+    if (this->isListSceneCharacters() || this->isIncludeSceneSynopsis()
+        || this->isIncludeSceneFeaturedImage() || this->isIncludeSceneComments()
+        || this->isUseSceneColors())
+        return this->exportUsingTextDocument(device);
+
+    return this->exportNatively(device);
+}
+
+bool OdtExporter::exportUsingTextDocument(QIODevice *device)
 {
     const qreal pageWidth = 0; // pdfWriter.width();
     QTextDocument textDocument;
@@ -48,3 +70,572 @@ bool OdtExporter::doExport(QIODevice *device)
 
     return true;
 }
+
+namespace {
+
+const QString OfficeNS = QStringLiteral("urn:oasis:names:tc:opendocument:xmlns:office:1.0");
+const QString StyleNS = QStringLiteral("urn:oasis:names:tc:opendocument:xmlns:style:1.0");
+const QString TextNS = QStringLiteral("urn:oasis:names:tc:opendocument:xmlns:text:1.0");
+const QString FoNS =
+        QStringLiteral("urn:oasis:names:tc:opendocument:xmlns:xsl-fo-compatible:1.0");
+const QString XLinkNS = QStringLiteral("http://www.w3.org/1999/xlink");
+const QString DcNS = QStringLiteral("http://purl.org/dc/elements/1.1/");
+const QString MetaNS = QStringLiteral("urn:oasis:names:tc:opendocument:xmlns:meta:1.0");
+const QString ManifestNS = QStringLiteral("urn:oasis:names:tc:opendocument:xmlns:manifest:1.0");
+
+using OdfProperties = QList<QPair<QString, QString>>;
+
+QString odfLength(qreal inches)
+{
+    return QString::number(inches, 'f', 4) + QStringLiteral("in");
+}
+
+QString odfAlignment(Qt::Alignment alignment)
+{
+    if (alignment.testFlag(Qt::AlignRight))
+        return QStringLiteral("end");
+    if (alignment.testFlag(Qt::AlignHCenter))
+        return QStringLiteral("center");
+    if (alignment.testFlag(Qt::AlignJustify))
+        return QStringLiteral("justify");
+    return QStringLiteral("start");
+}
+
+/**
+ * Styles are referenced from content.xml while it is being streamed, and declared as named
+ * styles in styles.xml, which is written after content.xml. That way we never have to hold
+ * the document body in memory to figure out which styles it needs.
+ */
+class OdtStyles
+{
+public:
+    struct Style
+    {
+        QString name;
+        QString displayName;
+        QString family;
+        QString parentName;
+        OdfProperties paragraphProperties;
+        OdfProperties textProperties;
+    };
+
+    void addStyle(const Style &style)
+    {
+        m_styleIndex.insert(style.name, m_styles.size());
+        m_styles.append(style);
+    }
+
+    // Returns a paragraph style derived from the given one, for alignment overrides and breaks.
+    QString paragraphStyle(const QString &parentName, Qt::Alignment alignment, bool breakBefore)
+    {
+        if (!alignment && !breakBefore)
+            return parentName;
+
+        const QString key = parentName + QLatin1Char('|') + QString::number(int(alignment))
+                + QLatin1Char('|') + QString::number(breakBefore);
+        const QString existing = m_derivedStyles.value(key);
+        if (!existing.isEmpty())
+            return existing;
+
+        Style style;
+        style.name = parentName + QStringLiteral("_") + QString::number(m_derivedStyles.size() + 1);
+        style.family = QStringLiteral("paragraph");
+        style.parentName = parentName;
+        if (alignment)
+            style.paragraphProperties.append({ QStringLiteral("fo:text-align"),
+                                               odfAlignment(alignment) });
+        if (breakBefore)
+            style.paragraphProperties.append(
+                    { QStringLiteral("fo:break-before"), QStringLiteral("page") });
+        this->addStyle(style);
+
+        m_derivedStyles.insert(key, style.name);
+        return style.name;
+    }
+
+    // Returns a text style for the given character format, or an empty string if the format
+    // has nothing that's not already in the paragraph style.
+    QString textStyle(const QTextCharFormat &format)
+    {
+        OdfProperties properties;
+        if (format.hasProperty(QTextFormat::FontFamilies)) {
+            const QStringList families = format.fontFamilies().toStringList();
+            if (!families.isEmpty() && !families.first().isEmpty())
+                properties.append({ QStringLiteral("fo:font-family"), families.first() });
+        }
+        if (format.hasProperty(QTextFormat::FontWeight) && format.fontWeight() >= QFont::Bold)
+            properties.append({ QStringLiteral("fo:font-weight"), QStringLiteral("bold") });
+        if (format.hasProperty(QTextFormat::FontItalic) && format.fontItalic())
+            properties.append({ QStringLiteral("fo:font-style"), QStringLiteral("italic") });
+        if (format.hasProperty(QTextFormat::TextUnderlineStyle) && format.fontUnderline()) {
+            properties.append(
+                    { QStringLiteral("style:text-underline-style"), QStringLiteral("solid") });
+            properties.append(
+                    { QStringLiteral("style:text-underline-width"), QStringLiteral("auto") });
+            properties.append({ QStringLiteral("style:text-underline-color"),
+                                QStringLiteral("font-color") });
+        }
+        if (format.hasProperty(QTextFormat::FontStrikeOut) && format.fontStrikeOut())
+            properties.append(
+                    { QStringLiteral("style:text-line-through-style"), QStringLiteral("solid") });
+        if (format.hasProperty(QTextFormat::ForegroundBrush)) {
+            const QColor color = format.foreground().color();
+            if (!qFuzzyIsNull(color.alphaF()))
+                properties.append({ QStringLiteral("fo:color"), color.name() });
+        }
+        if (format.hasProperty(QTextFormat::BackgroundBrush)) {
+            const QColor color = format.background().color();
+            if (!qFuzzyIsNull(color.alphaF()))
+                properties.append({ QStringLiteral("fo:background-color"), color.name() });
+        }
+
+        if (properties.isEmpty())
+            return QString();
+
+        QString key;
+        for (const QPair<QString, QString> &property : std::as_const(properties))
+            key += property.first + QLatin1Char('=') + property.second + QLatin1Char(';');
+
+        const QString existing = m_textStyles.value(key);
+        if (!existing.isEmpty())
+            return existing;
+
+        Style style;
+        style.name = QStringLiteral("Scrite_Text_") + QString::number(m_textStyles.size() + 1);
+        style.family = QStringLiteral("text");
+        style.textProperties = properties;
+        this->addStyle(style);
+
+        m_textStyles.insert(key, style.name);
+        return style.name;
+    }
+
+    void write(QXmlStreamWriter &xml) const
+    {
+        for (const Style &style : m_styles) {
+            xml.writeStartElement(StyleNS, QStringLiteral("style"));
+            xml.writeAttribute(StyleNS, QStringLiteral("name"), style.name);
+            if (!style.displayName.isEmpty())
+                xml.writeAttribute(StyleNS, QStringLiteral("display-name"), style.displayName);
+            xml.writeAttribute(StyleNS, QStringLiteral("family"), style.family);
+            if (!style.parentName.isEmpty())
+                xml.writeAttribute(StyleNS, QStringLiteral("parent-style-name"),
+                                   style.parentName);
+
+            auto writeProperties = [&xml](const QString &element,
+                                          const OdfProperties &properties) {
+                if (properties.isEmpty())
+                    return;
+                xml.writeStartElement(StyleNS, element);
+                for (const QPair<QString, QString> &property : properties) {
+                    const int colon = property.first.indexOf(QLatin1Char(':'));
+                    const QString prefix = property.first.left(colon);
+                    const QString name = property.first.mid(colon + 1);
+                    xml.writeAttribute(prefix == QStringLiteral("fo") ? FoNS : StyleNS, name,
+                                       property.second);
+                }
+                xml.writeEndElement();
+            };
+            writeProperties(QStringLiteral("paragraph-properties"), style.paragraphProperties);
+            writeProperties(QStringLiteral("text-properties"), style.textProperties);
+
+            xml.writeEndElement();
+        }
+    }
+
+private:
+    QList<Style> m_styles;
+    QHash<QString, int> m_styleIndex;
+    QHash<QString, QString> m_textStyles;
+    QHash<QString, QString> m_derivedStyles;
+};
+
+// Writes text the way ODF wants it: tabs, line breaks and runs of spaces as elements.
+void writeOdfText(QXmlStreamWriter &xml, QStringView text, bool atParagraphStart)
+{
+    int from = 0;
+    auto flush = [&](int until) {
+        if (until > from)
+            xml.writeCharacters(text.mid(from, until - from).toString());
+    };
+
+    for (int i = 0; i < text.length(); i++) {
+        const QChar ch = text.at(i);
+        if (ch == QLatin1Char('\t')) {
+            flush(i);
+            xml.writeEmptyElement(TextNS, QStringLiteral("tab"));
+            from = i + 1;
+        } else if (ch == QLatin1Char('\n') || ch == QChar::LineSeparator
+                   || ch == QChar::ParagraphSeparator) {
+            flush(i);
+            xml.writeEmptyElement(TextNS, QStringLiteral("line-break"));
+            from = i + 1;
+        } else if (ch == QLatin1Char(' ')) {
+            int nrSpaces = 1;
+            while (i + nrSpaces < text.length() && text.at(i + nrSpaces) == QLatin1Char(' '))
+                ++nrSpaces;
+
+            const bool leading = atParagraphStart && i == 0;
+            if (nrSpaces == 1 && !leading)
+                continue;
+
+            flush(leading ? i : i + 1);
+            const int nrCollapsed = leading ? nrSpaces : nrSpaces - 1;
+            xml.writeEmptyElement(TextNS, QStringLiteral("s"));
+            if (nrCollapsed > 1)
+                xml.writeAttribute(TextNS, QStringLiteral("c"), QString::number(nrCollapsed));
+
+            i += nrSpaces - 1;
+            from = i + 1;
+        }
+    }
+
+    flush(text.length());
+}
+
+} // namespace
+
+bool OdtExporter::exportNatively(QIODevice *device)
+{
+    Screenplay *screenplay = this->document()->screenplay();
+    const ScreenplayFormat *formatting = this->document()->printFormat();
+    const ScreenplayPageLayout *pageLayout = formatting->pageLayout();
+
+    if (this->isCapitalizeSentences())
+        screenplay->capitalizeSentences();
+    if (this->isPolishParagraphs())
+        screenplay->polishText();
+
+    QuaZip zip(device);
+    zip.setUtf8Enabled(true);
+    zip.setAutoClose(false);
+    if (!zip.open(QuaZip::mdCreate)) {
+        this->error()->setErrorMessage(QStringLiteral("Could not create ODT archive."));
+        return false;
+    }
+
+    auto writeEntry = [&zip](const QString &name, bool compress,
+                             const std::function<void(QIODevice *)> &writer) {
+        QuaZipFile file(&zip);
+        const int method = compress ? Z_DEFLATED : 0;
+        const int level = compress ? Z_DEFAULT_COMPRESSION : 0;
+        if (!file.open(QIODevice::WriteOnly, QuaZipNewInfo(name), nullptr, 0, method, level))
+            return false;
+        writer(&file);
+        file.close();
+        return file.getZipError() == ZIP_OK;
+    };
+
+    auto startDocument = [](QXmlStreamWriter &xml, const QString &root) {
+        xml.setAutoFormatting(false);
+        xml.writeStartDocument();
+        xml.writeNamespace(OfficeNS, QStringLiteral("office"));
+        xml.writeNamespace(StyleNS, QStringLiteral("style"));
+        xml.writeNamespace(TextNS, QStringLiteral("text"));
+        xml.writeNamespace(FoNS, QStringLiteral("fo"));
+        xml.writeNamespace(XLinkNS, QStringLiteral("xlink"));
+        xml.writeNamespace(DcNS, QStringLiteral("dc"));
+        xml.writeNamespace(MetaNS, QStringLiteral("meta"));
+        xml.writeStartElement(OfficeNS, root);
+        xml.writeAttribute(OfficeNS, QStringLiteral("version"), QStringLiteral("1.2"));
+    };
+
+    // The mimetype entry must come first, and must not be compressed.
+    bool success = writeEntry(QStringLiteral("mimetype"), false, [](QIODevice *file) {
+        file->write("application/vnd.oasis.opendocument.text");
+    });
+
+    success &= writeEntry(QStringLiteral("META-INF/manifest.xml"), true, [](QIODevice *file) {
+        QXmlStreamWriter xml(file);
+        xml.writeStartDocument();
+        xml.writeNamespace(ManifestNS, QStringLiteral("manifest"));
+        xml.writeStartElement(ManifestNS, QStringLiteral("manifest"));
+        xml.writeAttribute(ManifestNS, QStringLiteral("version"), QStringLiteral("1.2"));
+
+        const QList<QPair<QString, QString>> entries = {
+            { QStringLiteral("/"), QStringLiteral("application/vnd.oasis.opendocument.text") },
+            { QStringLiteral("content.xml"), QStringLiteral("text/xml") },
+            { QStringLiteral("styles.xml"), QStringLiteral("text/xml") },
+            { QStringLiteral("meta.xml"), QStringLiteral("text/xml") }
+        };
+        for (const QPair<QString, QString> &entry : entries) {
+            xml.writeEmptyElement(ManifestNS, QStringLiteral("file-entry"));
+            xml.writeAttribute(ManifestNS, QStringLiteral("full-path"), entry.first);
+            if (entry.first == QStringLiteral("/"))
+                xml.writeAttribute(ManifestNS, QStringLiteral("version"), QStringLiteral("1.2"));
+            xml.writeAttribute(ManifestNS, QStringLiteral("media-type"), entry.second);
+        }
+
+        xml.writeEndElement();
+        xml.writeEndDocument();
+    });
+
+    success &= writeEntry(QStringLiteral("meta.xml"), true, [&](QIODevice *file) {
+        QXmlStreamWriter xml(file);
+        startDocument(xml, QStringLiteral("document-meta"));
+        xml.writeStartElement(OfficeNS, QStringLiteral("meta"));
+        xml.writeTextElement(MetaNS, QStringLiteral("generator"),
+                             qApp->applicationName() + QLatin1Char(' ')
+                                     + qApp->applicationVersion());
+        xml.writeTextElement(DcNS, QStringLiteral("title"), screenplay->title());
+        xml.writeEndElement();
+        xml.writeEndElement();
+        xml.writeEndDocument();
+    });
+
+    // One named paragraph style per scene element type, derived from the print format.
+    const QMetaEnum elementTypeEnum = QMetaEnum::fromType<SceneElement::Type>();
+    const qreal resolution = pageLayout->resolution();
+    const qreal contentWidth = pageLayout->contentWidth() / resolution; // inches
+    const qreal screenDpi = qApp->primaryScreen() ? qApp->primaryScreen()->logicalDotsPerInchY()
+                                                  : 96.0;
+    const qreal defaultLineSpacing =
+            QFontMetricsF(formatting->defaultFont()).lineSpacing() / screenDpi; // inches
+
+    OdtStyles styles;
+    auto paragraphStyleName = [elementTypeEnum](SceneElement::Type type) {
+        return QStringLiteral("Scrite_") + QString::fromLatin1(elementTypeEnum.valueToKey(type));
+    };
+
+    for (int i = SceneElement::Min; i <= SceneElement::Max; i++) {
+        const SceneElement::Type type = SceneElement::Type(i);
+        const SceneElementFormat *format = formatting->elementFormat(type);
+        const QFont font = format->font();
+
+        OdtStyles::Style style;
+        style.name = paragraphStyleName(type);
+        style.displayName =
+                QStringLiteral("Scrite ") + QString::fromLatin1(elementTypeEnum.valueToKey(type));
+        style.family = QStringLiteral("paragraph");
+
+        style.paragraphProperties = {
+            { QStringLiteral("fo:margin-left"), odfLength(contentWidth * format->leftMargin()) },
+            { QStringLiteral("fo:margin-right"),
+              odfLength(contentWidth * format->rightMargin()) },
+            { QStringLiteral("fo:margin-top"),
+              odfLength(defaultLineSpacing * format->lineSpacingBefore()
+                        * format->lineHeight()) },
+            { QStringLiteral("fo:margin-bottom"), odfLength(0) },
+            { QStringLiteral("fo:line-height"),
+              QString::number(qRound(format->lineHeight() * 100)) + QLatin1Char('%') },
+            { QStringLiteral("fo:text-align"), odfAlignment(format->textAlignment()) },
+        };
+        if (format->textIndent() > 0)
+            style.paragraphProperties.append(
+                    { QStringLiteral("fo:text-indent"), odfLength(format->textIndent() / 72.0) });
+        if (!qFuzzyIsNull(format->backgroundColor().alphaF()))
+            style.paragraphProperties.append(
+                    { QStringLiteral("fo:background-color"), format->backgroundColor().name() });
+
+        style.textProperties = {
+            { QStringLiteral("fo:font-family"), font.family() },
+            { QStringLiteral("fo:font-size"),
+              QString::number(font.pointSize()) + QStringLiteral("pt") },
+            { QStringLiteral("fo:color"), format->textColor().name() },
+        };
+        if (font.bold())
+            style.textProperties.append(
+                    { QStringLiteral("fo:font-weight"), QStringLiteral("bold") });
+        if (font.italic())
+            style.textProperties.append(
+                    { QStringLiteral("fo:font-style"), QStringLiteral("italic") });
+        if (font.underline())
+            style.textProperties.append(
+                    { QStringLiteral("style:text-underline-style"), QStringLiteral("solid") });
+        if (font.capitalization() == QFont::AllUppercase)
+            style.textProperties.append(
+                    { QStringLiteral("fo:text-transform"), QStringLiteral("uppercase") });
+
+        styles.addStyle(style);
+    }
+
+    {
+        const QFont font = formatting->defaultFont();
+
+        OdtStyles::Style style;
+        style.name = QStringLiteral("Scrite_Episode");
+        style.displayName = QStringLiteral("Scrite Episode");
+        style.family = QStringLiteral("paragraph");
+        style.parentName = paragraphStyleName(SceneElement::Heading);
+        style.textProperties = {
+            { QStringLiteral("fo:font-size"),
+              QString::number(font.pointSize() + 2) + QStringLiteral("pt") },
+            { QStringLiteral("fo:font-weight"), QStringLiteral("bold") },
+        };
+        styles.addStyle(style);
+    }
+
+    // Stream content.xml straight from the screenplay.
+    success &= writeEntry(QStringLiteral("content.xml"), true, [&](QIODevice *file) {
+        QXmlStreamWriter xml(file);
+        startDocument(xml, QStringLiteral("document-content"));
+        xml.writeStartElement(OfficeNS, QStringLiteral("body"));
+        xml.writeStartElement(OfficeNS, QStringLiteral("text"));
+
+        auto writeParagraph = [&](const QString &styleName, const QString &text,
+                                  const QVector<QTextLayout::FormatRange> &textFormats =
+                                          QVector<QTextLayout::FormatRange>()) {
+            xml.writeStartElement(TextNS, QStringLiteral("p"));
+            xml.writeAttribute(TextNS, QStringLiteral("style-name"), styleName);
+
+            const QList<ScriptBoundary> breakup = LanguageEngine::determineBoundaries(text);
+            const QVector<QTextLayout::FormatRange> formats =
+                    LanguageEngine::mergeTextFormats(breakup, textFormats);
+
+            const QStringView textView(text);
+            int position = 0;
+            auto writeRun = [&](int start, int length, const QTextCharFormat &format) {
+                if (length <= 0)
+                    return;
+
+                const QString textStyle = styles.textStyle(format);
+                const bool isLink = format.isAnchor() && !format.anchorHref().isEmpty();
+                if (isLink) {
+                    xml.writeStartElement(TextNS, QStringLiteral("a"));
+                    xml.writeAttribute(XLinkNS, QStringLiteral("type"), QStringLiteral("simple"));
+                    xml.writeAttribute(XLinkNS, QStringLiteral("href"), format.anchorHref());
+                }
+                if (!textStyle.isEmpty()) {
+                    xml.writeStartElement(TextNS, QStringLiteral("span"));
+                    xml.writeAttribute(TextNS, QStringLiteral("style-name"), textStyle);
+                }
+
+                writeOdfText(xml, textView.mid(start, length), start == 0);
+
+                if (!textStyle.isEmpty())
+                    xml.writeEndElement();
+                if (isLink)
+                    xml.writeEndElement();
+            };
+
+            for (const QTextLayout::FormatRange &format : formats) {
+                if (format.start > position)
+                    writeRun(position, format.start - position, QTextCharFormat());
+                writeRun(format.start, qMin(format.length, int(text.length()) - format.start),
+                         format.format);
+                position = format.start + format.length;
+            }
+            if (position < text.length())
+                writeRun(position, text.length() - position, QTextCharFormat());
+
+            xml.writeEndElement();
+        };
+
+        const bool hasEpisodes = screenplay->episodeCount() > 0;
+        const int nrElements = screenplay->elementCount();
+        this->progress()->setProgressStep(1.0 / qreal(nrElements + 1));
+
+        for (int i = 0; i < nrElements; i++) {
+            const ScreenplayElement *element = screenplay->elementAt(i);
+            this->progress()->tick();
+
+            if (element->elementType() == ScreenplayElement::BreakElementType) {
+                if (hasEpisodes && element->breakType() == Screenplay::Episode) {
+                    QString breakText = element->breakTitle().toUpper();
+                    if (!element->breakSubtitle().isEmpty())
+                        breakText += QStringLiteral(": ") + element->breakSubtitle().toUpper();
+                    writeParagraph(styles.paragraphStyle(QStringLiteral("Scrite_Episode"),
+                                                         Qt::Alignment(), i > 0),
+                                   breakText);
+                }
+                continue;
+            }
+
+            const Scene *scene = element->scene();
+            if (scene == nullptr)
+                continue;
+
+            // Scene headings are always shown, as ScreenplayTextDocument does for display.
+            const SceneHeading *heading = scene->heading();
+            QString headingText;
+            if (element->isOmitted()) {
+                if (heading->isEnabled() && m_includeSceneNumbers)
+                    headingText = element->resolvedSceneNumber() + QStringLiteral(". ");
+                headingText += QStringLiteral("[OMITTED] ");
+            } else if (heading->isEnabled()) {
+                if (m_includeSceneNumbers)
+                    headingText = element->resolvedSceneNumber() + QStringLiteral(". ");
+                headingText += heading->locationType() + QStringLiteral(". ")
+                        + heading->location() + QStringLiteral(" - ") + heading->moment();
+            } else
+                headingText = QStringLiteral("NO SCENE HEADING");
+
+            writeParagraph(paragraphStyleName(SceneElement::Heading), headingText);
+
+            if (element->isOmitted() || !this->isIncludeSceneContents())
+                continue;
+
+            for (int j = 0; j < scene->elementCount(); j++) {
+                const SceneElement *para = scene->elementAt(j);
+                writeParagraph(styles.paragraphStyle(paragraphStyleName(para->type()),
+                                                     para->alignment(), false),
+                               para->formattedText(), para->textFormats());
+            }
+        }
+
+        xml.writeEndElement(); // office:text
+        xml.writeEndElement(); // office:body
+        xml.writeEndElement(); // office:document-content
+        xml.writeEndDocument();
+    });
+
+    // Now that all styles used in content.xml are known, write them out.
+    success &= writeEntry(QStringLiteral("styles.xml"), true, [&](QIODevice *file) {
+        const QPageSize pageSize(pageLayout->paperSize() == ScreenplayPageLayout::Letter
+                                         ? QPageSize::Letter
+                                         : QPageSize::A4);
+        const QSizeF paperSize = pageSize.size(QPageSize::Inch);
+        const QMarginsF margins = pageLayout->margins() / resolution;
+        const QFont defaultFont = formatting->defaultFont();
+
+        QXmlStreamWriter xml(file);
+        startDocument(xml, QStringLiteral("document-styles"));
+
+        xml.writeStartElement(OfficeNS, QStringLiteral("styles"));
+
+        xml.writeStartElement(StyleNS, QStringLiteral("default-style"));
+        xml.writeAttribute(StyleNS, QStringLiteral("family"), QStringLiteral("paragraph"));
+        xml.writeEmptyElement(StyleNS, QStringLiteral("text-properties"));
+        xml.writeAttribute(FoNS, QStringLiteral("font-family"), defaultFont.family());
+        xml.writeAttribute(FoNS, QStringLiteral("font-size"),
+                           QString::number(defaultFont.pointSize()) + QStringLiteral("pt"));
+        xml.writeEndElement();
+
+        styles.write(xml);
+
+        xml.writeEndElement(); // office:styles
+
+        xml.writeStartElement(OfficeNS, QStringLiteral("automatic-styles"));
+        xml.writeStartElement(StyleNS, QStringLiteral("page-layout"));
+        xml.writeAttribute(StyleNS, QStringLiteral("name"), QStringLiteral("Scrite_PageLayout"));
+        xml.writeEmptyElement(StyleNS, QStringLiteral("page-layout-properties"));
+        xml.writeAttribute(FoNS, QStringLiteral("page-width"), odfLength(paperSize.width()));
+        xml.writeAttribute(FoNS, QStringLiteral("page-height"), odfLength(paperSize.height()));
+        xml.writeAttribute(FoNS, QStringLiteral("margin-left"), odfLength(margins.left()));
+        xml.writeAttribute(FoNS, QStringLiteral("margin-right"), odfLength(margins.right()));
+        xml.writeAttribute(FoNS, QStringLiteral("margin-top"), odfLength(margins.top()));
+        xml.writeAttribute(FoNS, QStringLiteral("margin-bottom"), odfLength(margins.bottom()));
+        xml.writeAttribute(StyleNS, QStringLiteral("print-orientation"),
+                           QStringLiteral("portrait"));
+        xml.writeEndElement(); // style:page-layout
+        xml.writeEndElement(); // office:automatic-styles
+
+        xml.writeStartElement(OfficeNS, QStringLiteral("master-styles"));
+        xml.writeEmptyElement(StyleNS, QStringLiteral("master-page"));
+        xml.writeAttribute(StyleNS, QStringLiteral("name"), QStringLiteral("Standard"));
+        xml.writeAttribute(StyleNS, QStringLiteral("page-layout-name"),
+                           QStringLiteral("Scrite_PageLayout"));
+        xml.writeEndElement(); // office:master-styles
+
+        xml.writeEndElement(); // office:document-styles
+        xml.writeEndDocument();
+    });
+
+    zip.close();
+    success &= zip.getZipError() == ZIP_OK;
+
+    if (!success)
+        this->error()->setErrorMessage(QStringLiteral("Error writing ODT file."));
+
+    return success;
+}
@@ -52,6 +52,15 @@ protected:
     bool doExport(QIODevice *device); // AbstractExporter interface
     QString fileNameExtension() const { return QStringLiteral("odt"); }
 
+private:
+    // Streams content.xml and styles.xml straight from the screenplay into the ODT archive,
+    // without building a QTextDocument first.
+    bool exportNatively(QIODevice *device);
+
+    // Builds a QTextDocument and hands it to QTextDocumentWriter. Used for options that only
+    // ScreenplayTextDocument knows how to render.
+    bool exportUsingTextDocument(QIODevice *device);
+
 private:
     bool m_includeSceneNumbers = false;
 };
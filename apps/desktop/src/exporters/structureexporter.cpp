@@ -64,6 +64,25 @@ void StructureExporter::setPreferFeaturedImage(bool val)
     emit preferFeaturedImageChanged();
 }
 
+void StructureExporter::setTiledExport(bool val)
+{
+    if (m_tiledExport == val)
+        return;
+
+    m_tiledExport = val;
+    emit tiledExportChanged();
+}
+
+void StructureExporter::setMinimumCardScale(int val)
+{
+    val = qBound(10, val, 100);
+    if (m_minimumCardScale == val)
+        return;
+
+    m_minimumCardScale = val;
+    emit minimumCardScaleChanged();
+}
+
 void StructureExporter::setWatermark(const QString &val)
 {
     if (m_watermark == val)
@@ -96,5 +115,14 @@ bool StructureExporter::doExport(QIODevice *device)
     // Construct the graphics scene with content of the structure
     StructureExporterScene scene(this);
     scene.setTitle(screenplay->title() + QStringLiteral(" - Structure"));
+
+    if (m_tiledExport) {
+        const ScreenplayPageLayout *pageLayout = this->document()->printFormat()->pageLayout();
+        scene.setTilePageSize(QPageSize(pageLayout->paperSize() == ScreenplayPageLayout::Letter
+                                                ? QPageSize::Letter
+                                                : QPageSize::A4));
+        scene.setMinimumTileScale(qreal(m_minimumCardScale) / 100.0);
+    }
+
     return scene.exportToPdf(device);
 }
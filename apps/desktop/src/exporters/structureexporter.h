@@ -24,7 +24,7 @@ class StructureExporter : public AbstractExporter
     // clang-format off
     Q_CLASSINFO("Format", "Structure/Screenplay Structure")
     Q_CLASSINFO("NameFilters", "PDF (*.pdf)")
-    Q_CLASSINFO("Description", "Exports the contents of the entire structure canvas as a single page PDF file.")
+    Q_CLASSINFO("Description", "Exports the contents of the entire structure canvas as a PDF file.")
     Q_CLASSINFO("Icon", ":/icons/exporter/structure_pdf.png")
     // clang-format on
 
@@ -71,6 +71,33 @@ public:
     bool isPreferFeaturedImage() const { return m_preferFeaturedImage; }
     Q_SIGNAL void preferFeaturedImageChanged();
 
+    // clang-format off
+    Q_CLASSINFO("tiledExport_FieldLabel", "Split large structures across multiple pages.")
+    Q_CLASSINFO("tiledExport_FieldEditor", "CheckBox")
+    Q_PROPERTY(bool tiledExport
+               READ isTiledExport
+               WRITE setTiledExport
+               NOTIFY tiledExportChanged)
+    // clang-format on
+    void setTiledExport(bool val);
+    bool isTiledExport() const { return m_tiledExport; }
+    Q_SIGNAL void tiledExportChanged();
+
+    // clang-format off
+    Q_CLASSINFO("minimumCardScale_FieldLabel", "Smallest index card size (%) when split:")
+    Q_CLASSINFO("minimumCardScale_FieldEditor", "IntegerSpinBox")
+    Q_CLASSINFO("minimumCardScale_FieldMinValue", "10")
+    Q_CLASSINFO("minimumCardScale_FieldMaxValue", "100")
+    Q_CLASSINFO("minimumCardScale_FieldDefaultValue", "50")
+    Q_PROPERTY(int minimumCardScale
+               READ minimumCardScale
+               WRITE setMinimumCardScale
+               NOTIFY minimumCardScaleChanged)
+    // clang-format on
+    void setMinimumCardScale(int val);
+    int minimumCardScale() const { return m_minimumCardScale; }
+    Q_SIGNAL void minimumCardScaleChanged();
+
     // clang-format off
     Q_CLASSINFO("watermark_FieldLabel", "Watermark text, if enabled.")
     Q_CLASSINFO("watermark_FieldEditor", "TextBox")
@@ -108,6 +135,8 @@ private:
     QString m_comment;
     QString m_watermark;
     bool m_preferFeaturedImage = false;
+    bool m_tiledExport = false;
+    int m_minimumCardScale = 50;
 };
 
 #endif // STRUCTUREEXPORTER_H
@@ -14,22 +14,19 @@
 ****************************************************************************/
 
 #include "application.h"
-#include "boundingboxevaluator.h"
+#include "thumbnailcache.h"
 #include "boundingboxevaluator.h"
 
-#include <QBuffer>
+#include <QtMath>
 #include <QPainter>
-#include <QJsonDocument>
-#include <QFutureWatcher>
 #include <QFutureWatcher>
 #include <QtConcurrentRun>
-#include <QtConcurrentMap>
 #include <QQuickItemGrabResult>
 
 BoundingBoxEvaluator::BoundingBoxEvaluator(QObject *parent) : QObject(parent)
 {
     /**
-      Preview updates are time consumping operations and hence are done
+      Rendering preview tiles is a time consuming operation and hence is done
       on a background thread. Since we need such operations to run on
       a background thread, but sequentially, we need to dump them all
       into one single thread. That's why we are going to configure
@@ -71,10 +68,14 @@ void BoundingBoxEvaluator::setPreviewScale(qreal val)
     emit previewScaleChanged();
 }
 
-QPicture BoundingBoxEvaluator::preview() const
+QList<BoundingBoxPreviewItem> BoundingBoxEvaluator::previewItems() const
 {
-    QMutexLocker locker(&m_previewLock);
-    return m_preview;
+    QList<BoundingBoxPreviewItem> ret = m_previewItems.values();
+    std::stable_sort(ret.begin(), ret.end(),
+                     [](const BoundingBoxPreviewItem &e1, const BoundingBoxPreviewItem &e2) {
+                         return e1.stackOrder < e2.stackOrder;
+                     });
+    return ret;
 }
 
 void BoundingBoxEvaluator::timerEvent(QTimerEvent *event)
@@ -108,8 +109,9 @@ void BoundingBoxEvaluator::setTightBoundingBox(const QRectF &val)
 
 void BoundingBoxEvaluator::addItem(BoundingBoxItem *item)
 {
+    // Changes to item previews reach us through updatePreviewItem(), which marks only
+    // the item's area dirty.
     connect(item, &BoundingBoxItem::aboutToDestroy, this, &BoundingBoxEvaluator::removeItem);
-    connect(item, &BoundingBoxItem::previewUpdated, this, &BoundingBoxEvaluator::markPreviewDirty);
     m_items.append(item);
     this->evaluateLater();
 
@@ -119,14 +121,45 @@ void BoundingBoxEvaluator::addItem(BoundingBoxItem *item)
 void BoundingBoxEvaluator::removeItem(BoundingBoxItem *item)
 {
     disconnect(item, &BoundingBoxItem::aboutToDestroy, this, &BoundingBoxEvaluator::removeItem);
-    disconnect(item, &BoundingBoxItem::previewUpdated, this,
-               &BoundingBoxEvaluator::markPreviewDirty);
     m_items.removeOne(item);
     this->evaluateLater();
 
+    auto it = m_previewItems.find(item);
+    if (it != m_previewItems.end()) {
+        this->markPreviewRectDirty(it.value().rect);
+        m_previewItems.erase(it);
+    }
+
     emit itemCountChanged();
 }
 
+void BoundingBoxEvaluator::updatePreviewItem(BoundingBoxItem *item)
+{
+    if (item == nullptr || item->evaluator() != this)
+        return;
+
+    // Only the area covered by the item, before and after the change, needs to be
+    // redrawn in the preview.
+    auto it = m_previewItems.find(item);
+    if (it != m_previewItems.end()) {
+        this->markPreviewRectDirty(it.value().rect);
+        m_previewItems.erase(it);
+    }
+
+    if (item->isPreviewEnabled()) {
+        const BoundingBoxPreviewItem previewItem = item->previewItem();
+        m_previewItems.insert(item, previewItem);
+        this->markPreviewRectDirty(previewItem.rect);
+    }
+}
+
+void BoundingBoxEvaluator::markPreviewRectDirty(const QRectF &rect)
+{
+    if (!m_pendingPreviewFullyDirty && !rect.isEmpty())
+        m_pendingPreviewDirtyRects.append(rect);
+    m_updatePreviewTimer.start(100, this);
+}
+
 void BoundingBoxEvaluator::evaluateNow()
 {
     QRectF rect = m_initialRect;
@@ -149,141 +182,37 @@ void BoundingBoxEvaluator::evaluateNow()
     rect.adjust(-m_margin, -m_margin, m_margin, m_margin);
     trect.adjust(-m_margin, -m_margin, m_margin, m_margin);
 
+    // Preview coordinates are relative to the bounding box. So the whole preview needs
+    // redrawing only if that changes. Changes within the box are tracked per item.
+    const bool boundingBoxChanged = rect != m_boundingBox;
+
     this->setBoundingBox(rect);
     this->setTightBoundingBox(trect);
-    this->markPreviewDirty();
+
+    if (boundingBoxChanged)
+        this->markPreviewDirty();
 }
 
 void BoundingBoxEvaluator::updatePreview()
 {
 #ifndef QT_NO_DEBUG_OUTPUT
-    qDebug("BoundingBoxEvaluator is updating preview picture");
+    qDebug("BoundingBoxEvaluator is updating preview");
 #endif
-    if (!m_preview.isNull())
-        return;
-
-    const QString futureWatcherName = QStringLiteral("CreatePreviewPictureFuture");
-    if (this->findChild<QFutureWatcherBase *>(futureWatcherName) != nullptr)
-        return;
-
-    /**
-     * Previously we were spawning a thread to run a function which created the preview picture.
-     * That seems like a rather bad idea, because the function (which runs in a thread) will
-     * have to dereference BoundingBoxItem instances in m_items, which could have gotten
-     * deleted by the time the preview is evaluated.
-     *
-     * To address that issue, we now serialize BoundingBoxItems into a JSON array and then
-     * get a function to create preview-picture in a thread.
-     */
-    QList<QJsonObject> itemInfoArray;
-    for (BoundingBoxItem *item : std::as_const(m_items)) {
-        if (item->isPreviewEnabled())
-            itemInfoArray << item->asJson();
-    }
-
-    QFutureWatcher<QPicture> *futureWatcher = new QFutureWatcher<QPicture>(this);
-    futureWatcher->setObjectName(futureWatcherName);
-    connect(futureWatcher, &QFutureWatcher<QPicture>::finished, this, [=]() {
-        m_preview = futureWatcher->result();
-        futureWatcher->deleteLater();
-        emit previewUpdated();
-    });
-
-    QFuture<QPicture> future = QtConcurrent::run(
-            &m_threadPool,
-            [=](const QList<QJsonObject> &items, const QRectF &bbox,
-                const qreal scale) -> QPicture {
-                return BoundingBoxEvaluator::createPreviewPicture(items, bbox, scale);
-            },
-            itemInfoArray, m_boundingBox, m_previewScale);
-    futureWatcher->setFuture(future);
-}
-
-QPicture BoundingBoxEvaluator::createPreviewPicture(const QList<QJsonObject> &items,
-                                                    const QRectF &bbox, const qreal scale)
-{
-    // Make a copy, so we can sort the copy by stack order.
-    QList<QJsonObject> itemsCopy = items;
 
-    QSizeF boxSize = bbox.size();
-    boxSize *= scale;
-    if (boxSize.isEmpty())
-        return QPicture();
+    // Publish changes accumulated so far. BoundingBoxPreview instances look these up
+    // in response to the previewUpdated() signal and redraw only affected tiles.
+    m_previewDirtyRects = m_pendingPreviewDirtyRects;
+    m_previewFullyDirty = m_pendingPreviewFullyDirty;
+    m_pendingPreviewDirtyRects.clear();
+    m_pendingPreviewFullyDirty = false;
 
-    const QString stackOrderAttrib = QStringLiteral("stackOrder");
-
-    auto lessThan = [stackOrderAttrib](const QJsonObject &e1, const QJsonObject &e2) -> bool {
-        return e1.value(stackOrderAttrib).toDouble() < e2.value(stackOrderAttrib).toDouble();
-    };
-    std::sort(itemsCopy.begin(), itemsCopy.end(), lessThan);
-
-    QPicture picture;
-    picture.setBoundingRect(QRectF(QPointF(0, 0), boxSize).toRect());
-
-    QTransform tx;
-    tx.translate(-bbox.left(), -bbox.top());
-    tx.scale(scale, scale);
-
-    QPainter paint(&picture);
-    if (!paint.isActive())
-        return picture;
-
-    paint.setRenderHint(QPainter::Antialiasing);
-    paint.setRenderHint(QPainter::SmoothPixmapTransform);
-    paint.setTransform(tx);
-
-    auto rectFromJson = [](const QJsonObject &jsRect) {
-        return QRectF(jsRect.value(QStringLiteral("x")).toDouble(),
-                      jsRect.value(QStringLiteral("y")).toDouble(),
-                      jsRect.value(QStringLiteral("width")).toDouble(),
-                      jsRect.value(QStringLiteral("height")).toDouble());
-    };
-
-    auto imageFromJson = [](const QJsonValue &value) {
-        if (value.isNull() || value.isUndefined())
-            return QImage();
-
-        const QByteArray base64 = value.toString().toLatin1();
-        QByteArray bytes = QByteArray::fromBase64(base64);
-        QBuffer buffer(&bytes);
-        buffer.open(QIODevice::ReadOnly);
-
-        QImage ret;
-        ret.load(&buffer, "PNG");
-
-        return ret;
-    };
-
-    for (const QJsonObject &item : std::as_const(itemsCopy)) {
-        const QRectF itemRect = rectFromJson(item.value(QStringLiteral("boundingRect")).toObject());
-        const QImage itemPreview = imageFromJson(item.value(QStringLiteral("preview")));
-        const QColor previewBorderColor(
-                item.value(QStringLiteral("previewBorderColor")).toString());
-        const QColor previewFillColor(item.value(QStringLiteral("previewFillColor")).toString());
-        const qreal previewBorderWidth =
-                item.value(QStringLiteral("previewBorderWidth")).toDouble();
-
-        if (!itemPreview.isNull())
-            paint.drawImage(itemRect, itemPreview);
-        else if (previewBorderColor.alpha() > 0 || previewFillColor.alpha() > 0) {
-            QPen pen(previewBorderColor);
-            pen.setCosmetic(true);
-            pen.setWidthF(previewBorderWidth);
-
-            paint.setPen(pen);
-            paint.setBrush(QBrush(previewFillColor));
-            paint.drawRect(itemRect);
-        }
-    }
-
-    paint.end();
-
-    return picture;
+    emit previewUpdated();
 }
 
 void BoundingBoxEvaluator::markPreviewDirty()
 {
-    m_preview = QPicture();
+    m_pendingPreviewFullyDirty = true;
+    m_pendingPreviewDirtyRects.clear();
     m_updatePreviewTimer.start(100, this);
 }
 
@@ -302,11 +231,11 @@ BoundingBoxItem::BoundingBoxItem(QObject *parent)
         connect(m_item, &QQuickItem::widthChanged, this, &BoundingBoxItem::requestReevaluation);
         connect(m_item, &QQuickItem::heightChanged, this, &BoundingBoxItem::requestReevaluation);
 
-        connect(m_item, &QQuickItem::xChanged, &m_jsonUpdateTimer, QOverload<>::of(&QTimer::start));
-        connect(m_item, &QQuickItem::yChanged, &m_jsonUpdateTimer, QOverload<>::of(&QTimer::start));
-        connect(m_item, &QQuickItem::widthChanged, &m_jsonUpdateTimer,
+        connect(m_item, &QQuickItem::xChanged, &m_previewItemUpdateTimer, QOverload<>::of(&QTimer::start));
+        connect(m_item, &QQuickItem::yChanged, &m_previewItemUpdateTimer, QOverload<>::of(&QTimer::start));
+        connect(m_item, &QQuickItem::widthChanged, &m_previewItemUpdateTimer,
                 QOverload<>::of(&QTimer::start));
-        connect(m_item, &QQuickItem::heightChanged, &m_jsonUpdateTimer,
+        connect(m_item, &QQuickItem::heightChanged, &m_previewItemUpdateTimer,
                 QOverload<>::of(&QTimer::start));
 
         connect(m_item, &QQuickItem::xChanged, this, &BoundingBoxItem::determineVisibility);
@@ -318,31 +247,31 @@ BoundingBoxItem::BoundingBoxItem(QObject *parent)
     connect(this, &BoundingBoxItem::itemRectChanged, this, &BoundingBoxItem::requestReevaluation);
     connect(this, &BoundingBoxItem::itemRectChanged, this, &BoundingBoxItem::determineVisibility);
 
-    connect(this, &BoundingBoxItem::stackOrderChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::stackOrderChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::itemRectChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::itemRectChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::previewEnabledChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::previewEnabledChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::previewFillColorChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::previewFillColorChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::previewBorderColorChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::previewBorderColorChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::previewBorderWidthChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::previewBorderWidthChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::previewImageSourceChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::previewImageSourceChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::livePreviewChanged, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::livePreviewChanged, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
-    connect(this, &BoundingBoxItem::previewUpdated, &m_jsonUpdateTimer,
+    connect(this, &BoundingBoxItem::previewUpdated, &m_previewItemUpdateTimer,
             QOverload<>::of(&QTimer::start));
 
-    m_jsonUpdateTimer.setInterval(0);
-    m_jsonUpdateTimer.setSingleShot(true);
-    connect(&m_jsonUpdateTimer, &QTimer::timeout, this, [=]() {
-        m_json = this->toJson();
+    m_previewItemUpdateTimer.setInterval(0);
+    m_previewItemUpdateTimer.setSingleShot(true);
+    connect(&m_previewItemUpdateTimer, &QTimer::timeout, this, [=]() {
+        m_previewItem = this->createPreviewItem();
         if (m_evaluator)
-            m_evaluator->markPreviewDirty();
+            m_evaluator->updatePreviewItem(this);
     });
 }
 
@@ -389,6 +318,7 @@ void BoundingBoxItem::setEvaluator(BoundingBoxEvaluator *val)
         m_evaluator->addItem(this);
 
     this->updatePreviewLater();
+    m_previewItemUpdateTimer.start();
 
     emit evaluatorChanged();
 }
@@ -446,34 +376,25 @@ void BoundingBoxItem::setPreviewImageSource(const QString &val)
     if (val.isEmpty()) {
         if (!m_staticPreview.isNull()) {
             m_staticPreview = QImage();
-            m_jsonUpdateTimer.start();
+            m_previewItemUpdateTimer.start();
         }
 
         return;
     }
 
-    auto loadImage = [](const QString &url, const QSize &size) -> QImage {
-        if (url.isEmpty())
-            return QImage();
-
-        QString filePath = url;
-        if (filePath.contains("://"))
-            filePath = QUrl(url).toLocalFile();
-        if (filePath.isEmpty())
-            return QImage();
-
-        QImage image(filePath);
-        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        return image;
-    };
+    QString filePath = val;
+    if (filePath.contains("://"))
+        filePath = QUrl(val).toLocalFile();
+    if (filePath.isEmpty())
+        return;
 
     QFutureWatcher<QImage> *futureWatcher = new QFutureWatcher<QImage>(this);
     connect(futureWatcher, &QFutureWatcher<QImage>::finished, this, [=]() {
         m_staticPreview = futureWatcher->result();
-        m_jsonUpdateTimer.start();
+        m_previewItemUpdateTimer.start();
         futureWatcher->deleteLater();
     });
-    futureWatcher->setFuture(QtConcurrent::run(loadImage, val, QSize(128, 128)));
+    futureWatcher->setFuture(ThumbnailCache::loadAsync(filePath, QSize(128, 128)));
 }
 
 void BoundingBoxItem::setPreviewBorderColor(const QColor &val)
@@ -558,34 +479,18 @@ void BoundingBoxItem::markPreviewDirty()
     this->updatePreviewLater();
 }
 
-QJsonObject BoundingBoxItem::toJson() const
+BoundingBoxPreviewItem BoundingBoxItem::createPreviewItem() const
 {
-    QJsonObject ret;
-
-    ret.insert(QStringLiteral("stackOrder"), m_stackOrder);
-    ret.insert(QStringLiteral("previewFillColor"), m_previewFillColor.name(QColor::HexArgb));
-    ret.insert(QStringLiteral("previewBorderColor"), m_previewBorderColor.name(QColor::HexArgb));
-    ret.insert(QStringLiteral("previewBorderWidth"), m_previewBorderWidth);
-    ret.insert(QStringLiteral("livePreview"), m_livePreview);
-
-    const QRectF bRect = this->boundingRect();
+    BoundingBoxPreviewItem ret;
+    ret.rect = this->boundingRect();
+    ret.stackOrder = m_stackOrder;
+    ret.fillColor = m_previewFillColor;
+    ret.borderColor = m_previewBorderColor;
+    ret.borderWidth = m_previewBorderWidth;
 
-    QJsonObject jsRect;
-    jsRect.insert(QStringLiteral("x"), bRect.x());
-    jsRect.insert(QStringLiteral("y"), bRect.y());
-    jsRect.insert(QStringLiteral("width"), bRect.width());
-    jsRect.insert(QStringLiteral("height"), bRect.height());
-    ret.insert(QStringLiteral("boundingRect"), jsRect);
-
-    if (m_livePreview || !m_staticPreview.isNull()) {
-        const QImage &preview = m_preview.isNull() ? m_staticPreview : m_preview;
-        QByteArray bytes;
-        QBuffer buffer(&bytes);
-        buffer.open(QIODevice::WriteOnly);
-        preview.save(&buffer, "PNG"); // writes image into ba in PNG format
-        bytes = bytes.toBase64();
-        ret.insert(QStringLiteral("preview"), QString::fromLatin1(bytes));
-    }
+    // QImage is implicitly shared, so this doesn't copy pixels.
+    if (m_livePreview || !m_staticPreview.isNull())
+        ret.image = m_preview.isNull() ? m_staticPreview : m_preview;
 
     return ret;
 }
@@ -733,13 +638,19 @@ void BoundingBoxItem::determineVisibility()
     emit itemVisibilityChanged();
 }
 
-void BoundingBoxItem::updateJson()
-{
-    m_json = this->toJson();
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * The preview is cached as a grid of square tiles, each TileSize device pixels wide.
+ * When items on the canvas change, only tiles intersecting their old and new rectangles
+ * are rendered again. The device pixel ratio of tiles is lowered, if needed, to keep
+ * the whole preview within MaxPreviewBytes.
+ */
+static const int TileSize = 256;
+static const qreal MaxPreviewDevicePixelRatio = 2.0;
+static const qreal MinPreviewDevicePixelRatio = 0.5;
+static const qint64 MaxPreviewBytes = 32 * 1024 * 1024;
+
 BoundingBoxPreview::BoundingBoxPreview(QQuickItem *parent)
     : QQuickPaintedItem(parent), m_evaluator(this, "evaluator")
 {
@@ -755,7 +666,7 @@ void BoundingBoxPreview::setBackgroundColor(const QColor &val)
     m_backgroundColor = val;
     emit backgroundColorChanged();
 
-    this->update();
+    this->updatePreviewImage();
 }
 
 void BoundingBoxPreview::setBackgroundOpacity(qreal val)
@@ -766,7 +677,7 @@ void BoundingBoxPreview::setBackgroundOpacity(qreal val)
     m_backgroundOpacity = val;
     emit backgroundOpacityChanged();
 
-    this->update();
+    this->updatePreviewImage();
 }
 
 void BoundingBoxPreview::setEvaluator(BoundingBoxEvaluator *val)
@@ -786,6 +697,13 @@ void BoundingBoxPreview::setEvaluator(BoundingBoxEvaluator *val)
 
     emit evaluatorChanged();
 
+    // Tiles of the previous evaluator are of no use anymore.
+    m_tiles.clear();
+    m_dirtyTiles.clear();
+    m_tileLayout = TileLayout();
+    ++m_tileLayoutRevision;
+
+    this->updatePreviewImage();
     this->update();
 }
 
@@ -798,78 +716,95 @@ void BoundingBoxPreview::paint(QPainter *painter)
     if (m_evaluator == nullptr || !this->isVisible() || qFuzzyIsNull(this->opacity()))
         return;
 
-    painter->drawImage(0, 0, m_previewImage);
+    /**
+     * Why cache the preview in QImage tiles? Why not QPicture?
+     * --------------------------------------------------------
+     *
+     * Painting a QPicture on screen takes more time than painting a
+     * QImage. When measured on a MacBook Pro, I noticed that painting
+     * a QPicture takes 19ms per paint, whereas painting QImage
+     * takes only 328us. So painting a QImage is ~60 times faster than
+     * painting an image.
+     *
+     * Tiles further let us redraw only those parts of the preview that
+     * changed, instead of replaying all items each time a card moves.
+     */
+    for (auto it = m_tiles.constBegin(); it != m_tiles.constEnd(); ++it) {
+        const QImage &tile = it.value();
+        const qreal dpr = tile.devicePixelRatio();
+        painter->drawImage(QPointF(it.key().x() * TileSize / dpr, it.key().y() * TileSize / dpr),
+                           tile);
+    }
 }
 
 void BoundingBoxPreview::updatePreviewImage()
 {
-    if (m_evaluator == nullptr || this->isUpdatingPreview())
+    if (m_evaluator == nullptr)
         return;
 
-    auto capturePreviewAsImage = [=](QPicture preview, const QSize &itemSize, const QColor &bgColor,
-                                     qreal bgOpacity) -> QImage {
-        if (itemSize.isEmpty())
-            return QImage();
+    const TileLayout layout = this->evaluateTileLayout();
+    if (layout != m_tileLayout || m_evaluator->isPreviewFullyDirty()) {
+        if (layout != m_tileLayout) {
+            m_tileLayout = layout;
+            ++m_tileLayoutRevision;
+        }
 
-        const QRectF pictureRect(0, 0, itemSize.width(), itemSize.height());
+        // Existing tiles are retained until their replacements are ready, so that
+        // the preview doesn't go blank in the meantime.
+        const QSet<QPoint> allTiles = m_tileLayout.allTiles();
+        m_tiles.removeIf([allTiles](const QHash<QPoint, QImage>::iterator &it) {
+            return !allTiles.contains(it.key());
+        });
+        m_dirtyTiles = allTiles;
+    } else {
+        const QList<QRectF> dirtyRects = m_evaluator->previewDirtyRects();
+        for (const QRectF &rect : dirtyRects)
+            m_dirtyTiles.unite(m_tileLayout.tilesIntersecting(rect));
+    }
 
-        /**
-         * Why capture the preview in a QImage now? Why not QPicture?
-         * ----------------------------------------------------------
-         *
-         * Painting a QPicture on screen takes more time than painting a
-         * QImage. When measured on a MacBook Pro, I noticed that painting
-         * a QPicture takes 19ms per paint, whereas painting QImage
-         * takes only 328us. So painting a QImage is ~60 times faster than
-         * painting an image.
-         *
-         * If we take 19ms to paint a QPicture in BoundingBoxPreview::paint()
-         * we are using that time along with drawing of other times on the
-         * screen. Bad idea right?
-         */
-
-        QImage image((pictureRect.size() * 2.0).toSize(), QImage::Format_ARGB32);
-        image.setDevicePixelRatio(2.0);
-        image.fill(Qt::transparent);
-
-        if (preview.isNull())
-            return image;
-
-        QPainter painter(&image);
-        if (!painter.isActive())
-            return image;
-
-        painter.setOpacity(bgOpacity);
-        painter.fillRect(pictureRect, bgColor);
-        painter.setOpacity(1.0);
-
-        QSizeF previewSize = preview.boundingRect().size();
-        previewSize.scale(pictureRect.size(), Qt::KeepAspectRatio);
-
-        QRectF previewRect(QPointF(0, 0), previewSize);
-        // previewRect.moveCenter(itemRect.center());
-
-        painter.translate(previewRect.topLeft());
-
-        const qreal sx = previewSize.width() / preview.boundingRect().width();
-        const qreal sy = previewSize.height() / preview.boundingRect().height();
-        painter.scale(sx, sy);
-
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-        preview.play(&painter);
+    this->renderDirtyTiles();
+}
 
-        return image;
+void BoundingBoxPreview::renderDirtyTiles()
+{
+    if (m_evaluator == nullptr || this->isUpdatingPreview() || m_dirtyTiles.isEmpty())
+        return;
+
+    const QList<QPoint> tiles = m_dirtyTiles.values();
+    m_dirtyTiles.clear();
+
+    auto renderTiles = [](const QList<QPoint> &tiles, const TileLayout &layout,
+                          const QList<BoundingBoxPreviewItem> &items) -> QHash<QPoint, QImage> {
+        QHash<QPoint, QImage> ret;
+        for (const QPoint &tile : tiles)
+            ret.insert(tile, BoundingBoxPreview::renderTile(tile, layout, items));
+        return ret;
     };
 
-    QFuture<QImage> future = QtConcurrent::run(
-            &m_evaluator->m_threadPool, capturePreviewAsImage, m_evaluator->preview(),
-            QSizeF(this->width(), this->height()).toSize(), m_backgroundColor, m_backgroundOpacity);
-    QFutureWatcher<QImage> *futureWatcher = new QFutureWatcher<QImage>(this);
-    connect(futureWatcher, &QFutureWatcher<QImage>::finished, this, [=]() {
-        m_previewImage = future.result();
+    const int layoutRevision = m_tileLayoutRevision;
+    QFuture<QHash<QPoint, QImage>> future =
+            QtConcurrent::run(&m_evaluator->m_threadPool, renderTiles, tiles, m_tileLayout,
+                              m_evaluator->previewItems());
+    QFutureWatcher<QHash<QPoint, QImage>> *futureWatcher =
+            new QFutureWatcher<QHash<QPoint, QImage>>(this);
+    connect(futureWatcher, &QFutureWatcher<QHash<QPoint, QImage>>::finished, this, [=]() {
         futureWatcher->deleteLater();
-        this->update();
+
+        // If the layout changed while tiles were being rendered, the result is of no
+        // use. All tiles of the new layout would have been marked dirty already.
+        if (layoutRevision == m_tileLayoutRevision) {
+            const QHash<QPoint, QImage> renderedTiles = future.result();
+            for (auto it = renderedTiles.constBegin(); it != renderedTiles.constEnd(); ++it) {
+                if (it.value().isNull())
+                    m_tiles.remove(it.key());
+                else
+                    m_tiles.insert(it.key(), it.value());
+            }
+            this->update();
+        }
+
+        m_updatePreviewFutureWatcher = nullptr;
+        this->renderDirtyTiles();
     });
     futureWatcher->setFuture(future);
 
@@ -880,8 +815,154 @@ void BoundingBoxPreview::updatePreviewImage()
     emit isUpdatingPreviewChanged();
 }
 
+BoundingBoxPreview::TileLayout BoundingBoxPreview::evaluateTileLayout() const
+{
+    TileLayout ret;
+    ret.sourceRect = m_evaluator == nullptr ? QRectF() : m_evaluator->boundingBox();
+    ret.size = QSizeF(this->width(), this->height());
+    ret.backgroundColor = m_backgroundColor;
+    ret.backgroundOpacity = m_backgroundOpacity;
+
+    // Cap memory used by tiles by lowering resolution for very large previews.
+    const qreal area = ret.size.width() * ret.size.height();
+    ret.devicePixelRatio = MaxPreviewDevicePixelRatio;
+    if (area > 0) {
+        const qreal maxRatio = qSqrt(qreal(MaxPreviewBytes) / (area * 4));
+        ret.devicePixelRatio =
+                qBound(MinPreviewDevicePixelRatio, maxRatio, MaxPreviewDevicePixelRatio);
+    }
+
+    return ret;
+}
+
+QImage BoundingBoxPreview::renderTile(const QPoint &tile, const TileLayout &layout,
+                                      const QList<BoundingBoxPreviewItem> &items)
+{
+    const qreal scale = layout.scale();
+    if (qFuzzyIsNull(scale))
+        return QImage();
+
+    const qreal dpr = layout.devicePixelRatio;
+    const QRectF pictureRect(QPointF(0, 0), layout.size);
+    const QRectF tileRect(tile.x() * TileSize / dpr, tile.y() * TileSize / dpr, TileSize / dpr,
+                          TileSize / dpr);
+    const QRectF tileSourceRect(layout.sourceRect.topLeft() + tileRect.topLeft() / scale,
+                                tileRect.size() / scale);
+
+    QImage image(TileSize, TileSize, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    if (!painter.isActive())
+        return image;
+
+    painter.translate(-tileRect.topLeft());
+
+    painter.setOpacity(layout.backgroundOpacity);
+    painter.fillRect(pictureRect.intersected(tileRect), layout.backgroundColor);
+    painter.setOpacity(1.0);
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.scale(scale, scale);
+    painter.translate(-layout.sourceRect.topLeft());
+
+    for (const BoundingBoxPreviewItem &item : items) {
+        // Leave room for border strokes, which are drawn centered on the item's edges.
+        const qreal margin = (item.borderWidth + 2) / (scale * dpr);
+        if (!item.rect.adjusted(-margin, -margin, margin, margin).intersects(tileSourceRect))
+            continue;
+
+        if (!item.image.isNull())
+            painter.drawImage(item.rect, item.image);
+        else if (item.borderColor.alpha() > 0 || item.fillColor.alpha() > 0) {
+            QPen pen(item.borderColor);
+            pen.setCosmetic(true);
+            pen.setWidthF(item.borderWidth);
+
+            painter.setPen(pen);
+            painter.setBrush(QBrush(item.fillColor));
+            painter.drawRect(item.rect);
+        }
+    }
+
+    painter.end();
+
+    return image;
+}
+
+bool BoundingBoxPreview::TileLayout::operator==(const TileLayout &other) const
+{
+    return sourceRect == other.sourceRect && size == other.size
+            && qFuzzyCompare(devicePixelRatio, other.devicePixelRatio)
+            && backgroundColor == other.backgroundColor
+            && qFuzzyCompare(backgroundOpacity, other.backgroundOpacity);
+}
+
+qreal BoundingBoxPreview::TileLayout::scale() const
+{
+    // Source rect is scaled to fit the preview, while retaining aspect ratio.
+    if (sourceRect.isEmpty() || size.isEmpty())
+        return 0;
+
+    return qMin(size.width() / sourceRect.width(), size.height() / sourceRect.height());
+}
+
+QSize BoundingBoxPreview::TileLayout::tileGridSize() const
+{
+    if (size.isEmpty())
+        return QSize(0, 0);
+
+    return QSize(qCeil(size.width() * devicePixelRatio / TileSize),
+                 qCeil(size.height() * devicePixelRatio / TileSize));
+}
+
+QSet<QPoint> BoundingBoxPreview::TileLayout::tilesIntersecting(const QRectF &canvasRect) const
+{
+    QSet<QPoint> ret;
+
+    const qreal scale = this->scale();
+    const QSize gridSize = this->tileGridSize();
+    if (qFuzzyIsNull(scale) || gridSize.isEmpty())
+        return ret;
+
+    // Map canvas rect to device pixels of the preview, with some slack for borders
+    // and antialiasing.
+    QRectF deviceRect((canvasRect.topLeft() - sourceRect.topLeft()) * scale * devicePixelRatio,
+                      canvasRect.size() * scale * devicePixelRatio);
+    deviceRect.adjust(-4, -4, 4, 4);
+
+    const int left = qMax(0, qFloor(deviceRect.left() / TileSize));
+    const int top = qMax(0, qFloor(deviceRect.top() / TileSize));
+    const int right = qMin(gridSize.width() - 1, qFloor(deviceRect.right() / TileSize));
+    const int bottom = qMin(gridSize.height() - 1, qFloor(deviceRect.bottom() / TileSize));
+    for (int x = left; x <= right; x++)
+        for (int y = top; y <= bottom; y++)
+            ret.insert(QPoint(x, y));
+
+    return ret;
+}
+
+QSet<QPoint> BoundingBoxPreview::TileLayout::allTiles() const
+{
+    QSet<QPoint> ret;
+
+    const QSize gridSize = this->tileGridSize();
+    for (int x = 0; x < gridSize.width(); x++)
+        for (int y = 0; y < gridSize.height(); y++)
+            ret.insert(QPoint(x, y));
+
+    return ret;
+}
+
 void BoundingBoxPreview::resetEvaluator()
 {
     m_evaluator = nullptr;
     emit evaluatorChanged();
+
+    m_tiles.clear();
+    m_dirtyTiles.clear();
+    ++m_tileLayoutRevision;
+    this->update();
 }
@@ -18,16 +18,15 @@
 
 #include "execlatertimer.h"
 
+#include <QSet>
+#include <QHash>
 #include <QRectF>
 #include <QImage>
-#include <QMutex>
 #include <QObject>
-#include <QPicture>
 #include <QPointer>
 #include <QQmlEngine>
 #include <QQuickItem>
 #include <QThreadPool>
-#include <QJsonObject>
 #include <QQuickPaintedItem>
 #include <QFutureWatcherBase>
 
@@ -40,6 +39,22 @@
  * why this class.
  */
 class BoundingBoxItem;
+
+/**
+ * Snapshot of what a BoundingBoxItem contributes to the preview. Snapshots are plain
+ * values, so they can be handed over to the thread that renders preview tiles without
+ * worrying about the lifetime of the BoundingBoxItem itself.
+ */
+struct BoundingBoxPreviewItem
+{
+    QRectF rect;
+    qreal stackOrder = 0;
+    QImage image;
+    QColor fillColor;
+    QColor borderColor;
+    qreal borderWidth = 1;
+};
+
 class BoundingBoxEvaluator : public QObject
 {
     Q_OBJECT
@@ -167,7 +182,13 @@ public:
     int itemCount() const { return m_items.size(); }
     Q_SIGNAL void itemCountChanged();
 
-    QPicture preview() const;
+    // Preview items sorted by stack order, and the canvas rectangles that changed since
+    // the previous previewUpdated() signal. If isPreviewFullyDirty() returns true, the
+    // whole preview must be redrawn.
+    QList<BoundingBoxPreviewItem> previewItems() const;
+    QList<QRectF> previewDirtyRects() const { return m_previewDirtyRects; }
+    bool isPreviewFullyDirty() const { return m_previewFullyDirty; }
+
     Q_INVOKABLE void markPreviewDirty();
     Q_SIGNAL void previewUpdated();
 
@@ -181,29 +202,32 @@ protected:
     void evaluateNow();
 
     void updatePreview();
-    static QPicture createPreviewPicture(const QList<QJsonObject> &items, const QRectF &bbox,
-                                         const qreal scale);
 
 private:
     void addItem(BoundingBoxItem *item);
     void removeItem(BoundingBoxItem *item);
     void markDirty(BoundingBoxItem *) { this->evaluateLater(); }
+    void updatePreviewItem(BoundingBoxItem *item);
+    void markPreviewRectDirty(const QRectF &rect);
 
 private:
     friend class BoundingBoxItem;
     friend class BoundingBoxPreview;
 
     qreal m_margin = 0;
-    QPicture m_preview;
     qreal m_previewScale = 1.0;
     QRectF m_initialRect;
     QRectF m_boundingBox;
     QRectF m_tightBoundingBox;
     QThreadPool m_threadPool;
-    mutable QMutex m_previewLock;
     ExecLaterTimer m_evaluationTimer;
     ExecLaterTimer m_updatePreviewTimer;
     QList<BoundingBoxItem *> m_items;
+    QHash<BoundingBoxItem *, BoundingBoxPreviewItem> m_previewItems;
+    QList<QRectF> m_pendingPreviewDirtyRects;
+    bool m_pendingPreviewFullyDirty = true;
+    QList<QRectF> m_previewDirtyRects;
+    bool m_previewFullyDirty = true;
 };
 
 class BoundingBoxItem : public QObject
@@ -374,7 +398,7 @@ public:
 
     Q_SIGNAL void itemVisibilityChanged();
 
-    QJsonObject asJson() const { return m_json; }
+    BoundingBoxPreviewItem previewItem() const { return m_previewItem; }
 
 protected:
     void timerEvent(QTimerEvent *event);
@@ -387,8 +411,7 @@ private:
     void updatePreviewLater();
     void setPreview(const QImage &image);
     void determineVisibility();
-    void updateJson();
-    QJsonObject toJson() const;
+    BoundingBoxPreviewItem createPreviewItem() const;
 
 private:
     QImage m_preview;
@@ -398,8 +421,8 @@ private:
     bool m_livePreview = true;
     bool m_previewEnabled = true;
     QRectF m_viewportRect;
-    QJsonObject m_json;
-    QTimer m_jsonUpdateTimer;
+    BoundingBoxPreviewItem m_previewItem;
+    QTimer m_previewItemUpdateTimer;
     QPointer<QQuickItem> m_item;
     QString m_previewImageSource;
     qreal m_previewBorderWidth = 1;
@@ -466,12 +489,35 @@ public:
 
 private:
     void updatePreviewImage();
+    void renderDirtyTiles();
     void resetEvaluator();
 
+    struct TileLayout
+    {
+        QRectF sourceRect; // in canvas coordinates
+        QSizeF size; // in item coordinates
+        qreal devicePixelRatio = 0;
+        QColor backgroundColor;
+        qreal backgroundOpacity = 1.0;
+
+        bool operator==(const TileLayout &other) const;
+        bool operator!=(const TileLayout &other) const { return !(*this == other); }
+        qreal scale() const;
+        QSize tileGridSize() const;
+        QSet<QPoint> tilesIntersecting(const QRectF &canvasRect) const;
+        QSet<QPoint> allTiles() const;
+    };
+    TileLayout evaluateTileLayout() const;
+    static QImage renderTile(const QPoint &tile, const TileLayout &layout,
+                             const QList<BoundingBoxPreviewItem> &items);
+
 private:
-    QImage m_previewImage;
     QColor m_backgroundColor = Qt::white;
     qreal m_backgroundOpacity = 1.0;
+    TileLayout m_tileLayout;
+    int m_tileLayoutRevision = 0;
+    QHash<QPoint, QImage> m_tiles;
+    QSet<QPoint> m_dirtyTiles;
     QPointer<QFutureWatcherBase> m_updatePreviewFutureWatcher;
     QObjectProperty<BoundingBoxEvaluator> m_evaluator;
 };
@@ -53,10 +53,12 @@ GridBackgroundItem::GridBackgroundItem(QQuickItem *parent) : QQuickItem(parent)
 {
     this->setFlag(ItemHasContents);
 
-    connect(this, &GridBackgroundItem::opacityChanged, this, &GridBackgroundItem::update);
-    connect(this, &GridBackgroundItem::tickColorOpacityChanged, this, &GridBackgroundItem::update);
-    connect(m_border, &GridBackgroundItemBorder::colorChanged, this, &GridBackgroundItem::update);
-    connect(m_border, &GridBackgroundItemBorder::widthChanged, this, &GridBackgroundItem::update);
+    connect(this, &GridBackgroundItem::opacityChanged, this,
+            [=]() { this->markDirty(BackgroundDirty | TickStyleDirty | BorderDirty); });
+    connect(m_border, &GridBackgroundItemBorder::colorChanged, this,
+            [=]() { this->markDirty(BorderDirty); });
+    connect(m_border, &GridBackgroundItemBorder::widthChanged, this,
+            [=]() { this->markDirty(BorderDirty); });
 }
 
 GridBackgroundItem::~GridBackgroundItem() { }
@@ -69,7 +71,7 @@ void GridBackgroundItem::setTickDistance(qreal val)
     m_tickDistance = val;
     emit tickDistanceChanged();
 
-    this->update();
+    this->markDirty(TicksDirty);
 }
 
 void GridBackgroundItem::setMajorTickStride(int val)
@@ -80,7 +82,7 @@ void GridBackgroundItem::setMajorTickStride(int val)
     m_majorTickStride = val;
     emit majorTickStrideChanged();
 
-    this->update();
+    this->markDirty(TicksDirty);
 }
 
 void GridBackgroundItem::setMinorTickLineWidth(qreal val)
@@ -91,7 +93,7 @@ void GridBackgroundItem::setMinorTickLineWidth(qreal val)
     m_minorTickLineWidth = val;
     emit minorTickLineWidthChanged();
 
-    this->update();
+    this->markDirty(TickStyleDirty);
 }
 
 void GridBackgroundItem::setMajorTickLineWidth(qreal val)
@@ -102,7 +104,7 @@ void GridBackgroundItem::setMajorTickLineWidth(qreal val)
     m_majorTickLineWidth = val;
     emit majorTickLineWidthChanged();
 
-    this->update();
+    this->markDirty(TickStyleDirty);
 }
 
 void GridBackgroundItem::setMinorTickColor(const QColor &val)
@@ -113,7 +115,7 @@ void GridBackgroundItem::setMinorTickColor(const QColor &val)
     m_minorTickColor = val;
     emit minorTickColorChanged();
 
-    this->update();
+    this->markDirty(TickStyleDirty);
 }
 
 void GridBackgroundItem::setMajorTickColor(const QColor &val)
@@ -124,7 +126,7 @@ void GridBackgroundItem::setMajorTickColor(const QColor &val)
     m_majorTickColor = val;
     emit majorTickColorChanged();
 
-    this->update();
+    this->markDirty(TickStyleDirty);
 }
 
 void GridBackgroundItem::setTickColorOpacity(qreal val)
@@ -136,7 +138,7 @@ void GridBackgroundItem::setTickColorOpacity(qreal val)
     m_tickColorOpacity = val;
     emit tickColorOpacityChanged();
 
-    this->update();
+    this->markDirty(TickStyleDirty);
 }
 
 void GridBackgroundItem::setGridIsVisible(bool val)
@@ -147,7 +149,7 @@ void GridBackgroundItem::setGridIsVisible(bool val)
     m_gridIsVisible = val;
     emit gridIsVisibleChanged();
 
-    this->update();
+    this->markDirty(TicksDirty);
 }
 
 void GridBackgroundItem::setBackgroundColor(const QColor &val)
@@ -158,76 +160,88 @@ void GridBackgroundItem::setBackgroundColor(const QColor &val)
     m_backgroundColor = val;
     emit backgroundColorChanged();
 
-    this->update();
+    this->markDirty(BackgroundDirty);
+}
+
+void GridBackgroundItem::setVisibleArea(const QRectF &val)
+{
+    if (m_visibleArea == val)
+        return;
+
+    m_visibleArea = val;
+    emit visibleAreaChanged();
+
+    // Panning within the margin around the visible area that the grid was generated
+    // for doesn't need new geometry, and hence not even a repaint.
+    if (m_gridIsVisible && this->isTickAreaStale())
+        this->markDirty(TicksDirty);
 }
 
 QSGNode *GridBackgroundItem::updatePaintNode(QSGNode *oldNode,
                                              QQuickItem::UpdatePaintNodeData *nodeData)
 {
-#ifndef QT_NO_DEBUG_OUTPUT
-    qDebug("GridBackgroundItem is painting.");
-#endif
-
     Q_UNUSED(nodeData)
 
-    // Always recreate the scene graph to ensure proper rendering
-    // when child items move or when properties change
-    if (oldNode) {
-        delete oldNode;
-        oldNode = nullptr;
-    }
+    enum { BackgroundNode, MinorTicksNode, MajorTicksNode, BorderNode, NodeCount };
 
-    QSGNode *rootNode = new QSGNode;
-    const qreal w = this->width();
-    const qreal h = this->height();
-
-    {
-        if (!qFuzzyIsNull(m_backgroundColor.alphaF())) {
+    QSGNode *rootNode = oldNode;
+    if (rootNode == nullptr) {
+        rootNode = new QSGNode;
+        for (int i = 0; i < NodeCount; i++) {
             QSGGeometryNode *geometryNode = new QSGGeometryNode;
             geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial
                                    | QSGNode::OwnedByParent);
-            rootNode->appendChildNode(geometryNode);
 
-            QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 6);
-            geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+            QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+            geometry->setDrawingMode(i == BackgroundNode ? QSGGeometry::DrawTriangles
+                                                         : QSGGeometry::DrawLines);
             geometryNode->setGeometry(geometry);
 
-            QSGGeometry::Point2D *points = geometry->vertexDataAsPoint2D();
+            QSGFlatColorMaterial *material = new QSGFlatColorMaterial();
+            material->setFlag(QSGMaterial::Blending);
+            geometryNode->setMaterial(material);
 
-            points[0].x = 0.0f;
-            points[0].y = 0.0f;
+            rootNode->appendChildNode(geometryNode);
+        }
 
-            points[1].x = float(w);
-            points[1].y = 0.0f;
+        m_dirtyFlags = AllDirty;
+    }
 
-            points[2].x = 0.0f;
-            points[2].y = float(h);
+    if (m_dirtyFlags == 0)
+        return rootNode;
 
-            points[3].x = 0.0f;
-            points[3].y = float(h);
+#ifndef QT_NO_DEBUG_OUTPUT
+    qDebug("GridBackgroundItem is painting.");
+#endif
 
-            points[4].x = float(w);
-            points[4].y = 0.0f;
+    const qreal w = this->width();
+    const qreal h = this->height();
 
-            points[5].x = float(w);
-            points[5].y = float(h);
+    auto geometryNodeAt = [rootNode](int index) {
+        return static_cast<QSGGeometryNode *>(rootNode->childAtIndex(index));
+    };
 
-            QSGFlatColorMaterial *material = new QSGFlatColorMaterial();
-            geometryNode->setMaterial(material);
+    auto setNodeColor = [](QSGGeometryNode *geometryNode, const QColor &color, qreal opacity) {
+        QColor finalColor = color;
+        finalColor.setAlphaF(color.alphaF() * opacity);
 
-            QColor color = m_backgroundColor;
-            color.setAlphaF(color.alphaF() * this->opacity());
-            material->setFlag(QSGMaterial::Blending);
-            material->setColor(color);
+        QSGFlatColorMaterial *material =
+                static_cast<QSGFlatColorMaterial *>(geometryNode->material());
+        if (material->color() != finalColor) {
+            material->setColor(finalColor);
+            geometryNode->markDirty(QSGNode::DirtyMaterial);
         }
-    }
-
-    if (!m_gridIsVisible || qFuzzyIsNull(m_tickColorOpacity))
-        return rootNode;
+    };
 
-    const int majorTickStride = qMax(1, m_majorTickStride);
-    QVector<QSGGeometry::Point2D> minorTickVertices;
-    QVector<QSGGeometry::Point2D> majorTickVertices;
+    auto setNodeVertices = [](QSGGeometryNode *geometryNode,
+                              const QVector<QSGGeometry::Point2D> &vertices) {
+        QSGGeometry *geometry = geometryNode->geometry();
+        geometry->allocate(vertices.size());
+        if (!vertices.isEmpty())
+            memcpy(geometry->vertexDataAsPoint2D(), vertices.constData(),
+                   vertices.size() * sizeof(QSGGeometry::Point2D));
+        geometryNode->markDirty(QSGNode::DirtyGeometry);
+    };
 
     auto appendLine = [](QVector<QSGGeometry::Point2D> &vertices, qreal x1, qreal y1, qreal x2,
                          qreal y2) {
@@ -237,140 +251,140 @@ QSGNode *GridBackgroundItem::updatePaintNode(QSGNode *oldNode,
         vertices.append(p2);
     };
 
-    {
-        qreal x = m_tickDistance;
-        int xLineIndex = 1;
-        while (x <= w) {
-            if (xLineIndex % majorTickStride == 0)
-                appendLine(majorTickVertices, x, 0.0, x, h);
-            else
-                appendLine(minorTickVertices, x, 0.0, x, h);
-
-            x += m_tickDistance;
-            ++xLineIndex;
-        }
-    }
+    if (m_dirtyFlags & BackgroundDirty) {
+        QSGGeometryNode *geometryNode = geometryNodeAt(BackgroundNode);
 
-    {
-        qreal y = m_tickDistance;
-        int yLineIndex = 1;
-        while (y <= h) {
-            if (yLineIndex % majorTickStride == 0)
-                appendLine(majorTickVertices, 0.0, y, w, y);
-            else
-                appendLine(minorTickVertices, 0.0, y, w, y);
-
-            y += m_tickDistance;
-            ++yLineIndex;
+        QVector<QSGGeometry::Point2D> vertices;
+        if (!qFuzzyIsNull(m_backgroundColor.alphaF())) {
+            vertices.reserve(6);
+            vertices.append({ 0.0f, 0.0f });
+            vertices.append({ float(w), 0.0f });
+            vertices.append({ 0.0f, float(h) });
+            vertices.append({ 0.0f, float(h) });
+            vertices.append({ float(w), 0.0f });
+            vertices.append({ float(w), float(h) });
         }
-    }
-
-    {
-        QSGNode *minorTicksNode = new QSGOpacityNode;
-        minorTicksNode->setFlags(QSGNode::OwnedByParent);
-        rootNode->appendChildNode(minorTicksNode);
-
-        QSGGeometryNode *geometryNode = new QSGGeometryNode;
-        geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial
-                               | QSGNode::OwnedByParent);
-
-        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(),
-                                                minorTickVertices.size());
-        geometry->setDrawingMode(QSGGeometry::DrawLines);
-        geometry->setLineWidth(float(m_minorTickLineWidth));
-        geometryNode->setGeometry(geometry);
 
-        QSGGeometry::Point2D *points = geometry->vertexDataAsPoint2D();
-        for (int i = 0; i < minorTickVertices.size(); ++i)
-            points[i] = minorTickVertices.at(i);
-
-        QSGFlatColorMaterial *material = new QSGFlatColorMaterial();
-        geometryNode->setMaterial(material);
-
-        QColor color = m_minorTickColor;
-        color.setAlphaF(color.alphaF() * m_tickColorOpacity * this->opacity());
-        material->setFlag(QSGMaterial::Blending);
-        material->setColor(color);
-
-        minorTicksNode->appendChildNode(geometryNode);
+        setNodeVertices(geometryNode, vertices);
+        setNodeColor(geometryNode, m_backgroundColor, this->opacity());
     }
 
-    {
-        QSGNode *majorTicksNode = new QSGOpacityNode;
-        majorTicksNode->setFlags(QSGNode::OwnedByParent);
-        rootNode->appendChildNode(majorTicksNode);
-
-        QSGGeometryNode *geometryNode = new QSGGeometryNode;
-        geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial
-                               | QSGNode::OwnedByParent);
-
-        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(),
-                                                majorTickVertices.size());
-        geometry->setDrawingMode(QSGGeometry::DrawLines);
-        geometry->setLineWidth(float(m_majorTickLineWidth));
-        geometryNode->setGeometry(geometry);
+    if (m_dirtyFlags & TicksDirty) {
+        QVector<QSGGeometry::Point2D> minorTickVertices;
+        QVector<QSGGeometry::Point2D> majorTickVertices;
+
+        m_tickArea = QRectF();
+        if (m_gridIsVisible && m_tickDistance > 0)
+            m_tickArea = this->evaluateTickArea();
+
+        if (!m_tickArea.isEmpty()) {
+            // Lines are generated only for ticks that fall within the tick area, and
+            // only span the tick area. Tick positions are computed from their index,
+            // so that they're at the same place no matter which area is generated.
+            const int majorTickStride = qMax(1, m_majorTickStride);
+
+            const int firstX = qMax(1, qCeil(m_tickArea.left() / m_tickDistance));
+            const int lastX = qFloor(qMin(w, m_tickArea.right()) / m_tickDistance);
+            for (int i = firstX; i <= lastX; i++) {
+                const qreal x = i * m_tickDistance;
+                appendLine(i % majorTickStride ? minorTickVertices : majorTickVertices, x,
+                           m_tickArea.top(), x, m_tickArea.bottom());
+            }
+
+            const int firstY = qMax(1, qCeil(m_tickArea.top() / m_tickDistance));
+            const int lastY = qFloor(qMin(h, m_tickArea.bottom()) / m_tickDistance);
+            for (int i = firstY; i <= lastY; i++) {
+                const qreal y = i * m_tickDistance;
+                appendLine(i % majorTickStride ? minorTickVertices : majorTickVertices,
+                           m_tickArea.left(), y, m_tickArea.right(), y);
+            }
+        }
 
-        QSGGeometry::Point2D *points = geometry->vertexDataAsPoint2D();
-        for (int i = 0; i < majorTickVertices.size(); ++i)
-            points[i] = majorTickVertices.at(i);
+        setNodeVertices(geometryNodeAt(MinorTicksNode), minorTickVertices);
+        setNodeVertices(geometryNodeAt(MajorTicksNode), majorTickVertices);
+    }
 
-        QSGFlatColorMaterial *material = new QSGFlatColorMaterial();
-        geometryNode->setMaterial(material);
+    if (m_dirtyFlags & TickStyleDirty) {
+        const qreal tickOpacity = m_tickColorOpacity * this->opacity();
 
-        QColor color = m_majorTickColor;
-        color.setAlphaF(color.alphaF() * m_tickColorOpacity * this->opacity());
-        material->setFlag(QSGMaterial::Blending);
-        material->setColor(color);
+        QSGGeometryNode *minorTicksNode = geometryNodeAt(MinorTicksNode);
+        minorTicksNode->geometry()->setLineWidth(float(m_minorTickLineWidth));
+        minorTicksNode->markDirty(QSGNode::DirtyGeometry);
+        setNodeColor(minorTicksNode, m_minorTickColor, tickOpacity);
 
-        majorTicksNode->appendChildNode(geometryNode);
+        QSGGeometryNode *majorTicksNode = geometryNodeAt(MajorTicksNode);
+        majorTicksNode->geometry()->setLineWidth(float(m_majorTickLineWidth));
+        majorTicksNode->markDirty(QSGNode::DirtyGeometry);
+        setNodeColor(majorTicksNode, m_majorTickColor, tickOpacity);
     }
 
-    if (!qFuzzyIsNull(m_border->width())) {
-        QSGNode *borderNode = new QSGOpacityNode;
-        borderNode->setFlags(QSGNode::OwnedByParent);
-        rootNode->appendChildNode(borderNode);
-
-        QSGGeometryNode *geometryNode = new QSGGeometryNode;
-        geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial
-                               | QSGNode::OwnedByParent);
+    if (m_dirtyFlags & BorderDirty) {
+        QSGGeometryNode *geometryNode = geometryNodeAt(BorderNode);
+
+        QVector<QSGGeometry::Point2D> vertices;
+        if (!qFuzzyIsNull(m_border->width())) {
+            const float r = float(w) - 1.0f;
+            const float b = float(h) - 1.0f;
+            appendLine(vertices, 0.0f, 0.0f, r, 0.0f);
+            appendLine(vertices, r, 0.0f, r, b);
+            appendLine(vertices, r, b, 0.0f, b);
+            appendLine(vertices, 0.0f, b, 0.0f, 0.0f);
+        }
 
-        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 8);
-        geometry->setDrawingMode(QSGGeometry::DrawLines);
-        geometry->setLineWidth(float(m_border->width()));
-        geometryNode->setGeometry(geometry);
+        geometryNode->geometry()->setLineWidth(float(m_border->width()));
+        setNodeVertices(geometryNode, vertices);
+        setNodeColor(geometryNode, m_border->color(), this->opacity());
+    }
 
-        QSGGeometry::Point2D *points = geometry->vertexDataAsPoint2D();
+    m_dirtyFlags = 0;
+    return rootNode;
+}
 
-        points[0].x = 0.0f;
-        points[0].y = 0.0f;
-        points[1].x = float(w) - 1.0f;
-        points[1].y = 0.0f;
+void GridBackgroundItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
 
-        points[2].x = float(w) - 1.0f;
-        points[2].y = 0.0f;
-        points[3].x = float(w) - 1.0f;
-        points[3].y = float(h) - 1.0f;
+    if (newGeometry.size() != oldGeometry.size())
+        this->markDirty(AllDirty & ~TickStyleDirty);
+}
 
-        points[4].x = float(w) - 1.0f;
-        points[4].y = float(h) - 1.0f;
-        points[5].x = 0.0f;
-        points[5].y = float(h) - 1.0f;
+void GridBackgroundItem::markDirty(int flags)
+{
+    m_dirtyFlags |= flags;
+    this->update();
+}
 
-        points[6].x = 0.0f;
-        points[6].y = float(h) - 1.0f;
-        points[7].x = 0.0f;
-        points[7].y = 0.0f;
+QRectF GridBackgroundItem::evaluateTickArea() const
+{
+    const QRectF itemRect(0, 0, this->width(), this->height());
+    if (!m_visibleArea.isValid())
+        return itemRect;
+
+    const QRectF visibleRect = m_visibleArea & itemRect;
+    if (visibleRect.isEmpty())
+        return QRectF();
+
+    // Generate for half a viewport more on every side, so that panning doesn't require
+    // new geometry until it crosses that margin.
+    const qreal dx = visibleRect.width() / 2;
+    const qreal dy = visibleRect.height() / 2;
+    return visibleRect.adjusted(-dx, -dy, dx, dy) & itemRect;
+}
 
-        QSGFlatColorMaterial *material = new QSGFlatColorMaterial();
-        geometryNode->setMaterial(material);
+bool GridBackgroundItem::isTickAreaStale() const
+{
+    const QRectF itemRect(0, 0, this->width(), this->height());
+    if (!m_visibleArea.isValid())
+        return m_tickArea != itemRect;
 
-        QColor color = m_border->color();
-        color.setAlphaF(color.alphaF() * this->opacity());
-        material->setFlag(QSGMaterial::Blending);
-        material->setColor(color);
+    const QRectF visibleRect = m_visibleArea & itemRect;
+    if (visibleRect.isEmpty())
+        return false;
 
-        borderNode->appendChildNode(geometryNode);
-    }
+    if (!m_tickArea.contains(visibleRect))
+        return true;
 
-    return rootNode;
+    // After zooming in, the grid may cover far more than what's around the viewport.
+    return m_tickArea.width() > visibleRect.width() * 4
+            || m_tickArea.height() > visibleRect.height() * 4;
 }
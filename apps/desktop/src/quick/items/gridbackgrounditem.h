@@ -166,9 +166,34 @@ public:
     QColor backgroundColor() const { return m_backgroundColor; }
     Q_SIGNAL void backgroundColorChanged();
 
+    // Part of the item, in its own coordinates, that is visible on screen. When set, grid
+    // lines are generated only in and around this area, instead of across the whole item.
+    // clang-format off
+    Q_PROPERTY(QRectF visibleArea
+               READ visibleArea
+               WRITE setVisibleArea
+               NOTIFY visibleAreaChanged)
+    // clang-format on
+    void setVisibleArea(const QRectF &val);
+    QRectF visibleArea() const { return m_visibleArea; }
+    Q_SIGNAL void visibleAreaChanged();
+
 protected:
     // QQuickItem interface
     QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *nodeData);
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry);
+
+private:
+    enum DirtyFlag {
+        BackgroundDirty = 1,
+        TicksDirty = 2,
+        TickStyleDirty = 4,
+        BorderDirty = 8,
+        AllDirty = BackgroundDirty | TicksDirty | TickStyleDirty | BorderDirty
+    };
+    void markDirty(int flags);
+    QRectF evaluateTickArea() const;
+    bool isTickAreaStale() const;
 
 private:
     bool m_gridIsVisible = true;
@@ -181,6 +206,10 @@ private:
     QColor m_majorTickColor = QColor("blue");
     QColor m_backgroundColor = QColor(Qt::transparent);
     GridBackgroundItemBorder *m_border = new GridBackgroundItemBorder(this);
+
+    QRectF m_visibleArea;
+    int m_dirtyFlags = AllDirty;
+    QRectF m_tickArea; // area covered by the tick geometry in the scene graph
 };
 
 #endif // GRIDBACKGROUNDITEM_H
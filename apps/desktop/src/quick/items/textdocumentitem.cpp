@@ -20,6 +20,8 @@
 #include <QTimer>
 #include <QPainter>
 #include <QQuickWindow>
+#include <QTextCursor>
+#include <QTextFrame>
 #include <QQuickPaintedItem>
 #include <QAbstractTextDocumentLayout>
 
@@ -29,20 +31,27 @@ public:
     explicit TextDocumentViewportItem(TextDocumentItem *parent);
     ~TextDocumentViewportItem();
 
-    void setViewportImage(const QImage &image)
+    // Each tile is placed at the given y, in this item's coordinates.
+    void setTiles(const QList<QPair<qreal, QImage>> &tiles)
     {
-        m_image = image;
+        m_tiles = tiles;
         this->update();
     }
-    QImage viewportImage() const { return m_image; }
+    QList<QPair<qreal, QImage>> tiles() const { return m_tiles; }
 
     // QQuickPaintedItem interface
     void paint(QPainter *painter);
 
 private:
-    QImage m_image;
+    QList<QPair<qreal, QImage>> m_tiles;
 };
 
+// Height of each tile in device independent pixels, irrespective of the document scale.
+static const qreal TextDocumentTileHeight = 512.0;
+
+// Number of tiles retained above and below the viewport, for scrolling back.
+static const int TextDocumentSpareTileCount = 4;
+
 TextDocumentItem::TextDocumentItem(QQuickItem *parent) : QQuickItem(parent)
 {
     this->setFlag(ItemHasContents, false);
@@ -70,15 +79,23 @@ void TextDocumentItem::setDocument(QTextDocument *val)
 
     if (m_document) {
         m_document->disconnect(m_documentChangeHandler);
+        disconnect(m_document, nullptr, this, nullptr);
         if (m_document->parent() == this)
             m_document->deleteLater();
     }
 
     m_document = val;
+    m_tiles.clear();
+    m_tileRevision = -1;
+    m_editedFrom = -1;
+    m_editedUntil = -1;
     emit documentChanged();
 
-    if (m_document)
+    if (m_document) {
+        connect(m_document, &QTextDocument::contentsChange, this,
+                &TextDocumentItem::onDocumentContentsChange);
         connect(m_document, SIGNAL(contentsChanged()), m_documentChangeHandler, SLOT(start()));
+    }
 
     m_documentChangeHandler->start();
 }
@@ -149,15 +166,13 @@ void TextDocumentItem::updateViewport()
             (m_flickable == nullptr ? 0 : m_flickable->property("contentY").toDouble())
             - m_verticalPadding;
 
-    const qreal x = 0;
     const qreal y = contentY / m_documentScale;
     const qreal width = qMin(m_document->textWidth(), maxViewportDim);
     const qreal height = (qMin(m_flickable == nullptr ? this->height()
                                                       : (m_flickable->height() + m_verticalPadding),
                                maxViewportDim))
             / m_documentScale;
-    const QRectF rect(x, y, width, height);
-    if (rect.isEmpty()) {
+    if (width <= 0 || height <= 0) {
         m_viewportItem->setVisible(false);
         return;
     }
@@ -165,26 +180,44 @@ void TextDocumentItem::updateViewport()
     const qreal dpr = this->window() ? this->window()->devicePixelRatio() : 1.0;
     const QSizeF viewportSize(width * m_documentScale, height * m_documentScale);
 
-    QImage image((viewportSize * dpr).toSize(), QImage::Format_ARGB32);
-    image.setDevicePixelRatio(dpr);
-    image.fill(Qt::transparent);
-
-    QPainter paint;
-    paint.begin(&image);
-    paint.scale(m_documentScale, m_documentScale);
-    paint.translate(-x, -y);
-    paint.setRenderHint(QPainter::Antialiasing);
-    paint.setRenderHint(QPainter::TextAntialiasing);
-
-    QAbstractTextDocumentLayout *layout = m_document->documentLayout();
-
-    QAbstractTextDocumentLayout::PaintContext ctx;
-    ctx.clip = rect;
-    layout->draw(&paint, ctx);
+    // Tiles are rasterized for a specific scale, device pixel ratio and width. They are
+    // also dropped if the document changed in ways that onDocumentContentsChange() didn't
+    // get to account for.
+    if (!qFuzzyCompare(m_tileScale, m_documentScale) || !qFuzzyCompare(m_tileDpr, dpr)
+        || !qFuzzyCompare(m_tileWidth, width) || m_tileRevision != m_document->revision()) {
+        m_tiles.clear();
+        m_tileScale = m_documentScale;
+        m_tileDpr = dpr;
+        m_tileWidth = width;
+        m_tileRevision = m_document->revision();
+        m_editedFrom = -1;
+        m_editedUntil = -1;
+    } else
+        this->invalidateEditedTiles();
+    m_tileDocumentHeight = m_document->size().height();
+
+    // Only newly exposed tiles are drawn; the rest are reused from earlier scroll steps.
+    const qreal tileHeight = this->tileHeight();
+    const int firstTile = qMax(0, qFloor(y / tileHeight));
+    const int lastTile = qMax(firstTile, qFloor((y + height) / tileHeight));
+
+    QList<QPair<qreal, QImage>> tiles;
+    for (int i = firstTile; i <= lastTile; i++) {
+        auto it = m_tiles.find(i);
+        if (it == m_tiles.end())
+            it = m_tiles.insert(i, this->renderTile(i, width, dpr));
+        tiles.append(qMakePair((i * tileHeight - y) * m_documentScale, it.value()));
+    }
 
-    paint.end();
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        if (it.key() < firstTile - TextDocumentSpareTileCount
+            || it.key() > lastTile + TextDocumentSpareTileCount)
+            it = m_tiles.erase(it);
+        else
+            ++it;
+    }
 
-    m_viewportItem->setViewportImage(image);
+    m_viewportItem->setTiles(tiles);
 
     m_viewportItem->setX(qMax((this->width() - viewportSize.width()) / 2, 0.0));
     m_viewportItem->setY(contentY);
@@ -208,6 +241,115 @@ void TextDocumentItem::onDocumentChanged()
     this->updateViewport();
 }
 
+void TextDocumentItem::onDocumentContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_document == nullptr)
+        return;
+
+    const bool tilesWereCurrent = m_tileRevision >= 0;
+    m_tileRevision = m_document->revision();
+    if (m_tiles.isEmpty() || !tilesWereCurrent)
+        return;
+
+    // The document is yet to be laid out again, so block geometry at this point is stale.
+    // Only the edited range is noted here, tiles are invalidated in updateViewport().
+    const int editedUntil = position + charsAdded;
+    if (m_editedFrom < 0) {
+        m_editedFrom = position;
+        m_editedUntil = editedUntil;
+    } else {
+        if (position <= m_editedUntil)
+            m_editedUntil += charsAdded - charsRemoved;
+        m_editedFrom = qMin(m_editedFrom, position);
+        m_editedUntil = qMax(m_editedUntil, editedUntil);
+    }
+
+    m_viewportUpdateHandler->start();
+}
+
+void TextDocumentItem::invalidateEditedTiles()
+{
+    if (m_editedFrom < 0)
+        return;
+
+    const int editedFrom = m_editedFrom;
+    const int editedUntil = m_editedUntil;
+    m_editedFrom = -1;
+    m_editedUntil = -1;
+
+    QAbstractTextDocumentLayout *layout = m_document->documentLayout();
+
+    const QTextBlock fromBlock = m_document->findBlock(editedFrom);
+    const QTextBlock untilBlock = m_document->findBlock(editedUntil);
+    if (!fromBlock.isValid() || QTextCursor(fromBlock).currentFrame() != m_document->rootFrame()
+        || (untilBlock.isValid()
+            && QTextCursor(untilBlock).currentFrame() != m_document->rootFrame())) {
+        // Block geometry within tables and frames is not something we can reliably
+        // map to tiles, so we simply start over.
+        m_tiles.clear();
+        return;
+    }
+
+    // Querying geometry here lays out the document, if it isn't already.
+    const qreal fromY = layout->blockBoundingRect(fromBlock).top();
+    const qreal documentHeight = m_document->size().height();
+
+    // If the document's height changed, everything after the change has moved.
+    if (!untilBlock.isValid() || !qFuzzyCompare(documentHeight, m_tileDocumentHeight)) {
+        this->invalidateTiles(fromY, -1);
+        return;
+    }
+
+    this->invalidateTiles(fromY, layout->blockBoundingRect(untilBlock).bottom());
+}
+
+qreal TextDocumentItem::tileHeight() const
+{
+    return TextDocumentTileHeight / m_documentScale;
+}
+
+QImage TextDocumentItem::renderTile(int index, qreal width, qreal dpr) const
+{
+    const qreal tileHeight = this->tileHeight();
+    const QRectF rect(0, index * tileHeight, width, tileHeight);
+    const QSizeF tileSize(width * m_documentScale, TextDocumentTileHeight);
+
+    QImage image((tileSize * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+
+    QPainter paint;
+    paint.begin(&image);
+    paint.scale(m_documentScale, m_documentScale);
+    paint.translate(-rect.x(), -rect.y());
+    paint.setRenderHint(QPainter::Antialiasing);
+    paint.setRenderHint(QPainter::TextAntialiasing);
+
+    QAbstractTextDocumentLayout *layout = m_document->documentLayout();
+
+    QAbstractTextDocumentLayout::PaintContext ctx;
+    ctx.clip = rect;
+    layout->draw(&paint, ctx);
+
+    paint.end();
+
+    return image;
+}
+
+void TextDocumentItem::invalidateTiles(qreal fromY, qreal toY)
+{
+    const qreal tileHeight = this->tileHeight();
+    const int firstTile = qFloor(fromY / tileHeight);
+    const int lastTile = toY < 0 ? std::numeric_limits<int>::max() : qFloor(toY / tileHeight);
+
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        if (it.key() >= firstTile && it.key() <= lastTile)
+            it = m_tiles.erase(it);
+        else
+            ++it;
+    }
+}
+
 TextDocumentViewportItem::TextDocumentViewportItem(TextDocumentItem *parent)
     : QQuickPaintedItem(parent)
 {
@@ -217,5 +359,6 @@ TextDocumentViewportItem::~TextDocumentViewportItem() { }
 
 void TextDocumentViewportItem::paint(QPainter *painter)
 {
-    painter->drawImage(0, 0, m_image);
+    for (const QPair<qreal, QImage> &tile : std::as_const(m_tiles))
+        painter->drawImage(QPointF(0, tile.first), tile.second);
 }
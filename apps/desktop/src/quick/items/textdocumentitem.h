@@ -16,6 +16,8 @@
 #ifndef TEXTDOCUMENTITEM_H
 #define TEXTDOCUMENTITEM_H
 
+#include <QHash>
+#include <QImage>
 #include <QQuickItem>
 #include <QTextDocument>
 
@@ -82,6 +84,14 @@ public:
 private:
     void updateViewport();
     void onDocumentChanged();
+    void onDocumentContentsChange(int position, int charsRemoved, int charsAdded);
+
+    // The document is rasterized into horizontal tiles, which are kept around for as long
+    // as the scale, device pixel ratio, text width and the blocks they show don't change.
+    qreal tileHeight() const;
+    QImage renderTile(int index, qreal width, qreal dpr) const;
+    void invalidateTiles(qreal fromY, qreal toY);
+    void invalidateEditedTiles();
 
 private:
     bool m_invertColors = false;
@@ -92,6 +102,19 @@ private:
     QTimer *m_viewportUpdateHandler = nullptr;
     QTimer *m_documentChangeHandler = nullptr;
     TextDocumentViewportItem *m_viewportItem = nullptr;
+
+    QHash<int, QImage> m_tiles;
+    qreal m_tileScale = 0;
+    qreal m_tileDpr = 0;
+    qreal m_tileWidth = 0;
+    int m_tileRevision = -1;
+    qreal m_tileDocumentHeight = 0;
+
+    // Range of characters edited since tiles were last brought up to date. Tiles can only
+    // be mapped to it after the document is laid out again, which happens after
+    // contentsChange() is emitted.
+    int m_editedFrom = -1;
+    int m_editedUntil = -1;
 };
 
 #endif // TEXTDOCUMENTITEM_H
@@ -17,6 +17,7 @@
 
 #include "application.h"
 #include "attachments.h"
+#include "thumbnailcache.h"
 #include "scritedocument.h"
 
 #include <QPainter>
@@ -60,9 +61,7 @@ QImage BasicFileIconProvider::requestImage(const QFileInfo &fi)
     if (type == Attachment::Photo) {
         const QString absFilePath =
                 ScriteDocument::instance()->fileSystem()->absolutePath(fi.filePath());
-        QImage image(absFilePath);
-        image = image.scaled(96, 96, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        return image;
+        return ThumbnailCache::load(absFilePath, QSize(96, 96), Qt::KeepAspectRatioByExpanding);
     }
 
     static const QMap<Attachment::Type, QString> typeIconBase = {
@@ -15,6 +15,7 @@
 
 #include "modelaggregator.h"
 
+#include <QRectF>
 #include <QTimerEvent>
 
 ModelAggregator::ModelAggregator(QObject *parent) : QObject(parent), m_model(this, "model") { }
@@ -28,32 +29,29 @@ void ModelAggregator::setModel(QAbstractItemModel *val)
 
     if (!m_model.isNull()) {
         disconnect(m_model, &QAbstractItemModel::rowsInserted, this,
-                   &ModelAggregator::evaluateAggregateValueLater);
+                   &ModelAggregator::onRowsInserted);
         disconnect(m_model, &QAbstractItemModel::rowsRemoved, this,
-                   &ModelAggregator::evaluateAggregateValueLater);
-        disconnect(m_model, &QAbstractItemModel::rowsMoved, this,
-                   &ModelAggregator::evaluateAggregateValueLater);
+                   &ModelAggregator::onRowsRemoved);
+        disconnect(m_model, &QAbstractItemModel::rowsMoved, this, &ModelAggregator::onRowsMoved);
         disconnect(m_model, &QAbstractItemModel::dataChanged, this,
-                   &ModelAggregator::evaluateAggregateValueLater);
+                   &ModelAggregator::onDataChanged);
         disconnect(m_model, &QAbstractItemModel::modelReset, this,
-                   &ModelAggregator::evaluateAggregateValueLater);
+                   &ModelAggregator::onModelReset);
     }
 
     m_model = val;
 
     if (!m_model.isNull()) {
         connect(m_model, &QAbstractItemModel::rowsInserted, this,
-                &ModelAggregator::evaluateAggregateValueLater);
-        connect(m_model, &QAbstractItemModel::rowsRemoved, this,
-                &ModelAggregator::evaluateAggregateValueLater);
-        connect(m_model, &QAbstractItemModel::rowsMoved, this,
-                &ModelAggregator::evaluateAggregateValueLater);
-        connect(m_model, &QAbstractItemModel::dataChanged, this,
-                &ModelAggregator::evaluateAggregateValueLater);
-        connect(m_model, &QAbstractItemModel::modelReset, this,
-                &ModelAggregator::evaluateAggregateValueLater);
+                &ModelAggregator::onRowsInserted);
+        connect(m_model, &QAbstractItemModel::rowsRemoved, this, &ModelAggregator::onRowsRemoved);
+        connect(m_model, &QAbstractItemModel::rowsMoved, this, &ModelAggregator::onRowsMoved);
+        connect(m_model, &QAbstractItemModel::dataChanged, this, &ModelAggregator::onDataChanged);
+        connect(m_model, &QAbstractItemModel::modelReset, this, &ModelAggregator::onModelReset);
     }
 
+    this->onModelReset();
+
     emit modelChanged();
 
     if (m_rootIndex.isValid() && m_rootIndex.model() != m_model)
@@ -71,6 +69,8 @@ void ModelAggregator::setRootIndex(const QModelIndex &val)
         return;
 
     m_rootIndex = val;
+    this->onModelReset();
+
     emit rootIndexChanged();
 }
 
@@ -80,15 +80,26 @@ void ModelAggregator::setColumn(int val)
         return;
 
     m_column = val;
+    this->onModelReset();
+
     emit columnChanged();
 }
 
+void ModelAggregator::setReducer(Reducer reducer, ValueFunction valueFunction)
+{
+    m_reducer = reducer;
+    m_valueFunction = valueFunction;
+    this->onModelReset();
+}
+
 void ModelAggregator::setInitialValue(const QVariant &val)
 {
     if (m_initialValue == val)
         return;
 
     m_initialValue = val;
+    this->evaluateAggregateValueLater();
+
     emit initialValueChanged();
 }
 
@@ -122,11 +133,57 @@ void ModelAggregator::setAggregateValue(const QVariant &val)
 void ModelAggregator::resetModel()
 {
     m_model = nullptr;
+    this->onModelReset();
+
     emit modelChanged();
 }
 
 void ModelAggregator::evaluateAggregateValue()
 {
+    if (this->isIncremental()) {
+        if (m_model.isNull()) {
+            this->setAggregateValue(QVariant());
+            return;
+        }
+
+        if (m_staleRowCount > 0) {
+            for (int i = 0; i < m_rowValues.size(); i++) {
+                RowValue &rowValue = m_rowValues[i];
+                if (!rowValue.stale)
+                    continue;
+
+                rowValue.stale = false;
+
+                const QModelIndex index = m_model->index(i, m_column, m_rootIndex);
+                const QVariant value = m_valueFunction(index);
+                if (rowValue.counted && rowValue.value == value)
+                    continue;
+
+                this->excludeRowValue(rowValue);
+                rowValue.value = value;
+                this->includeRowValue(rowValue);
+            }
+
+            m_staleRowCount = 0;
+        }
+
+        if (m_extremeDirty) {
+            m_extreme = QVariant();
+            m_extremeDirty = false;
+            for (const RowValue &rowValue : std::as_const(m_rowValues)) {
+                if (rowValue.counted)
+                    this->extendExtreme(rowValue.value);
+            }
+        }
+
+        QVariant avalue = this->reducedValue();
+        if (m_finalizeFunction)
+            m_finalizeFunction(avalue);
+
+        this->setAggregateValue(avalue);
+        return;
+    }
+
     if (m_aggregateFunction == nullptr || m_model.isNull()) {
         this->setAggregateValue(QVariant());
         return;
@@ -148,8 +205,229 @@ void ModelAggregator::evaluateAggregateValue()
 
 void ModelAggregator::evaluateAggregateValueLater()
 {
-    if (m_aggregateFunction != nullptr && m_model != nullptr)
+    if ((m_aggregateFunction != nullptr || this->isIncremental()) && m_model != nullptr)
         m_evaluateTimer.start(m_delay, this);
     else
         m_evaluateTimer.stop();
 }
+
+bool ModelAggregator::isIncremental() const
+{
+    return m_reducer != CustomReducer && m_valueFunction != nullptr;
+}
+
+void ModelAggregator::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (this->isIncremental()) {
+        if (parent != m_rootIndex)
+            return;
+
+        // Values are fetched when the timer fires, by when the inserted
+        // objects are usually fully configured.
+        for (int i = first; i <= last; i++)
+            m_rowValues.insert(i, RowValue());
+        m_staleRowCount += last - first + 1;
+    }
+
+    this->evaluateAggregateValueLater();
+}
+
+void ModelAggregator::onRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (this->isIncremental()) {
+        if (parent != m_rootIndex)
+            return;
+
+        for (int i = last; i >= first; i--) {
+            RowValue &rowValue = m_rowValues[i];
+            if (rowValue.stale)
+                --m_staleRowCount;
+            this->excludeRowValue(rowValue);
+            m_rowValues.removeAt(i);
+        }
+    }
+
+    this->evaluateAggregateValueLater();
+}
+
+void ModelAggregator::onRowsMoved(const QModelIndex &parent, int start, int end,
+                                  const QModelIndex &destination, int row)
+{
+    if (this->isIncremental()) {
+        if (parent != m_rootIndex || destination != m_rootIndex) {
+            if (parent == m_rootIndex || destination == m_rootIndex)
+                this->onModelReset();
+            return;
+        }
+
+        // Moving rows doesn't change any of the reductions, only which row
+        // each cached value belongs to.
+        const QList<RowValue> moved = m_rowValues.mid(start, end - start + 1);
+        m_rowValues.remove(start, moved.size());
+
+        const int to = row > start ? row - moved.size() : row;
+        for (int i = 0; i < moved.size(); i++)
+            m_rowValues.insert(to + i, moved.at(i));
+        return;
+    }
+
+    this->evaluateAggregateValueLater();
+}
+
+void ModelAggregator::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (this->isIncremental()) {
+        if (topLeft.parent() != m_rootIndex)
+            return;
+
+        const int last = qMin(bottomRight.row(), m_rowValues.size() - 1);
+        for (int i = qMax(topLeft.row(), 0); i <= last; i++) {
+            RowValue &rowValue = m_rowValues[i];
+            if (!rowValue.stale) {
+                rowValue.stale = true;
+                ++m_staleRowCount;
+            }
+        }
+    }
+
+    this->evaluateAggregateValueLater();
+}
+
+void ModelAggregator::onModelReset()
+{
+    this->resetRowValues();
+    this->evaluateAggregateValueLater();
+}
+
+void ModelAggregator::resetRowValues()
+{
+    m_rowValues.clear();
+    m_staleRowCount = 0;
+    m_includedCount = 0;
+    m_sum = 0;
+    m_extreme = QVariant();
+    m_extremeDirty = false;
+
+    if (!this->isIncremental() || m_model.isNull())
+        return;
+
+    m_rowValues.resize(m_model->rowCount(m_rootIndex));
+    m_staleRowCount = m_rowValues.size();
+}
+
+void ModelAggregator::includeRowValue(RowValue &rowValue)
+{
+    rowValue.counted = rowValue.value.isValid();
+    if (!rowValue.counted)
+        return;
+
+    ++m_includedCount;
+
+    switch (m_reducer) {
+    case SumReducer:
+    case AverageReducer:
+        m_sum += rowValue.value.toDouble();
+        break;
+    case MinimumReducer:
+    case MaximumReducer:
+    case UnitedRectReducer:
+        if (!m_extremeDirty)
+            this->extendExtreme(rowValue.value);
+        break;
+    default:
+        break;
+    }
+}
+
+void ModelAggregator::excludeRowValue(RowValue &rowValue)
+{
+    if (!rowValue.counted)
+        return;
+
+    rowValue.counted = false;
+    if (--m_includedCount == 0)
+        m_sum = 0; // don't let rounding errors outlive the values that caused them
+
+    switch (m_reducer) {
+    case SumReducer:
+    case AverageReducer:
+        if (m_includedCount > 0)
+            m_sum -= rowValue.value.toDouble();
+        break;
+    case MinimumReducer:
+    case MaximumReducer:
+    case UnitedRectReducer:
+        // Only values on the boundary of the extreme can shrink it, and that
+        // requires a pass over the cached values, not over the model.
+        if (!m_extremeDirty && this->isOnExtremeBoundary(rowValue.value))
+            m_extremeDirty = true;
+        break;
+    default:
+        break;
+    }
+}
+
+void ModelAggregator::extendExtreme(const QVariant &value)
+{
+    if (!m_extreme.isValid()) {
+        m_extreme = m_reducer == UnitedRectReducer ? QVariant(value.toRectF()) : value;
+        return;
+    }
+
+    switch (m_reducer) {
+    case MinimumReducer:
+        if (value.toDouble() < m_extreme.toDouble())
+            m_extreme = value;
+        break;
+    case MaximumReducer:
+        if (value.toDouble() > m_extreme.toDouble())
+            m_extreme = value;
+        break;
+    case UnitedRectReducer:
+        m_extreme = m_extreme.toRectF() | value.toRectF();
+        break;
+    default:
+        break;
+    }
+}
+
+bool ModelAggregator::isOnExtremeBoundary(const QVariant &value) const
+{
+    switch (m_reducer) {
+    case MinimumReducer:
+        return value.toDouble() <= m_extreme.toDouble();
+    case MaximumReducer:
+        return value.toDouble() >= m_extreme.toDouble();
+    case UnitedRectReducer: {
+        const QRectF extreme = m_extreme.toRectF();
+        const QRectF rect = value.toRectF();
+        return rect.left() <= extreme.left() || rect.top() <= extreme.top()
+                || rect.right() >= extreme.right() || rect.bottom() >= extreme.bottom();
+    }
+    default:
+        break;
+    }
+
+    return false;
+}
+
+QVariant ModelAggregator::reducedValue() const
+{
+    switch (m_reducer) {
+    case SumReducer:
+        return m_initialValue.toDouble() + m_sum;
+    case CountReducer:
+        return m_initialValue.toInt() + m_includedCount;
+    case AverageReducer:
+        return m_includedCount > 0 ? QVariant(m_sum / m_includedCount) : m_initialValue;
+    case MinimumReducer:
+    case MaximumReducer:
+        return m_extreme.isValid() ? m_extreme : m_initialValue;
+    case UnitedRectReducer:
+        return m_initialValue.toRectF() | m_extreme.toRectF();
+    default:
+        break;
+    }
+
+    return m_initialValue;
+}
@@ -33,6 +33,23 @@ public:
     void setAggregateFunction(AggregateFunction val) { m_aggregateFunction = val; }
     AggregateFunction aggregateFunction() const { return m_aggregateFunction; }
 
+    // Common reductions are maintained incrementally from the row ranges reported by the
+    // model, so that a change to one row costs one ValueFunction call instead of a walk
+    // over all rows. Values that are not valid QVariants are left out of the reduction.
+    enum Reducer {
+        CustomReducer, // uses AggregateFunction, re-evaluated over all rows
+        SumReducer,
+        CountReducer,
+        MinimumReducer,
+        MaximumReducer,
+        AverageReducer,
+        UnitedRectReducer
+    };
+    typedef std::function<QVariant(const QModelIndex &)> ValueFunction;
+    void setReducer(Reducer reducer, ValueFunction valueFunction);
+    Reducer reducer() const { return m_reducer; }
+    ValueFunction valueFunction() const { return m_valueFunction; }
+
     typedef std::function<void(QVariant &)> FinalizeFunction;
     void setFinalizeFunction(FinalizeFunction val) { m_finalizeFunction = val; }
     FinalizeFunction finalizeFunction() const { return m_finalizeFunction; }
@@ -107,6 +124,27 @@ private:
     void evaluateAggregateValue();
     void evaluateAggregateValueLater();
 
+    bool isIncremental() const;
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsMoved(const QModelIndex &parent, int start, int end,
+                     const QModelIndex &destination, int row);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onModelReset();
+
+    struct RowValue
+    {
+        QVariant value;
+        bool counted = false;
+        bool stale = true;
+    };
+    void resetRowValues();
+    void includeRowValue(RowValue &rowValue);
+    void excludeRowValue(RowValue &rowValue);
+    void extendExtreme(const QVariant &value);
+    bool isOnExtremeBoundary(const QVariant &value) const;
+    QVariant reducedValue() const;
+
 private:
     int m_delay = 0;
     int m_column = -1;
@@ -117,6 +155,15 @@ private:
     FinalizeFunction m_finalizeFunction;
     AggregateFunction m_aggregateFunction;
     QObjectProperty<QAbstractItemModel> m_model;
+
+    Reducer m_reducer = CustomReducer;
+    ValueFunction m_valueFunction;
+    QList<RowValue> m_rowValues;
+    int m_staleRowCount = 0;
+    int m_includedCount = 0;
+    qreal m_sum = 0;
+    QVariant m_extreme;
+    bool m_extremeDirty = false;
 };
 
 #endif // MODELAGGREGATOR_H
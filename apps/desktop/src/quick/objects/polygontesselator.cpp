@@ -17,16 +17,46 @@
 
 #include "thirdparty/static/poly2tri/poly2tri.h"
 
-QVector<QPointF> PolygonTessellator::tessellate(const QList<QPolygonF> &polygons)
+#include <QCache>
+#include <QMutex>
+#include <QByteArray>
+#include <QMutexLocker>
+
+#include <vector>
+
+/**
+ * Shapes are often tessellated over and over again with the exact same path, or with a path
+ * that only moved or was uniformly scaled (zoom, geometry changes). Since a constrained Delaunay
+ * triangulation is invariant under translation and uniform scaling, we cache triangles of
+ * polygons normalized to a unit box at the origin, and map them back on the way out.
+ */
+struct TessellationCache
+{
+    QMutex mutex;
+    QCache<QByteArray, QVector<QPointF>> triangles = QCache<QByteArray, QVector<QPointF>>(1 << 18);
+};
+Q_GLOBAL_STATIC(TessellationCache, GlobalTessellationCache)
+
+static QVector<QPointF> triangulate(const QList<QPolygonF> &polygons)
 {
     QVector<QPointF> triangles;
 
-    auto triangulateSegment = [](const QList<QPolygonF> segment) {
+    // Points of a segment are stored in one contiguous block, instead of being allocated
+    // one at a time. The block is reserved upfront, so that pointers into it remain valid.
+    std::vector<p2t::Point> points;
+
+    auto triangulateSegment = [&points](const QList<QPolygonF> segment) {
         QVector<QPointF> ret;
         if (segment.isEmpty())
             return ret;
 
-        QList<p2t::Point *> points;
+        size_t nrPoints = 0;
+        for (const QPolygonF &polygon : segment)
+            nrPoints += polygon.size();
+
+        points.clear();
+        points.reserve(nrPoints);
+
         QList<std::vector<p2t::Point *>> polylines;
 
         QRectF segmentArea;
@@ -34,10 +64,11 @@ QVector<QPointF> PolygonTessellator::tessellate(const QList<QPolygonF> &polygons
             const QPolygonF polygon = segment.at(i);
             const QRectF polygonRect = polygon.boundingRect();
             std::vector<p2t::Point *> polyline;
+            polyline.reserve(polygon.size());
             for (int p = polygon.isClosed() ? 1 : 0; p < polygon.size(); p++) {
                 const QPointF pt = polygon.at(p);
-                points << new p2t::Point(pt.x(), pt.y());
-                polyline.push_back(points.last());
+                points.emplace_back(pt.x(), pt.y());
+                polyline.push_back(&points.back());
             }
 
             if (!segmentArea.isNull() && segmentArea.contains(polygonRect))
@@ -55,6 +86,8 @@ QVector<QPointF> PolygonTessellator::tessellate(const QList<QPolygonF> &polygons
         cdt.Triangulate();
 
         std::vector<p2t::Triangle *> tgls = cdt.GetTriangles();
+        ret.reserve(int(tgls.size()) * 3);
+
         std::vector<p2t::Triangle *>::iterator it = tgls.begin();
         std::vector<p2t::Triangle *>::iterator end = tgls.end();
         while (it != end) {
@@ -67,8 +100,6 @@ QVector<QPointF> PolygonTessellator::tessellate(const QList<QPolygonF> &polygons
             ++it;
         }
 
-        qDeleteAll(points);
-
         return ret;
     };
 
@@ -97,3 +128,55 @@ QVector<QPointF> PolygonTessellator::tessellate(const QList<QPolygonF> &polygons
 
     return triangles;
 }
+
+QVector<QPointF> PolygonTessellator::tessellate(const QList<QPolygonF> &polygons)
+{
+    QRectF area;
+    for (const QPolygonF &polygon : polygons)
+        area |= polygon.boundingRect();
+
+    const qreal scale = qMax(area.width(), area.height());
+    if (polygons.isEmpty() || qFuzzyIsNull(scale))
+        return triangulate(polygons);
+
+    // Normalize polygons to a unit box, and key the cache on their raw coordinates.
+    const QPointF origin = area.topLeft();
+
+    QList<QPolygonF> normalizedPolygons;
+    normalizedPolygons.reserve(polygons.size());
+
+    QByteArray key;
+    for (const QPolygonF &polygon : polygons) {
+        QPolygonF normalizedPolygon(polygon.size());
+        for (int i = 0; i < polygon.size(); i++)
+            normalizedPolygon[i] = (polygon.at(i) - origin) / scale;
+        normalizedPolygons.append(normalizedPolygon);
+
+        const qsizetype size = normalizedPolygon.size();
+        key.append(reinterpret_cast<const char *>(&size), sizeof(size));
+        key.append(reinterpret_cast<const char *>(normalizedPolygon.constData()),
+                   size * sizeof(QPointF));
+    }
+
+    QVector<QPointF> triangles;
+
+    TessellationCache *cache = GlobalTessellationCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        if (const QVector<QPointF> *cachedTriangles = cache->triangles.object(key))
+            triangles = *cachedTriangles;
+    }
+
+    if (triangles.isEmpty()) {
+        triangles = triangulate(normalizedPolygons);
+
+        QMutexLocker locker(&cache->mutex);
+        cache->triangles.insert(key, new QVector<QPointF>(triangles),
+                                qMax(qsizetype(1), triangles.size()));
+    }
+
+    for (QPointF &point : triangles)
+        point = point * scale + origin;
+
+    return triangles;
+}
@@ -18,6 +18,7 @@
 
 #include <QSet>
 #include <QJsonObject>
+#include <QElapsedTimer>
 #include <QTextCursor>
 #include <QTimerEvent>
 
@@ -194,6 +195,7 @@ void SearchAgent::onClearSearchRequest()
 SearchEngine::SearchEngine(QObject *parent)
     : QObject(parent),
       m_searchTimer("SearchEngine.m_searchTimer"),
+      m_pendingSearchTimer("SearchEngine.m_pendingSearchTimer"),
       m_searchAgentSortTimer("SearchEngine.m_searchAgentSortTimer")
 {
 }
@@ -245,6 +247,8 @@ void SearchEngine::replace(const QString &string)
 {
     HourGlass hourGlass;
 
+    this->finishSearch();
+
     if (m_currentSearchResultIndex >= 0 && m_currentSearchResultIndex < m_searchResults.size()) {
         const QPair<SearchAgent *, int> result = m_searchResults.at(m_currentSearchResultIndex);
         if (result.first != nullptr)
@@ -256,6 +260,8 @@ void SearchEngine::replaceAll(const QString &string)
 {
     HourGlass hourGlass;
 
+    this->finishSearch();
+
     if (m_searchResults.isEmpty())
         return;
 
@@ -302,35 +308,47 @@ void SearchEngine::cycleSearchResult()
     }
 }
 
-QJsonArray SearchEngine::indexesOf(const QString &of, const QString &in, int givenFlags)
+QList<QPair<int, int>> SearchEngine::matchRanges(const QString &of, const QString &in,
+                                                 int givenFlags)
 {
+    QList<QPair<int, int>> ret;
+    if (of.isEmpty() || in.length() < of.length())
+        return ret;
+
     SearchEngine::SearchFlags flags(givenFlags);
     Qt::CaseSensitivity cs = Qt::CaseInsensitive;
 
     if (flags.testFlag(SearchEngine::SearchCaseSensitively))
         cs = Qt::CaseSensitive;
 
-    auto createResultItem = [](int from, int to) {
-        QJsonObject item;
-        item.insert("from", from);
-        item.insert("to", to);
-        return item;
-    };
+    const bool wholeWords = flags.testFlag(SearchEngine::SearchWholeWords);
 
-    QJsonArray ret;
     int from = 0;
     while (1) {
         int pos = in.indexOf(of, from, cs);
         if (pos < 0)
             break;
 
-        if (flags.testFlag(SearchEngine::SearchWholeWords)) {
-            if (pos + of.length() >= in.length() || in.at(pos + of.length()).isSpace())
-                ret.append(createResultItem(pos, pos + of.length() - 1));
-        } else
-            ret.append(createResultItem(pos, pos + of.length() - 1));
+        const int end = pos + of.length();
+        if (!wholeWords || end >= in.length() || in.at(end).isSpace())
+            ret.append(qMakePair(pos, end - 1));
 
-        from = pos + of.length();
+        from = end;
+    }
+
+    return ret;
+}
+
+QJsonArray SearchEngine::indexesOf(const QString &of, const QString &in, int flags)
+{
+    const QList<QPair<int, int>> ranges = SearchEngine::matchRanges(of, in, flags);
+
+    QJsonArray ret;
+    for (const QPair<int, int> &range : ranges) {
+        QJsonObject item;
+        item.insert(QStringLiteral("from"), range.first);
+        item.insert(QStringLiteral("to"), range.second);
+        ret.append(item);
     }
 
     return ret;
@@ -359,6 +377,11 @@ void SearchEngine::timerEvent(QTimerEvent *event)
         m_searchTimer.stop();
         this->doSearch();
     }
+
+    if (event->timerId() == m_pendingSearchTimer.timerId()) {
+        m_pendingSearchTimer.stop();
+        this->searchPendingAgents(10);
+    }
 }
 
 void SearchEngine::addSearchAgent(SearchAgent *ptr)
@@ -383,6 +406,7 @@ void SearchEngine::removeSearchAgent(SearchAgent *ptr)
         return;
 
     m_searchAgents.removeAt(index);
+    m_pendingSearchAgents.removeAll(ptr);
 
     const int oldSearchResultCount = m_searchResults.size();
     for (int i = m_searchResults.size() - 1; i >= 0; i--) {
@@ -429,7 +453,11 @@ qsizetype SearchEngine::staticSearchAgentCount(QQmlListProperty<SearchAgent> *li
 
 void SearchEngine::doSearch()
 {
-    HourGlass hourGlass;
+    // Agents yet to be asked belong to a previous search string, which is no longer of
+    // interest.
+    const bool wasSearching = this->isSearching();
+    m_pendingSearchAgents.clear();
+    m_pendingSearchTimer.stop();
 
     if (!m_searchResults.isEmpty()) {
         SearchAgent *agent = nullptr;
@@ -455,27 +483,75 @@ void SearchEngine::doSearch()
         m_searchAgentSortTimer.stop();
     }
 
-    if (m_searchString.isEmpty())
+    if (m_searchString.isEmpty()) {
+        if (wasSearching)
+            emit searchingChanged();
+        return;
+    }
+
+    for (SearchAgent *agent : std::as_const(m_searchAgents))
+        m_pendingSearchAgents.append(agent);
+
+    if (!wasSearching && !m_pendingSearchAgents.isEmpty())
+        emit searchingChanged();
+
+    // Agents are asked to search in sequence, a few at a time, so that the UI remains
+    // responsive and results from agents up front show up before all agents are done.
+    this->searchPendingAgents(10);
+}
+
+void SearchEngine::searchPendingAgents(int timeBudgetMs)
+{
+    if (m_pendingSearchAgents.isEmpty())
         return;
 
-    for (SearchAgent *agent : std::as_const(m_searchAgents)) {
+    QElapsedTimer timer;
+    timer.start();
+
+    const int oldSearchResultCount = m_searchResults.size();
+
+    while (!m_pendingSearchAgents.isEmpty()) {
+        if (timeBudgetMs >= 0 && timer.elapsed() >= timeBudgetMs)
+            break;
+
+        SearchAgent *agent = m_pendingSearchAgents.takeFirst();
+        if (agent == nullptr)
+            continue;
+
         // Ask the agent to perform search
         agent->searchRequest(m_searchString);
 
         // Collect search results
         const int nrResults = agent->searchResultCount();
-        for (int i = 0; i < nrResults; i++) {
-            QPair<SearchAgent *, int> result(agent, i);
-            m_searchResults << result;
-        }
+        m_searchResults.reserve(m_searchResults.size() + nrResults);
+        for (int i = 0; i < nrResults; i++)
+            m_searchResults.append(qMakePair(agent, i));
 
         agent->setCurrentSearchResultIndex(-1);
     }
 
-    emit searchResultCountChanged();
+    if (m_searchResults.size() != oldSearchResultCount) {
+        emit searchResultCountChanged();
 
-    if (!m_searchResults.isEmpty())
-        this->setCurrentSearchResultIndex(0);
+        if (m_currentSearchResultIndex < 0)
+            this->setCurrentSearchResultIndex(0);
+    }
+
+    if (m_pendingSearchAgents.isEmpty())
+        emit searchingChanged();
+    else
+        m_pendingSearchTimer.start(0, this);
+}
+
+void SearchEngine::finishSearch()
+{
+    if (m_searchTimer.isActive()) {
+        m_searchTimer.stop();
+        this->doSearch();
+    }
+
+    m_pendingSearchTimer.stop();
+    this->searchPendingAgents(-1);
 }
 
 void SearchEngine::doSearchLater()
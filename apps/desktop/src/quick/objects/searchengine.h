@@ -17,6 +17,7 @@
 #define SEARCHENGINE_H
 
 #include <QObject>
+#include <QPointer>
 #include <QJsonArray>
 #include <QQmlEngine>
 #include <QQuickTextDocument>
@@ -211,6 +212,14 @@ public:
     int currentSearchResultIndex() const { return m_currentSearchResultIndex; }
     Q_SIGNAL void currentSearchResultIndexChanged();
 
+    // clang-format off
+    Q_PROPERTY(bool searching
+               READ isSearching
+               NOTIFY searchingChanged)
+    // clang-format on
+    bool isSearching() const { return !m_pendingSearchAgents.isEmpty(); }
+    Q_SIGNAL void searchingChanged();
+
     Q_INVOKABLE void replace(const QString &string);
     Q_INVOKABLE void replaceAll(const QString &string);
 
@@ -219,6 +228,8 @@ public:
     Q_INVOKABLE void previousSearchResult();
     Q_INVOKABLE void cycleSearchResult();
 
+    // Returns [from, to] ranges (both inclusive) of all matches of 'of' in 'in'.
+    static QList<QPair<int, int>> matchRanges(const QString &of, const QString &in, int flags);
     static QJsonArray indexesOf(const QString &of, const QString &in, int flags);
     static QString createMarkupText(const QString &text, int from, int to, const QBrush &bg,
                                     const QBrush &fg);
@@ -236,6 +247,8 @@ private:
 
     void doSearch();
     void doSearchLater();
+    void searchPendingAgents(int timeBudgetMs);
+    void finishSearch();
     void setCurrentSearchResultIndex(int val);
 
 private:
@@ -243,12 +256,14 @@ private:
     friend class SearchAgent;
     SearchFlags m_searchFlags;
     ExecLaterTimer m_searchTimer;
+    ExecLaterTimer m_pendingSearchTimer;
     ErrorReport *m_errorReport = new ErrorReport(this);
     int m_currentSearchResultIndex = -1;
     ProgressReport *m_progressReport = new ProgressReport(this);
     ExecLaterTimer m_searchAgentSortTimer;
     QList<SearchAgent *> m_searchAgents;
     QList<QPair<SearchAgent *, int>> m_searchResults;
+    QList<QPointer<SearchAgent>> m_pendingSearchAgents;
 };
 
 class TextDocumentSearch : public QObject
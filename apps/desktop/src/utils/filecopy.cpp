@@ -0,0 +1,252 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "filecopy.h"
+
+#include <QSet>
+#include <QFile>
+#include <QMutex>
+#include <QFileInfo>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#define FILECOPY_HAS_COPY_FILE_RANGE
+#endif
+#endif
+
+#ifdef Q_OS_MACOS
+#include <sys/clonefile.h>
+#endif
+
+#ifdef Q_OS_LINUX
+namespace {
+
+/**
+ * Remembers devices on which reflinks or copy_file_range() are known to be unsupported, so
+ * that copying many files (say while saving a document with lots of attachments) doesn't
+ * create and unlink a destination file on each attempt. Copies may happen in worker threads.
+ */
+struct UnsupportedCopyMethods
+{
+    QMutex mutex;
+    QSet<dev_t> reflinkDevices;
+    QSet<dev_t> copyFileRangeDevices;
+    bool copyFileRangeUnavailable = false; // ENOSYS, true of the whole process
+
+    bool isUnsupported(const QSet<dev_t> &devices, dev_t device)
+    {
+        QMutexLocker locker(&mutex);
+        return devices.contains(device);
+    }
+
+    void markUnsupported(QSet<dev_t> &devices, dev_t device)
+    {
+        QMutexLocker locker(&mutex);
+        devices.insert(device);
+    }
+};
+
+} // namespace
+
+Q_GLOBAL_STATIC(UnsupportedCopyMethods, GlobalUnsupportedCopyMethods)
+
+static inline dev_t deviceOf(const QByteArray &filePath)
+{
+    struct stat st;
+    return ::stat(filePath.constData(), &st) == 0 ? st.st_dev : dev_t(0);
+}
+#endif
+
+bool FileCopy::copy(const QString &fromFile, const QString &toFile, Method *method)
+{
+    if (method)
+        *method = NoMethod;
+
+    if (fromFile.isEmpty() || toFile.isEmpty() || !QFileInfo(fromFile).isFile()
+        || QFile::exists(toFile))
+        return false;
+
+    Method usedMethod = NoMethod;
+    if (reflink(fromFile, toFile))
+        usedMethod = ReflinkMethod;
+    else if (copyFileRange(fromFile, toFile))
+        usedMethod = CopyFileRangeMethod;
+    else if (QFile::copy(fromFile, toFile))
+        usedMethod = PlainCopyMethod;
+    else
+        return false;
+
+    if (method)
+        *method = usedMethod;
+
+    return true;
+}
+
+QString FileCopy::methodName(Method method)
+{
+    switch (method) {
+    case ReflinkMethod:
+        return QStringLiteral("reflink");
+    case CopyFileRangeMethod:
+        return QStringLiteral("copy_file_range");
+    case PlainCopyMethod:
+        return QStringLiteral("copy");
+    default:
+        break;
+    }
+
+    return QStringLiteral("none");
+}
+
+bool FileCopy::reflink(const QString &fromFile, const QString &toFile)
+{
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    const QByteArray src = QFile::encodeName(fromFile);
+    const QByteArray dst = QFile::encodeName(toFile);
+
+    UnsupportedCopyMethods *unsupported = ::GlobalUnsupportedCopyMethods;
+    const dev_t dstDevice = deviceOf(QFile::encodeName(QFileInfo(toFile).absolutePath()));
+    if (unsupported->isUnsupported(unsupported->reflinkDevices, dstDevice))
+        return false;
+
+    const int in = ::open(src.constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(in, &st) != 0) {
+        ::close(in);
+        return false;
+    }
+
+    const int out = ::open(dst.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                           st.st_mode & 0777);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    // Fails with EOPNOTSUPP or EXDEV, unless both files are on the same file system and
+    // that file system supports sharing extents. Only the former is a property of the
+    // destination file system, and worth remembering.
+    const bool success = ::ioctl(out, FICLONE, in) == 0;
+    if (!success && (errno == EOPNOTSUPP || errno == ENOTTY || errno == EINVAL))
+        unsupported->markUnsupported(unsupported->reflinkDevices, dstDevice);
+
+    ::close(out);
+    ::close(in);
+
+    if (!success)
+        ::unlink(dst.constData());
+
+    return success;
+#elif defined(Q_OS_MACOS)
+    // APFS clones files in constant time. Permissions are cloned as well.
+    return ::clonefile(QFile::encodeName(fromFile).constData(),
+                       QFile::encodeName(toFile).constData(), 0)
+            == 0;
+#else
+    Q_UNUSED(fromFile)
+    Q_UNUSED(toFile)
+    return false;
+#endif
+}
+
+bool FileCopy::copyFileRange(const QString &fromFile, const QString &toFile)
+{
+#ifdef FILECOPY_HAS_COPY_FILE_RANGE
+    const QByteArray src = QFile::encodeName(fromFile);
+    const QByteArray dst = QFile::encodeName(toFile);
+
+    UnsupportedCopyMethods *unsupported = ::GlobalUnsupportedCopyMethods;
+    const dev_t dstDevice = deviceOf(QFile::encodeName(QFileInfo(toFile).absolutePath()));
+    {
+        QMutexLocker locker(&unsupported->mutex);
+        if (unsupported->copyFileRangeUnavailable
+            || unsupported->copyFileRangeDevices.contains(dstDevice))
+            return false;
+    }
+
+    const int in = ::open(src.constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(in, &st) != 0) {
+        ::close(in);
+        return false;
+    }
+
+    const int out = ::open(dst.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                           st.st_mode & 0777);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    // The kernel copies data between files directly, and may even reflink or offload the
+    // copy to the storage device where possible.
+    bool success = true;
+    off_t remaining = st.st_size;
+    while (remaining > 0) {
+        const ssize_t copied = ::copy_file_range(in, nullptr, out, nullptr, size_t(remaining), 0);
+        if (copied < 0) {
+            if (errno == EINTR)
+                continue;
+
+            // ENOSYS, EXDEV, EINVAL and the like: let the caller fall back to plain copy.
+            if (errno == ENOSYS) {
+                QMutexLocker locker(&unsupported->mutex);
+                unsupported->copyFileRangeUnavailable = true;
+            } else if (errno == EOPNOTSUPP)
+                unsupported->markUnsupported(unsupported->copyFileRangeDevices, dstDevice);
+
+            success = false;
+            break;
+        }
+
+        // Some file systems (procfs, sysfs and certain FUSE mounts) report no data even
+        // though the source isn't exhausted. The copy is incomplete, so let the caller
+        // fall back to plain copy.
+        if (copied == 0) {
+            success = false;
+            break;
+        }
+
+        remaining -= copied;
+    }
+
+    ::close(out);
+    ::close(in);
+
+    if (!success)
+        ::unlink(dst.constData());
+
+    return success;
+#else
+    Q_UNUSED(fromFile)
+    Q_UNUSED(toFile)
+    return false;
+#endif
+}
@@ -0,0 +1,48 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef FILECOPY_H
+#define FILECOPY_H
+
+#include <QString>
+
+/**
+ * Copies files using the cheapest method the platform and file system can offer.
+ *
+ * On file systems that support it (btrfs, XFS, APFS), the copy is made
+ * as a reflink (copy-on-write clone), which is a metadata-only operation regardless of the
+ * size of the file. On Linux, copy_file_range() is attempted next, which copies within the
+ * kernel without bouncing data through user space. QFile::copy() is the fallback.
+ *
+ * Hard links are deliberately never used, because files in the DFS can be modified in place
+ * (for instance by opening attachments in place), which must never alter the source.
+ *
+ * Like QFile::copy(), this function fails if the destination file already exists.
+ */
+class FileCopy
+{
+public:
+    enum Method { NoMethod, ReflinkMethod, CopyFileRangeMethod, PlainCopyMethod };
+
+    static bool copy(const QString &fromFile, const QString &toFile, Method *method = nullptr);
+    static QString methodName(Method method);
+
+private:
+    FileCopy() { }
+    static bool reflink(const QString &fromFile, const QString &toFile);
+    static bool copyFileRange(const QString &fromFile, const QString &toFile);
+};
+
+#endif // FILECOPY_H
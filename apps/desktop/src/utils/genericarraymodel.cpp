@@ -18,6 +18,7 @@
 
 #include <QJSValue>
 #include <QtDebug>
+#include <QJsonDocument>
 
 GenericArrayModel::GenericArrayModel(QObject *parent) : QAbstractListModel(parent)
 {
@@ -25,8 +26,8 @@ GenericArrayModel::GenericArrayModel(QObject *parent) : QAbstractListModel(paren
     connect(this, &GenericArrayModel::rowsRemoved, this, &GenericArrayModel::countChanged);
     connect(this, &GenericArrayModel::modelReset, this, &GenericArrayModel::countChanged);
 
-    connect(this, &GenericArrayModel::countChanged, this, &GenericArrayModel::arrayChanged);
-    connect(this, &GenericArrayModel::dataChanged, this, &GenericArrayModel::arrayChanged);
+    connect(this, &GenericArrayModel::countChanged, this, &GenericArrayModel::emitArrayChanged);
+    connect(this, &GenericArrayModel::dataChanged, this, &GenericArrayModel::emitArrayChanged);
 }
 
 GenericArrayModel::~GenericArrayModel() { }
@@ -36,9 +37,71 @@ void GenericArrayModel::setArray(const QJsonArray &val)
     if (m_array == val)
         return;
 
-    this->beginResetModel();
-    m_array = val;
-    this->endResetModel();
+    const int oldSize = m_array.size();
+    const int newSize = val.size();
+    const int maxCommon = qMin(oldSize, newSize);
+
+    int prefix = 0;
+    while (prefix < maxCommon && m_array.at(prefix) == val.at(prefix))
+        ++prefix;
+
+    int suffix = 0;
+    while (suffix < maxCommon - prefix
+           && m_array.at(oldSize - 1 - suffix) == val.at(newSize - 1 - suffix))
+        ++suffix;
+
+    m_indexDirty = true;
+
+    // If nothing is shared between the old and new arrays, a reset is what really
+    // happened. Otherwise, only touch rows that changed, so that views and proxy models
+    // keep their state and re-evaluate just those rows.
+    m_settingArray = true;
+
+    if (prefix + suffix == 0) {
+        this->beginResetModel();
+        m_array = val;
+        this->endResetModel();
+
+        m_settingArray = false;
+
+        emit arrayChanged();
+        return;
+    }
+
+    const int oldMiddle = oldSize - prefix - suffix;
+    const int newMiddle = newSize - prefix - suffix;
+    const int replaced = qMin(oldMiddle, newMiddle);
+
+    {
+        ModelDataChangedTracker tracker(this);
+        for (int row = prefix; row < prefix + replaced; row++) {
+            const QJsonValue item = val.at(row);
+            if (m_array.at(row) == item)
+                continue;
+
+            m_array.replace(row, item);
+            tracker.changeRow(row);
+        }
+    }
+
+    const int start = prefix + replaced;
+    if (newMiddle > oldMiddle) {
+        const int end = start + newMiddle - oldMiddle - 1;
+        this->beginInsertRows(QModelIndex(), start, end);
+        for (int row = start; row <= end; row++)
+            m_array.insert(row, val.at(row));
+        this->endInsertRows();
+    } else if (oldMiddle > newMiddle) {
+        const int end = start + oldMiddle - newMiddle - 1;
+        this->beginRemoveRows(QModelIndex(), start, end);
+        for (int row = end; row >= start; row--)
+            m_array.removeAt(row);
+        this->endRemoveRows();
+    }
+
+    Q_ASSERT(m_array == val);
+
+    m_settingArray = false;
 
     emit arrayChanged();
 }
@@ -102,6 +165,7 @@ bool GenericArrayModel::append(const QJsonValue &value)
 {
     this->beginInsertRows(QModelIndex(), m_array.size(), m_array.size());
     m_array.append(value);
+    this->indexRow(m_array.size() - 1);
     this->endInsertRows();
 
     return true;
@@ -115,6 +179,7 @@ bool GenericArrayModel::insert(int row, const QJsonValue &value)
 
     this->beginInsertRows(QModelIndex(), row, row);
     m_array.insert(row, value);
+    m_indexDirty = true;
     this->endInsertRows();
 
     return true;
@@ -130,6 +195,7 @@ bool GenericArrayModel::remove(int row, int count)
         m_array.removeAt(row);
         --count;
     }
+    m_indexDirty = true;
     this->endRemoveRows();
 
     return true;
@@ -143,6 +209,7 @@ bool GenericArrayModel::set(int row, const QJsonValue &value)
     const QModelIndex index = this->index(row);
 
     m_array.replace(row, value);
+    m_indexDirty = true;
     emit dataChanged(index, index);
 
     return true;
@@ -158,6 +225,8 @@ bool GenericArrayModel::setProperty(int row, const QString &member, const QVaria
     QJsonObject item = m_array.at(row).toObject();
     item.insert(member, value.toJsonValue());
     m_array.replace(row, item);
+    if (m_indexedMembers.contains(member))
+        m_indexDirty = true;
 
     const int memberIndex = m_objectMembers.indexOf(member);
     if (memberIndex < 0)
@@ -168,8 +237,95 @@ bool GenericArrayModel::setProperty(int row, const QString &member, const QVaria
     return true;
 }
 
+void GenericArrayModel::setIndexedMembers(const QStringList &val)
+{
+    if (m_indexedMembers == val)
+        return;
+
+    m_indexedMembers = val;
+    m_index.clear();
+    m_indexDirty = true;
+
+    emit indexedMembersChanged();
+}
+
+static QJsonValue arrayItemMemberValue(const QJsonValue &item, const QString &member)
+{
+    if (item.isArray()) {
+        const QJsonArray array = item.toArray();
+
+        bool ok = true;
+        const int idx = member.toInt(&ok);
+        return ok && idx >= 0 && idx < array.size() ? array.at(idx) : QJsonValue::Undefined;
+    }
+
+    if (item.isObject())
+        return item.toObject().value(member);
+
+    return QJsonValue::Undefined;
+}
+
+static QString arrayIndexKey(const QJsonValue &value)
+{
+    // Keys carry the value type, so that "1" and 1 don't collide; just as they
+    // wouldn't compare equal as QVariants. Numbers are normalized to double, which
+    // is how QJsonValue stores them anyway.
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        return value.toBool() ? QStringLiteral("b1") : QStringLiteral("b0");
+    case QJsonValue::Double:
+        return QLatin1Char('d') + QString::number(value.toDouble(), 'g', 17);
+    case QJsonValue::String:
+        return QLatin1Char('s') + value.toString();
+    case QJsonValue::Array:
+        return QLatin1Char('a')
+                + QString::fromUtf8(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Object:
+        return QLatin1Char('o')
+                + QString::fromUtf8(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Null:
+        return QStringLiteral("n");
+    case QJsonValue::Undefined:
+        break;
+    }
+
+    return QStringLiteral("u");
+}
+
+void GenericArrayModel::buildIndex() const
+{
+    m_index.clear();
+    m_indexDirty = false;
+
+    for (int i = 0; i < m_array.size(); i++)
+        this->indexRow(i);
+}
+
+void GenericArrayModel::indexRow(int row) const
+{
+    if (m_indexDirty || m_indexedMembers.isEmpty())
+        return;
+
+    const QJsonValue item = m_array.at(row);
+    for (const QString &member : m_indexedMembers) {
+        QHash<QString, int> &index = m_index[member];
+        const QString key = arrayIndexKey(arrayItemMemberValue(item, member));
+        if (!index.contains(key))
+            index.insert(key, row);
+    }
+}
+
 int GenericArrayModel::firstIndexOf(const QString &member, const QVariant &value) const
 {
+    if (m_indexedMembers.contains(member)) {
+        if (m_indexDirty)
+            this->buildIndex();
+
+        const QString key = arrayIndexKey(value.isValid() ? QJsonValue::fromVariant(value)
+                                                          : QJsonValue(QJsonValue::Undefined));
+        return m_index.value(member).value(key, -1);
+    }
+
     for (int i = 0; i < m_array.size(); i++) {
         QVariant itemValue;
 
@@ -235,6 +391,7 @@ bool GenericArrayModel::setData(const QModelIndex &index, const QVariant &value,
 
     if (role == ArrayItemRole) {
         m_array[index.row()] = value.toJsonValue();
+        m_indexDirty = true;
         emit dataChanged(index, index, { ArrayItemRole });
         return true;
     }
@@ -247,6 +404,9 @@ bool GenericArrayModel::setData(const QModelIndex &index, const QVariant &value,
 
     const QString member = m_objectMembers.at(memberIndex);
     item.insert(member, value.toJsonValue());
+    m_array.replace(index.row(), item);
+    if (m_indexedMembers.contains(member))
+        m_indexDirty = true;
     emit dataChanged(index, index, { role });
 
     return true;
@@ -272,11 +432,21 @@ QHash<int, QByteArray> GenericArrayModel::roleNames() const
     return roles;
 }
 
+void GenericArrayModel::emitArrayChanged()
+{
+    // setArray() emits arrayChanged() once after all its row signals are out.
+    if (!m_settingArray)
+        emit arrayChanged();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 GenericArraySortFilterProxyModel::GenericArraySortFilterProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent), m_arrayModel(this, "arrayModel")
 {
+    // Source row inserts, removes and data changes are filtered and sorted in
+    // place, instead of invalidating the whole proxy.
+    this->setDynamicSortFilter(true);
 }
 
 GenericArraySortFilterProxyModel::~GenericArraySortFilterProxyModel() { }
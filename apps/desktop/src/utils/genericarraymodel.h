@@ -91,6 +91,19 @@ public:
     Q_INVOKABLE bool set(int row, const QJsonValue &value);
     Q_INVOKABLE bool setProperty(int row, const QString &member, const QVariant &value);
 
+    // Members listed here get a value->row lookup table, so that firstIndexOf() doesn't
+    // have to scan the whole array each time. The table is built on first lookup and
+    // rebuilt lazily after the array changes.
+    // clang-format off
+    Q_PROPERTY(QStringList indexedMembers
+               READ indexedMembers
+               WRITE setIndexedMembers
+               NOTIFY indexedMembersChanged)
+    // clang-format on
+    void setIndexedMembers(const QStringList &val);
+    QStringList indexedMembers() const { return m_indexedMembers; }
+    Q_SIGNAL void indexedMembersChanged();
+
     Q_INVOKABLE int firstIndexOf(const QString &member, const QVariant &value) const;
 
     // clang-format off
@@ -112,13 +125,26 @@ public:
     QHash<int, QByteArray> roleNames() const;
 
 protected:
-    QJsonArray &internalArray() { return m_array; }
+    QJsonArray &internalArray()
+    {
+        m_indexDirty = true;
+        return m_array;
+    }
     const QJsonArray &internalArray() const { return m_array; }
 
+private:
+    void emitArrayChanged();
+    void buildIndex() const;
+    void indexRow(int row) const;
+
 private:
     bool m_editable = false;
+    bool m_settingArray = false;
     QJsonArray m_array;
     QStringList m_objectMembers;
+    QStringList m_indexedMembers;
+    mutable bool m_indexDirty = true;
+    mutable QHash<QString, QHash<QString, int>> m_index;
 };
 
 class GenericArraySortFilterProxyModel : public QSortFilterProxyModel
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "parentchangenotifier.h"
+
+#include <QHash>
+#include <QEvent>
+#include <QObject>
+#include <QPointer>
+#include <QMetaObject>
+
+namespace {
+
+// Objects are created in worker threads too (paginator, importers), so all book-keeping
+// is per-thread. That way we don't need to lock anything in the hot path.
+struct ParentChangeState
+{
+    int batchDepth = 0;
+    QHash<QObject *, int> pendingIndexMap;
+    QList<QPointer<QObject>> pendingList;
+    QHash<const QMetaObject *, bool> requiredMap;
+};
+
+thread_local ParentChangeState state;
+
+}
+
+bool ParentChangeNotifier::isRequiredFor(const QObject *object)
+{
+    if (object == nullptr || object->isWidgetType() || object->isWindowType()
+        || object->isQuickItemType())
+        return false;
+
+    const QMetaObject *mo = object->metaObject();
+    auto it = state.requiredMap.constFind(mo);
+    if (it != state.requiredMap.constEnd())
+        return it.value();
+
+    const int ciIndex = mo->indexOfClassInfo("ParentChangeEvent");
+    const bool required = ciIndex >= 0
+            && qstrcmp(mo->classInfo(ciIndex).value(), "Required") == 0;
+    state.requiredMap.insert(mo, required);
+    return required;
+}
+
+void ParentChangeNotifier::childAdded(QObject *child)
+{
+    if (!isRequiredFor(child))
+        return;
+
+    if (state.batchDepth > 0) {
+        // A pointer that was queued before, but has since been deleted and whose address
+        // got reused, must not suppress the event for the new object.
+        const int index = state.pendingIndexMap.value(child, -1);
+        if (index < 0 || state.pendingList.at(index).isNull()) {
+            state.pendingIndexMap.insert(child, state.pendingList.size());
+            state.pendingList.append(child);
+        }
+        return;
+    }
+
+    notify(child);
+}
+
+void ParentChangeNotifier::notify(QObject *child)
+{
+    if (child == nullptr)
+        return;
+
+    QEvent parentChangeEvent(QEvent::ParentChange);
+    child->event(&parentChangeEvent);
+}
+
+bool ParentChangeNotifier::isBatching()
+{
+    return state.batchDepth > 0;
+}
+
+void ParentChangeNotifier::beginBatch()
+{
+    ++state.batchDepth;
+}
+
+void ParentChangeNotifier::endBatch()
+{
+    if (state.batchDepth == 0 || --state.batchDepth > 0)
+        return;
+
+    // Handlers of ParentChange may add more children, which will then be delivered
+    // immediately since we are no longer batching.
+    const QList<QPointer<QObject>> pendingList = state.pendingList;
+    state.pendingList.clear();
+    state.pendingIndexMap.clear();
+
+    for (const QPointer<QObject> &child : pendingList) {
+        if (!child.isNull())
+            notify(child);
+    }
+}
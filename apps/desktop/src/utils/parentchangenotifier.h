@@ -0,0 +1,63 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef PARENTCHANGENOTIFIER_H
+#define PARENTCHANGENOTIFIER_H
+
+#include <QtGlobal>
+
+class QObject;
+
+/**
+ * Qt sends ParentChange events only to widgets, windows and declarative items. Document
+ * model classes like StructureElement, SceneElement etc. need them too, so that they can
+ * evaluate a pointer to their parent in the document object tree. Such classes declare
+ *
+ *     Q_CLASSINFO("ParentChangeEvent", "Required")
+ *
+ * and Application::notify() calls ParentChangeNotifier::childAdded() for every ChildAdded
+ * event. The ParentChange event is then delivered straight to the child's event() method,
+ * instead of through another full QApplication::notify() pass.
+ *
+ * Bulk setters (loading a document, pasting, undo/redo of many elements) can create a
+ * ParentChangeBatch on the stack. While a batch is alive, ParentChange events are deferred
+ * and coalesced, so that each child gets exactly one event when the outermost batch ends.
+ */
+class ParentChangeNotifier
+{
+public:
+    static bool isRequiredFor(const QObject *object);
+    static void childAdded(QObject *child);
+    static void notify(QObject *child);
+
+    static bool isBatching();
+
+private:
+    friend class ParentChangeBatch;
+    static void beginBatch();
+    static void endBatch();
+};
+
+class ParentChangeBatch
+{
+public:
+    ParentChangeBatch() { ParentChangeNotifier::beginBatch(); }
+    ~ParentChangeBatch() { ParentChangeNotifier::endBatch(); }
+
+private:
+    Q_DISABLE_COPY_MOVE(ParentChangeBatch)
+};
+
+#endif // PARENTCHANGENOTIFIER_H
@@ -0,0 +1,201 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "spatialindex.h"
+
+#include <QSet>
+#include <QtMath>
+
+SpatialIndex::SpatialIndex(qreal cellSize) : m_cellSize(qMax(cellSize, qreal(1))) { }
+
+SpatialIndex::~SpatialIndex() { }
+
+void SpatialIndex::insert(const QObject *object, const QRectF &rect)
+{
+    if (object == nullptr)
+        return;
+
+    const QRectF newRect = rect.normalized();
+
+    auto it = m_rects.find(object);
+    if (it != m_rects.end()) {
+        if (it.value() == newRect)
+            return;
+
+        const CellRange oldRange = this->cellRange(it.value());
+        const CellRange newRange = this->cellRange(newRect);
+        it.value() = newRect;
+        m_boundingRectDirty = true;
+
+        // Most geometry changes are small moves within the same set of cells.
+        if (oldRange.left == newRange.left && oldRange.top == newRange.top
+            && oldRange.right == newRange.right && oldRange.bottom == newRange.bottom)
+            return;
+
+        for (int x = oldRange.left; x <= oldRange.right; x++) {
+            for (int y = oldRange.top; y <= oldRange.bottom; y++) {
+                auto cit = m_cells.find(cellKey(x, y));
+                if (cit == m_cells.end())
+                    continue;
+                cit.value().removeOne(object);
+                if (cit.value().isEmpty())
+                    m_cells.erase(cit);
+            }
+        }
+
+        for (int x = newRange.left; x <= newRange.right; x++)
+            for (int y = newRange.top; y <= newRange.bottom; y++)
+                m_cells[cellKey(x, y)].append(object);
+
+        return;
+    }
+
+    m_rects.insert(object, newRect);
+    m_boundingRectDirty = true;
+
+    const CellRange range = this->cellRange(newRect);
+    for (int x = range.left; x <= range.right; x++)
+        for (int y = range.top; y <= range.bottom; y++)
+            m_cells[cellKey(x, y)].append(object);
+}
+
+void SpatialIndex::remove(const QObject *object)
+{
+    auto it = m_rects.find(object);
+    if (it == m_rects.end())
+        return;
+
+    const CellRange range = this->cellRange(it.value());
+    m_rects.erase(it);
+    m_boundingRectDirty = true;
+
+    for (int x = range.left; x <= range.right; x++) {
+        for (int y = range.top; y <= range.bottom; y++) {
+            auto cit = m_cells.find(cellKey(x, y));
+            if (cit == m_cells.end())
+                continue;
+            cit.value().removeOne(object);
+            if (cit.value().isEmpty())
+                m_cells.erase(cit);
+        }
+    }
+}
+
+void SpatialIndex::clear()
+{
+    m_rects.clear();
+    m_cells.clear();
+    m_boundingRect = QRectF();
+    m_boundingRectDirty = false;
+}
+
+QRectF SpatialIndex::boundingRect() const
+{
+    if (m_boundingRectDirty) {
+        QRectF ret;
+        for (const QRectF &rect : m_rects)
+            ret = ret.isNull() ? rect : ret.united(rect);
+        m_boundingRect = ret;
+        m_boundingRectDirty = false;
+    }
+
+    return m_boundingRect;
+}
+
+QList<const QObject *> SpatialIndex::candidates(const QRectF &rect) const
+{
+    QList<const QObject *> ret;
+    if (m_rects.isEmpty())
+        return ret;
+
+    const CellRange range = this->cellRange(rect.normalized());
+
+    QSet<const QObject *> visited;
+    auto collect = [&](const QList<const QObject *> &objects) {
+        for (const QObject *object : objects) {
+            if (visited.contains(object))
+                continue;
+            visited.insert(object);
+            ret.append(object);
+        }
+    };
+
+    // Large query rectangles over a sparse canvas could cover far more cells than
+    // are occupied. In that case, walking the occupied cells is cheaper.
+    if (range.count() > qint64(m_cells.size())) {
+        auto it = m_cells.constBegin();
+        auto end = m_cells.constEnd();
+        while (it != end) {
+            const int x = cellX(it.key());
+            const int y = cellY(it.key());
+            if (x >= range.left && x <= range.right && y >= range.top && y <= range.bottom)
+                collect(it.value());
+            ++it;
+        }
+
+        return ret;
+    }
+
+    for (int x = range.left; x <= range.right; x++) {
+        for (int y = range.top; y <= range.bottom; y++) {
+            auto it = m_cells.constFind(cellKey(x, y));
+            if (it != m_cells.constEnd())
+                collect(it.value());
+        }
+    }
+
+    return ret;
+}
+
+QList<const QObject *> SpatialIndex::intersecting(const QRectF &rect) const
+{
+    QList<const QObject *> ret = this->candidates(rect);
+    ret.removeIf([=](const QObject *object) { return !rect.intersects(m_rects.value(object)); });
+    return ret;
+}
+
+QList<const QObject *> SpatialIndex::contained(const QRectF &rect) const
+{
+    QList<const QObject *> ret = this->candidates(rect);
+    ret.removeIf([=](const QObject *object) { return !rect.contains(m_rects.value(object)); });
+    return ret;
+}
+
+bool SpatialIndex::intersects(const QRectF &rect, const QObject *except) const
+{
+    const QList<const QObject *> objects = this->candidates(rect);
+    for (const QObject *object : objects) {
+        if (object != except && rect.intersects(m_rects.value(object)))
+            return true;
+    }
+
+    return false;
+}
+
+SpatialIndex::CellRange SpatialIndex::cellRange(const QRectF &rect) const
+{
+    // Keep cell coordinates well within int range, even for absurdly large rectangles.
+    static const qreal maxCell = 1 << 24;
+    auto toCell = [=](qreal v) {
+        return qFloor(qBound(-maxCell, v / m_cellSize, maxCell));
+    };
+
+    CellRange ret;
+    ret.left = toCell(rect.left());
+    ret.top = toCell(rect.top());
+    ret.right = toCell(rect.right());
+    ret.bottom = toCell(rect.bottom());
+    return ret;
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+
+class QObject;
+
+/**
+ * A uniform-grid spatial index of object rectangles. Objects are bucketed into square
+ * cells, so that a query for a rectangle only needs to look at objects in cells that it
+ * overlaps, rather than at every object on the canvas.
+ *
+ * The index doesn't watch objects by itself. Whoever owns it must call insert() whenever
+ * an object's rectangle changes and remove() before the object is deleted.
+ */
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(qreal cellSize = 512);
+    ~SpatialIndex();
+
+    void insert(const QObject *object, const QRectF &rect);
+    void remove(const QObject *object);
+    void clear();
+
+    bool contains(const QObject *object) const { return m_rects.contains(object); }
+    QRectF rect(const QObject *object) const { return m_rects.value(object); }
+    int size() const { return m_rects.size(); }
+    bool isEmpty() const { return m_rects.isEmpty(); }
+    QRectF boundingRect() const;
+
+    // Objects in cells overlapping rect, which is a super-set of objects intersecting
+    // rect. Callers that need a custom predicate can filter this list.
+    QList<const QObject *> candidates(const QRectF &rect) const;
+
+    QList<const QObject *> intersecting(const QRectF &rect) const;
+    QList<const QObject *> contained(const QRectF &rect) const;
+    bool intersects(const QRectF &rect, const QObject *except = nullptr) const;
+
+private:
+    struct CellRange
+    {
+        int left = 0;
+        int top = 0;
+        int right = -1;
+        int bottom = -1;
+        qint64 count() const { return qint64(right - left + 1) * qint64(bottom - top + 1); }
+    };
+    CellRange cellRange(const QRectF &rect) const;
+    static quint64 cellKey(int x, int y) { return (quint64(quint32(x)) << 32) | quint32(y); }
+    static int cellX(quint64 key) { return int(quint32(key >> 32)); }
+    static int cellY(quint64 key) { return int(quint32(key & 0xFFFFFFFF)); }
+
+private:
+    qreal m_cellSize = 512;
+    QHash<const QObject *, QRectF> m_rects;
+    QHash<quint64, QList<const QObject *>> m_cells;
+    mutable QRectF m_boundingRect;
+    mutable bool m_boundingRectDirty = false;
+};
+
+#endif // SPATIALINDEX_H
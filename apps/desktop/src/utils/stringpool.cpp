@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "stringpool.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+
+namespace {
+struct StringPoolData
+{
+    // References held on a string through acquire(). Strings added through id() and
+    // interned() are permanent.
+    enum { Permanent = -1 };
+
+    StringPoolData()
+    {
+        strings.append(QString());
+        refs.append(Permanent);
+        ids.insert(QString(), StringPool::EmptyStringId);
+    }
+
+    // Must be called with a write lock held.
+    int insert(const QString &string, bool permanent)
+    {
+        auto it = ids.constFind(string);
+        if (it != ids.constEnd()) {
+            int &ref = refs[it.value()];
+            if (permanent)
+                ref = Permanent;
+            else if (ref != Permanent)
+                ++ref;
+            return it.value();
+        }
+
+        // Keep a detached copy, so that the pool doesn't pin down whatever larger
+        // buffer the string may have been sliced out of.
+        const QString copy(string.constData(), string.size());
+        const int ref = permanent ? int(Permanent) : 1;
+
+        int ret = -1;
+        if (freeIds.isEmpty()) {
+            ret = strings.size();
+            strings.append(copy);
+            refs.append(ref);
+        } else {
+            ret = freeIds.takeLast();
+            strings[ret] = copy;
+            refs[ret] = ref;
+        }
+
+        ids.insert(copy, ret);
+        return ret;
+    }
+
+    QReadWriteLock lock;
+    QList<QString> strings;
+    QList<int> refs;
+    QList<int> freeIds;
+    QHash<QString, int> ids;
+};
+} // namespace
+
+Q_GLOBAL_STATIC(StringPoolData, Pool)
+
+int StringPool::id(const QString &string)
+{
+    if (string.isEmpty())
+        return EmptyStringId;
+
+    {
+        QReadLocker locker(&Pool->lock);
+        const auto it = Pool->ids.constFind(string);
+        if (it != Pool->ids.constEnd())
+            return it.value();
+    }
+
+    QWriteLocker locker(&Pool->lock);
+    return Pool->insert(string, true);
+}
+
+int StringPool::acquire(const QString &string)
+{
+    if (string.isEmpty())
+        return EmptyStringId;
+
+    QWriteLocker locker(&Pool->lock);
+    return Pool->insert(string, false);
+}
+
+void StringPool::release(int id)
+{
+    if (id <= EmptyStringId)
+        return;
+
+    QWriteLocker locker(&Pool->lock);
+    if (id >= Pool->strings.size())
+        return;
+
+    int &ref = Pool->refs[id];
+    if (ref == StringPoolData::Permanent || ref == 0 || --ref > 0)
+        return;
+
+    Pool->ids.remove(Pool->strings.at(id));
+    Pool->strings[id] = QString();
+    Pool->freeIds.append(id);
+}
+
+int StringPool::findId(const QString &string)
+{
+    if (string.isEmpty())
+        return EmptyStringId;
+
+    QReadLocker locker(&Pool->lock);
+    return Pool->ids.value(string, -1);
+}
+
+QString StringPool::string(int id)
+{
+    QReadLocker locker(&Pool->lock);
+    return id >= 0 && id < Pool->strings.size() ? Pool->strings.at(id) : QString();
+}
+
+QStringList StringPool::strings(const QList<int> &ids)
+{
+    QStringList ret;
+    ret.reserve(ids.size());
+
+    QReadLocker locker(&Pool->lock);
+    for (int id : ids)
+        ret.append(id >= 0 && id < Pool->strings.size() ? Pool->strings.at(id) : QString());
+
+    return ret;
+}
+
+QString StringPool::interned(const QString &string)
+{
+    if (string.isEmpty())
+        return string;
+
+    const int id = StringPool::id(string);
+
+    QReadLocker locker(&Pool->lock);
+    return Pool->strings.at(id);
+}
+
+QString StringPool::shared(const QString &string)
+{
+    if (string.isEmpty())
+        return string;
+
+    QReadLocker locker(&Pool->lock);
+    const auto it = Pool->ids.constFind(string);
+    return it == Pool->ids.constEnd() ? string : Pool->strings.at(it.value());
+}
+
+QStringList StringPool::interned(const QStringList &strings)
+{
+    QStringList ret;
+    ret.reserve(strings.size());
+    for (const QString &string : strings)
+        ret.append(StringPool::interned(string));
+    return ret;
+}
+
+int StringPool::count()
+{
+    QReadLocker locker(&Pool->lock);
+    return Pool->strings.size() - Pool->freeIds.size();
+}
+
+qint64 StringPool::memoryUsage()
+{
+    QReadLocker locker(&Pool->lock);
+
+    qint64 ret = Pool->strings.size() * qint64(sizeof(QString) + sizeof(int))
+            + Pool->ids.size() * qint64(sizeof(QString) + sizeof(int));
+    for (const QString &string : std::as_const(Pool->strings))
+        ret += string.capacity() * qint64(sizeof(QChar));
+
+    return ret;
+}
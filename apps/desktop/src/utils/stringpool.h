@@ -0,0 +1,78 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Interns names that recur throughout a document: character names, locations, moments,
+ * shots, transitions, groups and tags.
+ *
+ * Each distinct string is stored once and given a stable integer ID. Objects that hold
+ * on to interned() copies share a single string buffer, and code that needs to compare
+ * or collect names can do so over IDs instead of re-hashing or re-comparing strings.
+ *
+ * Strings added with id() or interned() stay in the pool for the lifetime of the process,
+ * not just that of a document, so that they can be carried across document reloads,
+ * clipboard pastes and undo commands. Only committed values must be added this way, the set
+ * of which is small even for large screenplays. Values that change with each keystroke
+ * (say the character name in a paragraph being typed) must either be acquire()d and
+ * release()d, so that they leave the pool once no longer used, or be shared() only if the
+ * pool already has them.
+ *
+ * Strings are interned as given. Callers are expected to normalize case (e.g. upper
+ * case for character names) before interning, like they do before comparing.
+ *
+ * All functions are thread-safe.
+ */
+class StringPool
+{
+public:
+    enum { EmptyStringId = 0 };
+
+    // Returns the ID of the string, adding it to the pool if needed.
+    static int id(const QString &string);
+
+    // Returns the ID of the string, or -1 if it isn't in the pool.
+    static int findId(const QString &string);
+
+    // Returns the ID of the string, adding it to the pool if needed, and holds a reference
+    // to it. The string is dropped from the pool once all references are released, unless
+    // it was also added with id() or interned(). Its ID may be reused after that.
+    static int acquire(const QString &string);
+    static void release(int id);
+
+    static QString string(int id);
+    static QStringList strings(const QList<int> &ids);
+
+    // Returns a copy of the string that shares data with the pooled one.
+    static QString interned(const QString &string);
+    static QStringList interned(const QStringList &strings);
+
+    // Returns the pooled copy of the string if there is one, or the string itself otherwise.
+    static QString shared(const QString &string);
+
+    static int count();
+    static qint64 memoryUsage();
+
+private:
+    StringPool() { }
+};
+
+#endif // STRINGPOOL_H
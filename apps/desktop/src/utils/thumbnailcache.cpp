@@ -0,0 +1,295 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#include "thumbnailcache.h"
+
+#include <QDir>
+#include <QtMath>
+#include <QFile>
+#include <QCache>
+#include <QMutex>
+#include <QFileInfo>
+#include <QThread>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+
+Q_GLOBAL_STATIC(QMutex, ThumbnailCacheHashLock)
+
+// Hashing a large photo is not free either. So we remember content hashes of the most
+// recently used files, for as long as their path, size and modification time remain unchanged.
+typedef QCache<QString, QByteArray> ContentHashCache;
+Q_GLOBAL_STATIC(ContentHashCache, ThumbnailCacheContentHashes, 2048)
+
+// Thumbnails not used for this long are removed from the cache folder. The folder is also
+// kept within a size limit, by removing the least recently used thumbnails first.
+static const int ThumbnailCacheMaxAgeInDays = 60;
+static const qint64 ThumbnailCacheMaxFolderSize = 256 * 1024 * 1024;
+
+// The cache folder is pruned once per session, and then after every so many thumbnails
+// are written into it.
+static const int ThumbnailCachePruneInterval = 256;
+Q_GLOBAL_STATIC(QAtomicInt, ThumbnailCacheWriteCount)
+
+QImage ThumbnailCache::load(const QString &filePath, const QSize &maxSize,
+                            Qt::AspectRatioMode mode)
+{
+    if (filePath.isEmpty() || maxSize.isEmpty())
+        return QImage();
+
+    const QByteArray hash = contentHash(filePath);
+    if (hash.isEmpty())
+        return QImage();
+
+    // Thumbnails are cached for a handful of sizes only. Otherwise, say, resizing an image
+    // annotation would cache a new thumbnail for every width it passes through.
+    const QSize cachedSize = bucketSize(maxSize);
+    auto fitToMaxSize = [maxSize, mode](const QImage &image) -> QImage {
+        const QSize targetSize = image.size().scaled(maxSize, mode);
+        if (targetSize.width() < image.width() && targetSize.height() < image.height())
+            return image.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        return image;
+    };
+
+    const QString cacheFolder = cacheFolderPath();
+    const QString thumbnailFileName = QString::fromLatin1(hash) + QLatin1Char('-')
+            + QString::number(cachedSize.width()) + QLatin1Char('x')
+            + QString::number(cachedSize.height()) + QLatin1Char('-') + QString::number(int(mode))
+            + QStringLiteral(".thumb");
+    const QString thumbnailFilePath = cacheFolder.isEmpty()
+            ? QString()
+            : QDir(cacheFolder).absoluteFilePath(thumbnailFileName);
+
+    if (!thumbnailFilePath.isEmpty() && QFile::exists(thumbnailFilePath)) {
+        // Modification time doubles up as last-used time, for pruning. Setting it needs a
+        // handle opened for writing on some platforms, Windows in particular.
+        QFile thumbnailFile(thumbnailFilePath);
+        bool touched = false;
+        if (thumbnailFile.open(QFile::ReadWrite))
+            touched = thumbnailFile.setFileTime(QDateTime::currentDateTime(),
+                                                QFileDevice::FileModificationTime);
+
+        if (thumbnailFile.isOpen() || thumbnailFile.open(QFile::ReadOnly)) {
+            QImageReader reader(&thumbnailFile);
+            reader.setDecideFormatFromContent(true);
+            const QImage image = reader.read();
+
+            // A thumbnail that couldn't be marked as used would be pruned while still in
+            // use. So it is regenerated, with a fresh time stamp, once it is about to be.
+            const QDateTime staleAfter =
+                    QDateTime::currentDateTime().addDays(1 - ThumbnailCacheMaxAgeInDays);
+            if (!image.isNull()
+                && (touched || QFileInfo(thumbnailFilePath).lastModified() > staleAfter))
+                return fitToMaxSize(image);
+            thumbnailFile.close();
+        }
+
+        // Corrupt or stale thumbnail, regenerate it below.
+        QFile::remove(thumbnailFilePath);
+    }
+
+    bool scaled = false;
+    const QImage image = decode(filePath, cachedSize, mode, &scaled);
+    if (image.isNull() || !scaled || thumbnailFilePath.isEmpty())
+        return fitToMaxSize(image);
+
+    // Images that didn't need scaling are cheap enough to decode again, so only
+    // downscaled images are worth caching. QSaveFile ensures that concurrent loaders
+    // never see a partially written thumbnail.
+    QSaveFile thumbnailFile(thumbnailFilePath);
+    if (thumbnailFile.open(QFile::WriteOnly)) {
+        QImageWriter writer(&thumbnailFile, image.hasAlphaChannel() ? "PNG" : "JPG");
+        writer.setQuality(90);
+        if (writer.write(image))
+            thumbnailFile.commit();
+        else
+            thumbnailFile.cancelWriting();
+    }
+
+    if (ThumbnailCacheWriteCount->fetchAndAddRelaxed(1) % ThumbnailCachePruneInterval
+        == ThumbnailCachePruneInterval - 1)
+        QtConcurrent::run(threadPool(), &ThumbnailCache::pruneCacheFolder);
+
+    return fitToMaxSize(image);
+}
+
+QFuture<QImage> ThumbnailCache::loadAsync(const QString &filePath, const QSize &maxSize,
+                                          Qt::AspectRatioMode mode)
+{
+    return QtConcurrent::run(threadPool(), &ThumbnailCache::load, filePath, maxSize, mode);
+}
+
+QThreadPool *ThumbnailCache::threadPool()
+{
+    static QThreadPool *pool = []() {
+        // Decoding is memory intensive, so we don't want too many of them to happen
+        // in parallel. Yet, we want more than one, so that one large image doesn't hold
+        // up all others.
+        QThreadPool *ret = new QThreadPool(qApp);
+        ret->setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+        return ret;
+    }();
+    return pool;
+}
+
+QString ThumbnailCache::cacheFolderPath()
+{
+    static const QString path = []() -> QString {
+        const QString cacheLocation =
+                QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (cacheLocation.isEmpty())
+            return QString();
+
+        const QString ret = QDir(cacheLocation).absoluteFilePath(QStringLiteral("thumbnails"));
+        if (!QDir().mkpath(ret))
+            return QString();
+
+        // Leftovers from earlier sessions are pruned in the background.
+        QtConcurrent::run(threadPool(), &ThumbnailCache::pruneCacheFolder);
+        return ret;
+    }();
+    return path;
+}
+
+void ThumbnailCache::pruneCacheFolder()
+{
+    // Only one prune at a time, there is no point in two of them racing each other.
+    static QMutex pruneLock;
+    if (!pruneLock.tryLock())
+        return;
+
+    const QString folder = cacheFolderPath();
+    if (!folder.isEmpty()) {
+        // Most recently used thumbnails first.
+        const QFileInfoList thumbnails =
+                QDir(folder).entryInfoList(QStringList { QStringLiteral("*.thumb") }, QDir::Files,
+                                           QDir::Time);
+
+        const QDateTime oldestAllowed =
+                QDateTime::currentDateTime().addDays(-ThumbnailCacheMaxAgeInDays);
+
+        qint64 folderSize = 0;
+        for (const QFileInfo &thumbnail : thumbnails) {
+            folderSize += thumbnail.size();
+            if (folderSize > ThumbnailCacheMaxFolderSize
+                || thumbnail.lastModified() < oldestAllowed)
+                QFile::remove(thumbnail.absoluteFilePath());
+        }
+    }
+
+    pruneLock.unlock();
+}
+
+QByteArray ThumbnailCache::contentHash(const QString &filePath)
+{
+    const QFileInfo fi(filePath);
+    if (!fi.exists() || !fi.isReadable())
+        return QByteArray();
+
+    const QString key = fi.absoluteFilePath() + QLatin1Char('|') + QString::number(fi.size())
+            + QLatin1Char('|') + QString::number(fi.lastModified().toMSecsSinceEpoch());
+
+    {
+        QMutexLocker locker(ThumbnailCacheHashLock());
+        const QByteArray *hash = ThumbnailCacheContentHashes->object(key);
+        if (hash != nullptr)
+            return *hash;
+    }
+
+    QFile file(fi.absoluteFilePath());
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    if (!hasher.addData(&file))
+        return QByteArray();
+
+    const QByteArray hash = hasher.result().toHex();
+
+    QMutexLocker locker(ThumbnailCacheHashLock());
+    ThumbnailCacheContentHashes->insert(key, new QByteArray(hash));
+
+    return hash;
+}
+
+QSize ThumbnailCache::bucketSize(const QSize &size)
+{
+    // Each dimension is rounded up to the next power of two, with a minimum of 64. Very
+    // large dimensions are left alone, they are effectively unconstrained (see
+    // AnnotationImageProvider, which only constrains the width).
+    auto bucket = [](int dim) -> int {
+        if (dim <= 64)
+            return 64;
+        if (dim > 8192)
+            return dim;
+        return int(qNextPowerOfTwo(quint32(dim - 1)));
+    };
+
+    return QSize(bucket(size.width()), bucket(size.height()));
+}
+
+QImage ThumbnailCache::decode(const QString &filePath, const QSize &maxSize,
+                              Qt::AspectRatioMode mode, bool *scaled)
+{
+    *scaled = false;
+
+    QImageReader reader(filePath);
+    reader.setAutoTransform(true);
+    if (!reader.canRead())
+        return QImage();
+
+    // Scaled size applies to the image as stored, before EXIF rotation is applied.
+    const bool transposed =
+            reader.transformation().testFlag(QImageIOHandler::TransformationRotate90);
+    QSize naturalSize = reader.size();
+    if (naturalSize.isValid() && transposed)
+        naturalSize.transpose();
+
+    // Ask the image handler to decode straight into the target size. JPEG, for instance,
+    // can skip most of the work of decoding a large photo this way.
+    if (naturalSize.isValid()) {
+        const QSize targetSize = naturalSize.scaled(maxSize, mode);
+        if (targetSize.width() < naturalSize.width()
+            && targetSize.height() < naturalSize.height()) {
+            QSize readSize = targetSize;
+            if (transposed)
+                readSize.transpose();
+            reader.setScaledSize(readSize);
+            *scaled = true;
+        }
+
+        return reader.read();
+    }
+
+    // Handlers that cannot tell the size up front leave us with no choice but to
+    // decode at full size first.
+    QImage image = reader.read();
+    if (image.isNull())
+        return image;
+
+    const QSize targetSize = image.size().scaled(maxSize, mode);
+    if (targetSize.width() < image.width() && targetSize.height() < image.height()) {
+        image = image.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        *scaled = true;
+    }
+
+    return image;
+}
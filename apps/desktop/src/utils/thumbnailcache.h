@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 Prashanth N Udupa
+** Author: Prashanth N Udupa (prashanth@scrite.io,
+**                            prashanth.udupa@gmail.com,
+**                            prashanth@vcreatelogic.com)
+**
+** This code is distributed under GPL v3. Complete text of the license
+** can be found here: https://www.gnu.org/licenses/gpl-3.0.txt
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+****************************************************************************/
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QSize>
+#include <QImage>
+#include <QFuture>
+#include <QString>
+
+class QThreadPool;
+
+/**
+ * Loads downscaled images for previews and thumbnails, without decoding images at full
+ * resolution where the image format supports it (QImageReader::setScaledSize()).
+ *
+ * Thumbnails are also saved into the application's cache folder, keyed by a hash of the
+ * source file's contents and the requested size. So the same photo gets decoded only once,
+ * even across documents and sessions, and even though documents extract their files into
+ * a different temporary folder each time they are loaded. Requested sizes are rounded up to
+ * the next power of two for this purpose, and the cached thumbnail is scaled down from there.
+ * The cache folder is pruned of thumbnails that haven't been used in a while, and is kept
+ * within a fixed size.
+ *
+ * All functions are thread-safe.
+ */
+class ThumbnailCache
+{
+public:
+    static QImage load(const QString &filePath, const QSize &maxSize,
+                       Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+    static QFuture<QImage> loadAsync(const QString &filePath, const QSize &maxSize,
+                                     Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+
+    static QThreadPool *threadPool();
+    static QString cacheFolderPath();
+
+private:
+    ThumbnailCache() { }
+    static QByteArray contentHash(const QString &filePath);
+    static QSize bucketSize(const QSize &size);
+    static void pruneCacheFolder();
+    static QImage decode(const QString &filePath, const QSize &maxSize, Qt::AspectRatioMode mode,
+                         bool *scaled);
+};
+
+#endif // THUMBNAILCACHE_H